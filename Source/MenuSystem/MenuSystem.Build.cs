@@ -28,7 +28,6 @@ public class MenuSystem : ModuleRules
 				"Core",
 				// ... add other public dependencies that you statically link with here ...
 				"OnlineSubsystem",
-				"OnlineSubsystemSteam",
 				"UMG",
 				"Slate",
 				"SlateCore",
@@ -43,6 +42,8 @@ public class MenuSystem : ModuleRules
 				"Engine",
 				"Slate",
 				"SlateCore",
+				"Sockets",
+				"Networking",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
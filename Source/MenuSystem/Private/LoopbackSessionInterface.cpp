@@ -0,0 +1,692 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LoopbackSessionInterface.h"
+
+#include "OnlineSubsystemTypes.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Guid.h"
+
+
+DEFINE_LOG_CATEGORY_STATIC(LogLoopbackSession, Log, All);
+
+
+namespace{
+    /*
+    Session info of a loopback session, it just carries the session id and the address of the host
+    */
+    class FLoopbackSessionInfo : public FOnlineSessionInfo{
+    public:
+        FLoopbackSessionInfo(const FString &InSessionId, const FString &InHostAddress, int32 InHostPort) :
+            SessionId(FUniqueNetIdString::Create(InSessionId, LOOPBACK_SUBSYSTEM)),
+            HostAddress(InHostAddress),
+            HostPort(InHostPort){
+        }
+
+        virtual const uint8 *GetBytes() const override{
+            return nullptr;
+        }
+        virtual int32 GetSize() const override{
+            return 0;
+        }
+        virtual bool IsValid() const override{
+            return SessionId->IsValid();
+        }
+        virtual const FUniqueNetId &GetSessionId() const override{
+            return *SessionId;
+        }
+        virtual FString ToString() const override{
+            return SessionId->ToString();
+        }
+        virtual FString ToDebugString() const override{
+            return FString::Printf(TEXT("SessionId: %s Host: %s:%d"), *SessionId->ToDebugString(), *HostAddress, HostPort);
+        }
+
+        // Id of the session in the registry
+        FUniqueNetIdRef SessionId;
+        // Address the host is reached at
+        FString HostAddress;
+        // Port the host is reached at
+        int32 HostPort;
+    };
+
+    /*
+    A session advertised by a host
+    */
+    struct FLoopbackHostedSession{
+        // Advertised session, its open connections are kept up to date
+        FOnlineSession Session;
+        // Interface hosting the session
+        const FLoopbackSessionInterface *Host;
+    };
+
+    // Sessions advertised by all loopback interfaces of the process, keyed by session id
+    TMap<FString, FLoopbackHostedSession> &GetLoopbackRegistry(){
+        static TMap<FString, FLoopbackHostedSession> Registry;
+        return Registry;
+    }
+
+    // Id of the session in the registry, empty if the session isn't a loopback session
+    FString GetLoopbackSessionId(const FOnlineSession &Session){
+        return Session.SessionInfo.IsValid() ? Session.SessionInfo->GetSessionId().ToString() : FString();
+    }
+}
+
+
+/*
+Configuration
+*/
+FLoopbackSessionConfig FLoopbackSessionConfig::Load(){
+    FLoopbackSessionConfig Config;
+    const TCHAR *Section = TEXT("MultiplayerSessions.Loopback");
+    auto ReadFloat = [Section](const TCHAR *Key, float &Value){
+        if (GConfig){
+            GConfig->GetFloat(Section, Key, Value, GGameIni);
+        }
+        FParse::Value(FCommandLine::Get(), *FString::Printf(TEXT("Loopback%s="), Key), Value);
+    };
+    auto ReadInt = [Section](const TCHAR *Key, int32 &Value){
+        if (GConfig){
+            GConfig->GetInt(Section, Key, Value, GGameIni);
+        }
+        FParse::Value(FCommandLine::Get(), *FString::Printf(TEXT("Loopback%s="), Key), Value);
+    };
+    ReadFloat(TEXT("LatencyMs"), Config.LatencyMs);
+    ReadFloat(TEXT("LatencyJitterMs"), Config.LatencyJitterMs);
+    ReadFloat(TEXT("TailProbability"), Config.TailProbability);
+    ReadFloat(TEXT("TailLatencyMs"), Config.TailLatencyMs);
+    ReadFloat(TEXT("LossRatio"), Config.LossRatio);
+    ReadFloat(TEXT("RetransmitDelayMs"), Config.RetransmitDelayMs);
+    ReadFloat(TEXT("ErrorRate"), Config.ErrorRate);
+    ReadInt(TEXT("ResultBatchSize"), Config.ResultBatchSize);
+    ReadFloat(TEXT("ResultBatchIntervalMs"), Config.ResultBatchIntervalMs);
+    ReadFloat(TEXT("PartialResultRate"), Config.PartialResultRate);
+    ReadInt(TEXT("GamePort"), Config.GamePort);
+    if (GConfig){
+        GConfig->GetString(Section, TEXT("HostAddress"), Config.HostAddress, GGameIni);
+    }
+    FParse::Value(FCommandLine::Get(), TEXT("LoopbackHostAddress="), Config.HostAddress);
+    return Config;
+}
+
+
+/*
+Simulated network
+*/
+FLoopbackSessionInterface::FLoopbackSessionInterface(const FLoopbackSessionConfig &InConfig) :
+    Config(InConfig){
+    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+        FTickerDelegate::CreateRaw(this, &FLoopbackSessionInterface::TickRequests)
+    );
+}
+
+
+FLoopbackSessionInterface::~FLoopbackSessionInterface(){
+    FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    // Stop advertising the sessions of this host
+    for (auto It = GetLoopbackRegistry().CreateIterator(); It; ++It){
+        if (It->Value.Host == this){
+            It.RemoveCurrent();
+        }
+    }
+}
+
+
+void FLoopbackSessionInterface::SetConfig(const FLoopbackSessionConfig &InConfig){
+    Config = InConfig;
+}
+
+
+void FLoopbackSessionInterface::ScheduleRequest(double DelaySeconds, TFunction<void()> Complete){
+    PendingRequests.Add(FPendingRequest{FPlatformTime::Seconds() + DelaySeconds, MoveTemp(Complete)});
+}
+
+
+double FLoopbackSessionInterface::SampleLatency() const{
+    double LatencyMs = Config.LatencyMs + FMath::FRand() * Config.LatencyJitterMs;
+    if (FMath::FRand() < Config.TailProbability){
+        LatencyMs += Config.TailLatencyMs;
+    }
+    // Every lost packet costs a retransmission, give up adding them after a few so that a loss ratio of one doesn't hang
+    for (int32 Retransmission = 0; Retransmission < 8 && FMath::FRand() < Config.LossRatio; ++Retransmission){
+        LatencyMs += Config.RetransmitDelayMs;
+    }
+    return FMath::Max(LatencyMs, 0.0) / 1000.0;
+}
+
+
+bool FLoopbackSessionInterface::RollError() const{
+    return FMath::FRand() < Config.ErrorRate;
+}
+
+
+bool FLoopbackSessionInterface::TickRequests(float DeltaTime){
+    if (PendingRequests.Num() == 0){
+        return true;
+    }
+    // Take the due requests out first, since completing them may make new requests
+    const double Now = FPlatformTime::Seconds();
+    TArray<FPendingRequest> DueRequests;
+    for (int32 Index = 0; Index < PendingRequests.Num();){
+        if (PendingRequests[Index].DueTime <= Now){
+            DueRequests.Add(MoveTemp(PendingRequests[Index]));
+            PendingRequests.RemoveAt(Index, 1, false);
+        }
+        else{
+            ++Index;
+        }
+    }
+    DueRequests.StableSort([](const FPendingRequest &A, const FPendingRequest &B){
+        return A.DueTime < B.DueTime;
+    });
+    for (FPendingRequest &Request : DueRequests){
+        Request.Complete();
+    }
+    return true;
+}
+
+
+/*
+Named sessions
+*/
+FUniqueNetIdPtr FLoopbackSessionInterface::CreateSessionIdFromString(const FString &SessionIdStr){
+    return FUniqueNetIdString::Create(SessionIdStr, LOOPBACK_SUBSYSTEM);
+}
+
+
+FNamedOnlineSession *FLoopbackSessionInterface::GetNamedSession(FName SessionName){
+    return Sessions.FindByPredicate([SessionName](const FNamedOnlineSession &Session){
+        return Session.SessionName == SessionName;
+    });
+}
+
+
+void FLoopbackSessionInterface::RemoveNamedSession(FName SessionName){
+    Sessions.RemoveAll([SessionName](const FNamedOnlineSession &Session){
+        return Session.SessionName == SessionName;
+    });
+}
+
+
+FNamedOnlineSession *FLoopbackSessionInterface::AddNamedSession(FName SessionName, const FOnlineSessionSettings &SessionSettings){
+    return &Sessions.Emplace_GetRef(SessionName, SessionSettings);
+}
+
+
+FNamedOnlineSession *FLoopbackSessionInterface::AddNamedSession(FName SessionName, const FOnlineSession &Session){
+    return &Sessions.Emplace_GetRef(SessionName, Session);
+}
+
+
+bool FLoopbackSessionInterface::HasPresenceSession(){
+    return Sessions.ContainsByPredicate([](const FNamedOnlineSession &Session){
+        return Session.SessionSettings.bUsesPresence;
+    });
+}
+
+
+EOnlineSessionState::Type FLoopbackSessionInterface::GetSessionState(FName SessionName) const{
+    const FNamedOnlineSession *Session = Sessions.FindByPredicate([SessionName](const FNamedOnlineSession &Session){
+        return Session.SessionName == SessionName;
+    });
+    return Session ? Session->SessionState : EOnlineSessionState::NoSession;
+}
+
+
+int32 FLoopbackSessionInterface::GetNumSessions(){
+    return Sessions.Num();
+}
+
+
+FOnlineSessionSettings *FLoopbackSessionInterface::GetSessionSettings(FName SessionName){
+    FNamedOnlineSession *Session = GetNamedSession(SessionName);
+    return Session ? &Session->SessionSettings : nullptr;
+}
+
+
+void FLoopbackSessionInterface::DumpSessionState(){
+    UE_LOG(LogLoopbackSession, Log, TEXT("%d named sessions, %d advertised in the process"), Sessions.Num(), GetLoopbackRegistry().Num());
+    for (const FNamedOnlineSession &Session : Sessions){
+        UE_LOG(LogLoopbackSession, Log, TEXT("%s"), *Session.ToString());
+    }
+}
+
+
+/*
+Session lifetime
+*/
+bool FLoopbackSessionInterface::CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings &NewSessionSettings){
+    // There is no identity interface, so local players are identified by their number
+    return CreateSession(*FUniqueNetIdString::Create(FString::Printf(TEXT("LoopbackPlayer%d"), HostingPlayerNum), LOOPBACK_SUBSYSTEM), SessionName, NewSessionSettings);
+}
+
+
+bool FLoopbackSessionInterface::CreateSession(const FUniqueNetId &HostingPlayerId, FName SessionName, const FOnlineSessionSettings &NewSessionSettings){
+    if (GetNamedSession(SessionName)){
+        UE_LOG(LogLoopbackSession, Warning, TEXT("Cannot create session '%s': session already exists."), *SessionName.ToString());
+        return false;
+    }
+    FNamedOnlineSession *Session = AddNamedSession(SessionName, NewSessionSettings);
+    Session->SessionState = EOnlineSessionState::Creating;
+    Session->bHosting = true;
+    Session->OwningUserId = HostingPlayerId.AsShared();
+    Session->LocalOwnerId = HostingPlayerId.AsShared();
+    Session->OwningUserName = HostingPlayerId.ToString();
+    Session->NumOpenPublicConnections = NewSessionSettings.NumPublicConnections;
+    Session->NumOpenPrivateConnections = NewSessionSettings.NumPrivateConnections;
+    Session->SessionInfo = MakeShared<FLoopbackSessionInfo>(FGuid::NewGuid().ToString(), Config.HostAddress, Config.GamePort);
+
+    ScheduleRequest(SampleLatency(), [this, SessionName, bWasSuccessful = !RollError()](){
+        FNamedOnlineSession *CreatedSession = GetNamedSession(SessionName);
+        if (!CreatedSession || CreatedSession->SessionState != EOnlineSessionState::Creating){
+            return;
+        }
+        if (bWasSuccessful){
+            CreatedSession->SessionState = EOnlineSessionState::Pending;
+            // Advertise the session to every loopback interface of the process
+            GetLoopbackRegistry().Add(GetLoopbackSessionId(*CreatedSession), FLoopbackHostedSession{*CreatedSession, this});
+        }
+        else{
+            RemoveNamedSession(SessionName);
+        }
+        TriggerOnCreateSessionCompleteDelegates(SessionName, bWasSuccessful);
+    });
+    return true;
+}
+
+
+bool FLoopbackSessionInterface::StartSession(FName SessionName){
+    FNamedOnlineSession *Session = GetNamedSession(SessionName);
+    if (!Session || (Session->SessionState != EOnlineSessionState::Pending && Session->SessionState != EOnlineSessionState::Ended)){
+        UE_LOG(LogLoopbackSession, Warning, TEXT("Cannot start session '%s'."), *SessionName.ToString());
+        return false;
+    }
+    Session->SessionState = EOnlineSessionState::Starting;
+    ScheduleRequest(SampleLatency(), [this, SessionName, bWasSuccessful = !RollError()](){
+        FNamedOnlineSession *StartedSession = GetNamedSession(SessionName);
+        if (!StartedSession || StartedSession->SessionState != EOnlineSessionState::Starting){
+            return;
+        }
+        StartedSession->SessionState = bWasSuccessful ? EOnlineSessionState::InProgress : EOnlineSessionState::Pending;
+        TriggerOnStartSessionCompleteDelegates(SessionName, bWasSuccessful);
+    });
+    return true;
+}
+
+
+bool FLoopbackSessionInterface::UpdateSession(FName SessionName, FOnlineSessionSettings &UpdatedSessionSettings, bool bShouldRefreshOnlineData){
+    FNamedOnlineSession *Session = GetNamedSession(SessionName);
+    if (!Session){
+        return false;
+    }
+    Session->SessionSettings = UpdatedSessionSettings;
+    ScheduleRequest(SampleLatency(), [this, SessionName, bWasSuccessful = !RollError()](){
+        FNamedOnlineSession *UpdatedSession = GetNamedSession(SessionName);
+        if (!UpdatedSession){
+            return;
+        }
+        // Searches see the new settings once the update has reached the backend
+        if (bWasSuccessful){
+            if (FLoopbackHostedSession *HostedSession = GetLoopbackRegistry().Find(GetLoopbackSessionId(*UpdatedSession))){
+                HostedSession->Session.SessionSettings = UpdatedSession->SessionSettings;
+            }
+        }
+        TriggerOnUpdateSessionCompleteDelegates(SessionName, bWasSuccessful);
+    });
+    return true;
+}
+
+
+bool FLoopbackSessionInterface::EndSession(FName SessionName){
+    FNamedOnlineSession *Session = GetNamedSession(SessionName);
+    if (!Session || Session->SessionState != EOnlineSessionState::InProgress){
+        return false;
+    }
+    Session->SessionState = EOnlineSessionState::Ending;
+    ScheduleRequest(SampleLatency(), [this, SessionName](){
+        FNamedOnlineSession *EndedSession = GetNamedSession(SessionName);
+        if (!EndedSession || EndedSession->SessionState != EOnlineSessionState::Ending){
+            return;
+        }
+        EndedSession->SessionState = EOnlineSessionState::Ended;
+        TriggerOnEndSessionCompleteDelegates(SessionName, true);
+    });
+    return true;
+}
+
+
+bool FLoopbackSessionInterface::DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate &CompletionDelegate){
+    FNamedOnlineSession *Session = GetNamedSession(SessionName);
+    if (!Session || Session->SessionState == EOnlineSessionState::Destroying){
+        return false;
+    }
+    Session->SessionState = EOnlineSessionState::Destroying;
+    ScheduleRequest(SampleLatency(), [this, SessionName, CompletionDelegate, bWasSuccessful = !RollError()](){
+        FNamedOnlineSession *DestroyedSession = GetNamedSession(SessionName);
+        if (!DestroyedSession){
+            return;
+        }
+        if (bWasSuccessful){
+            const FString SessionId = GetLoopbackSessionId(*DestroyedSession);
+            if (DestroyedSession->bHosting){
+                GetLoopbackRegistry().Remove(SessionId);
+            }
+            // A leaving client frees its connection on the host
+            else if (FLoopbackHostedSession *HostedSession = GetLoopbackRegistry().Find(SessionId)){
+                HostedSession->Session.NumOpenPublicConnections = FMath::Min(HostedSession->Session.NumOpenPublicConnections + 1, HostedSession->Session.SessionSettings.NumPublicConnections);
+            }
+            RemoveNamedSession(SessionName);
+        }
+        else{
+            DestroyedSession->SessionState = EOnlineSessionState::Pending;
+        }
+        CompletionDelegate.ExecuteIfBound(SessionName, bWasSuccessful);
+        TriggerOnDestroySessionCompleteDelegates(SessionName, bWasSuccessful);
+    });
+    return true;
+}
+
+
+/*
+Session search
+*/
+bool FLoopbackSessionInterface::FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch> &SearchSettings){
+    if (CurrentSessionSearch.IsValid() && CurrentSessionSearch->SearchState == EOnlineAsyncTaskState::InProgress){
+        UE_LOG(LogLoopbackSession, Warning, TEXT("Ignoring game search request while one is pending"));
+        return false;
+    }
+    CurrentSessionSearch = SearchSettings;
+    SearchSettings->SearchResults.Reset();
+    SearchSettings->SearchState = EOnlineAsyncTaskState::InProgress;
+    const int32 SearchSerial = ++CurrentSearchSerial;
+
+    /*
+    Take a snapshot of what the backend would answer
+    */
+    TArray<FOnlineSessionSearchResult> Results;
+    for (const TPair<FString, FLoopbackHostedSession> &Entry : GetLoopbackRegistry()){
+        // Hosts don't find their own sessions, and lost packets never arrive
+        if (Entry.Value.Host == this || FMath::FRand() < Config.LossRatio){
+            continue;
+        }
+        if (Entry.Value.Session.SessionSettings.bIsLANMatch != SearchSettings->bIsLanQuery){
+            continue;
+        }
+        FOnlineSessionSearchResult &Result = Results.AddDefaulted_GetRef();
+        Result.Session = Entry.Value.Session;
+        Result.PingInMs = FMath::RoundToInt(SampleLatency() * 1000.0);
+        if (SearchSettings->MaxSearchResults > 0 && Results.Num() >= SearchSettings->MaxSearchResults){
+            break;
+        }
+    }
+    // Some searches complete before everything has been delivered
+    if (Results.Num() > 0 && FMath::FRand() < Config.PartialResultRate){
+        Results.SetNum(FMath::RandRange(0, Results.Num() - 1));
+    }
+    const bool bWasSuccessful = !RollError();
+    if (!bWasSuccessful){
+        Results.Reset();
+    }
+    ScheduleRequest(SampleLatency(), [this, SearchSerial, Results = MoveTemp(Results), bWasSuccessful]() mutable{
+        DeliverSearchResults(SearchSerial, MoveTemp(Results), 0, bWasSuccessful);
+    });
+    return true;
+}
+
+
+bool FLoopbackSessionInterface::FindSessions(const FUniqueNetId &SearchingPlayerId, const TSharedRef<FOnlineSessionSearch> &SearchSettings){
+    return FindSessions(0, SearchSettings);
+}
+
+
+void FLoopbackSessionInterface::DeliverSearchResults(int32 SearchSerial, TArray<FOnlineSessionSearchResult> Results, int32 FirstResult, bool bWasSuccessful){
+    // The search has been cancelled or replaced
+    if (SearchSerial != CurrentSearchSerial || !CurrentSessionSearch.IsValid()){
+        return;
+    }
+    const int32 BatchSize = Config.ResultBatchSize > 0 ? Config.ResultBatchSize : Results.Num();
+    const int32 LastResult = FMath::Min(FirstResult + BatchSize, Results.Num());
+    for (int32 Index = FirstResult; Index < LastResult; ++Index){
+        CurrentSessionSearch->SearchResults.Add(Results[Index]);
+    }
+    // Deliver the next batch later on, the results of the search show up one batch after another like on the real backends
+    if (LastResult < Results.Num()){
+        ScheduleRequest(Config.ResultBatchIntervalMs / 1000.0, [this, SearchSerial, Results = MoveTemp(Results), LastResult, bWasSuccessful]() mutable{
+            DeliverSearchResults(SearchSerial, MoveTemp(Results), LastResult, bWasSuccessful);
+        });
+        return;
+    }
+    CurrentSessionSearch->SearchState = bWasSuccessful ? EOnlineAsyncTaskState::Done : EOnlineAsyncTaskState::Failed;
+    CurrentSessionSearch.Reset();
+    TriggerOnFindSessionsCompleteDelegates(bWasSuccessful);
+}
+
+
+bool FLoopbackSessionInterface::CancelFindSessions(){
+    if (!CurrentSessionSearch.IsValid() || CurrentSessionSearch->SearchState != EOnlineAsyncTaskState::InProgress){
+        TriggerOnCancelFindSessionsCompleteDelegates(false);
+        return false;
+    }
+    // The remaining batches are dropped and the search doesn't complete
+    ++CurrentSearchSerial;
+    CurrentSessionSearch->SearchState = EOnlineAsyncTaskState::Failed;
+    CurrentSessionSearch.Reset();
+    TriggerOnCancelFindSessionsCompleteDelegates(true);
+    return true;
+}
+
+
+bool FLoopbackSessionInterface::FindSessionById(const FUniqueNetId &SearchingUserId, const FUniqueNetId &SessionId, const FUniqueNetId &FriendId, const FOnSingleSessionResultCompleteDelegate &CompletionDelegate){
+    ScheduleRequest(SampleLatency(), [SessionIdStr = SessionId.ToString(), CompletionDelegate, bWasSuccessful = !RollError()](){
+        FOnlineSessionSearchResult Result;
+        const FLoopbackHostedSession *HostedSession = bWasSuccessful ? GetLoopbackRegistry().Find(SessionIdStr) : nullptr;
+        if (HostedSession){
+            Result.Session = HostedSession->Session;
+        }
+        CompletionDelegate.ExecuteIfBound(0, HostedSession != nullptr, Result);
+    });
+    return true;
+}
+
+
+bool FLoopbackSessionInterface::PingSearchResults(const FOnlineSessionSearchResult &SearchResult){
+    return false;
+}
+
+
+/*
+Session joint
+*/
+bool FLoopbackSessionInterface::JoinSession(int32 PlayerNum, FName SessionName, const FOnlineSessionSearchResult &DesiredSession){
+    if (GetNamedSession(SessionName)){
+        UE_LOG(LogLoopbackSession, Warning, TEXT("Session (%s) already exists, can't join twice"), *SessionName.ToString());
+        TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::AlreadyInSession);
+        return false;
+    }
+    const FString SessionId = GetLoopbackSessionId(DesiredSession.Session);
+    if (SessionId.IsEmpty()){
+        TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::SessionDoesNotExist);
+        return false;
+    }
+    ScheduleRequest(SampleLatency(), [this, SessionName, SessionId, bWasSuccessful = !RollError()](){
+        if (!bWasSuccessful){
+            TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::UnknownError);
+            return;
+        }
+        // The session may have gone or filled up since it was found
+        FLoopbackHostedSession *HostedSession = GetLoopbackRegistry().Find(SessionId);
+        if (!HostedSession){
+            TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::SessionDoesNotExist);
+            return;
+        }
+        if (HostedSession->Session.NumOpenPublicConnections <= 0){
+            TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::SessionIsFull);
+            return;
+        }
+        --HostedSession->Session.NumOpenPublicConnections;
+        FNamedOnlineSession *Session = AddNamedSession(SessionName, HostedSession->Session);
+        Session->bHosting = false;
+        Session->SessionState = EOnlineSessionState::Pending;
+        TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::Success);
+    });
+    return true;
+}
+
+
+bool FLoopbackSessionInterface::JoinSession(const FUniqueNetId &PlayerId, FName SessionName, const FOnlineSessionSearchResult &DesiredSession){
+    return JoinSession(0, SessionName, DesiredSession);
+}
+
+
+bool FLoopbackSessionInterface::GetResolvedConnectString(FName SessionName, FString &ConnectInfo, FName PortType){
+    const FNamedOnlineSession *Session = GetNamedSession(SessionName);
+    if (!Session || !Session->SessionInfo.IsValid()){
+        return false;
+    }
+    const FLoopbackSessionInfo &SessionInfo = static_cast<const FLoopbackSessionInfo&>(*Session->SessionInfo);
+    ConnectInfo = FString::Printf(TEXT("%s:%d"), *SessionInfo.HostAddress, SessionInfo.HostPort);
+    return true;
+}
+
+
+bool FLoopbackSessionInterface::GetResolvedConnectString(const FOnlineSessionSearchResult &SearchResult, FName PortType, FString &ConnectInfo){
+    // Only results of this backend carry a loopback session info
+    const FString SessionId = GetLoopbackSessionId(SearchResult.Session);
+    if (SessionId.IsEmpty() || !GetLoopbackRegistry().Contains(SessionId)){
+        return false;
+    }
+    const FLoopbackSessionInfo &SessionInfo = static_cast<const FLoopbackSessionInfo&>(*SearchResult.Session.SessionInfo);
+    ConnectInfo = FString::Printf(TEXT("%s:%d"), *SessionInfo.HostAddress, SessionInfo.HostPort);
+    return true;
+}
+
+
+/*
+Players
+*/
+bool FLoopbackSessionInterface::IsPlayerInSession(FName SessionName, const FUniqueNetId &UniqueId){
+    const FNamedOnlineSession *Session = GetNamedSession(SessionName);
+    return Session && Session->RegisteredPlayers.ContainsByPredicate([&UniqueId](const FUniqueNetIdRef &PlayerId){
+        return *PlayerId == UniqueId;
+    });
+}
+
+
+bool FLoopbackSessionInterface::RegisterPlayer(FName SessionName, const FUniqueNetId &PlayerId, bool bWasInvited){
+    TArray<FUniqueNetIdRef> Players;
+    Players.Add(PlayerId.AsShared());
+    return RegisterPlayers(SessionName, Players, bWasInvited);
+}
+
+
+bool FLoopbackSessionInterface::RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef> &Players, bool bWasInvited){
+    FNamedOnlineSession *Session = GetNamedSession(SessionName);
+    if (Session){
+        for (const FUniqueNetIdRef &PlayerId : Players){
+            if (!IsPlayerInSession(SessionName, *PlayerId)){
+                Session->RegisteredPlayers.Add(PlayerId);
+            }
+        }
+    }
+    TriggerOnRegisterPlayersCompleteDelegates(SessionName, Players, Session != nullptr);
+    return Session != nullptr;
+}
+
+
+bool FLoopbackSessionInterface::UnregisterPlayer(FName SessionName, const FUniqueNetId &PlayerId){
+    TArray<FUniqueNetIdRef> Players;
+    Players.Add(PlayerId.AsShared());
+    return UnregisterPlayers(SessionName, Players);
+}
+
+
+bool FLoopbackSessionInterface::UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef> &Players){
+    FNamedOnlineSession *Session = GetNamedSession(SessionName);
+    if (Session){
+        for (const FUniqueNetIdRef &PlayerId : Players){
+            Session->RegisteredPlayers.RemoveAll([&PlayerId](const FUniqueNetIdRef &RegisteredPlayerId){
+                return *RegisteredPlayerId == *PlayerId;
+            });
+        }
+    }
+    TriggerOnUnregisterPlayersCompleteDelegates(SessionName, Players, Session != nullptr);
+    return Session != nullptr;
+}
+
+
+void FLoopbackSessionInterface::RegisterLocalPlayer(const FUniqueNetId &PlayerId, FName SessionName, const FOnRegisterLocalPlayerCompleteDelegate &Delegate){
+    Delegate.ExecuteIfBound(PlayerId, EOnJoinSessionCompleteResult::Success);
+}
+
+
+void FLoopbackSessionInterface::UnregisterLocalPlayer(const FUniqueNetId &PlayerId, FName SessionName, const FOnUnregisterLocalPlayerCompleteDelegate &Delegate){
+    Delegate.ExecuteIfBound(PlayerId, true);
+}
+
+
+void FLoopbackSessionInterface::RemovePlayerFromSession(int32 LocalUserNum, FName SessionName, const FUniqueNetId &TargetPlayerId){
+    UnregisterPlayer(SessionName, TargetPlayerId);
+}
+
+
+/*
+Not supported by the loopback backend
+*/
+bool FLoopbackSessionInterface::StartMatchmaking(const TArray<FUniqueNetIdRef> &LocalPlayers, FName SessionName, const FOnlineSessionSettings &NewSessionSettings, TSharedRef<FOnlineSessionSearch> &SearchSettings){
+    TriggerOnMatchmakingCompleteDelegates(SessionName, false);
+    return false;
+}
+
+
+bool FLoopbackSessionInterface::CancelMatchmaking(int32 SearchingPlayerNum, FName SessionName){
+    TriggerOnCancelMatchmakingCompleteDelegates(SessionName, false);
+    return false;
+}
+
+
+bool FLoopbackSessionInterface::CancelMatchmaking(const FUniqueNetId &SearchingPlayerId, FName SessionName){
+    TriggerOnCancelMatchmakingCompleteDelegates(SessionName, false);
+    return false;
+}
+
+
+bool FLoopbackSessionInterface::FindFriendSession(int32 LocalUserNum, const FUniqueNetId &Friend){
+    TriggerOnFindFriendSessionCompleteDelegates(LocalUserNum, false, TArray<FOnlineSessionSearchResult>());
+    return false;
+}
+
+
+bool FLoopbackSessionInterface::FindFriendSession(const FUniqueNetId &LocalUserId, const FUniqueNetId &Friend){
+    return FindFriendSession(0, Friend);
+}
+
+
+bool FLoopbackSessionInterface::FindFriendSession(const FUniqueNetId &LocalUserId, const TArray<FUniqueNetIdRef> &FriendList){
+    TriggerOnFindFriendSessionCompleteDelegates(0, false, TArray<FOnlineSessionSearchResult>());
+    return false;
+}
+
+
+bool FLoopbackSessionInterface::SendSessionInviteToFriend(int32 LocalUserNum, FName SessionName, const FUniqueNetId &Friend){
+    return false;
+}
+
+
+bool FLoopbackSessionInterface::SendSessionInviteToFriend(const FUniqueNetId &LocalUserId, FName SessionName, const FUniqueNetId &Friend){
+    return false;
+}
+
+
+bool FLoopbackSessionInterface::SendSessionInviteToFriends(int32 LocalUserNum, FName SessionName, const TArray<FUniqueNetIdRef> &Friends){
+    return false;
+}
+
+
+bool FLoopbackSessionInterface::SendSessionInviteToFriends(const FUniqueNetId &LocalUserId, FName SessionName, const TArray<FUniqueNetIdRef> &Friends){
+    return false;
+}
+
+
+FString FLoopbackSessionInterface::GetVoiceChatRoomName(int32 LocalUserNum, const FName &SessionName){
+    return FString();
+}
@@ -5,6 +5,7 @@
 #include "Components/Button.h"
 #include "OnlineSessionSettings.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "GameFramework/GameModeBase.h"
 
 
 void UMenu::HostButtonClicked(){
@@ -16,6 +17,8 @@ void UMenu::HostButtonClicked(){
     */
     // Check if MultiplayerSessionsSubsystem pointer is valid
     if (MultiplayerSessionsSubsystem){
+        // Load the lobby map while the session is being created, the travel picks it up from memory
+        MultiplayerSessionsSubsystem->PreloadPackage(LobbyPackageName);
         // Call CreateSession function
         MultiplayerSessionsSubsystem->CreateSession(NumPublicConnections, MatchType);
     }    
@@ -27,16 +30,28 @@ void UMenu::JoinButtonClicked(){
     JoinButton->SetIsEnabled(false);
 
     /*
-    Find an active session
+    Join the first active session that shows up
     */
     if (MultiplayerSessionsSubsystem){
-        MultiplayerSessionsSubsystem->FindSessions(
-            10000 // Max session search results
+        // Prefetched results of the same search are joined right away
+        MultiplayerSessionsSubsystem->QuickJoin(
+            MakeJoinFilter(),
+            JoinSearchTimeout,
+            MaxJoinSearchResults // Max session search results
         );
     }
 }
 
 
+FSessionSearchFilter UMenu::MakeJoinFilter() const{
+    // Only sessions of our match type with a free slot are of interest
+    FSessionSearchFilter Filter;
+    Filter.MatchType = MatchType;
+    Filter.MinOpenSlots = 1;
+    return Filter;
+}
+
+
 // Exit from this function with false if the super version returns false, otherwise bind callbacks and return true
 bool UMenu::Initialize(){
     // Call the super version
@@ -78,10 +93,14 @@ void UMenu::OnCreateSession(bool bWasSuccessful){
         Travel to lobby level and open it as a listen server
         */
         UWorld *World = GetWorld();
-        if (World){
-            World->ServerTravel(
-				FString(PathToLobby)
-            );
+        // A travel that is already under way is left alone
+        if (World && World->NextURL.IsEmpty() && !World->IsInSeamlessTravel()){
+            // Fall back to the hard travel if the seamless one can't be started
+            if (!bUseSeamlessTravel || !ServerTravelSeamless(World)){
+                World->ServerTravel(
+				    FString(PathToLobby)
+                );
+            }
         }
     }
     else{
@@ -95,59 +114,67 @@ void UMenu::OnCreateSession(bool bWasSuccessful){
                 FString(TEXT("Failed to create session!"))
             );
         }
+        // There won't be a travel to the preloaded lobby map
+        if (MultiplayerSessionsSubsystem){
+            MultiplayerSessionsSubsystem->ReleasePreloadedPackage();
+        }
         // Enable HostButton
         HostButton->SetIsEnabled(true);
     }
 }
 
 
-void UMenu::OnFindSessions(const TArray<FOnlineSessionSearchResult> &SessionResults, bool bWasSuccessful){
-    // If the MultiplayerSessionsSubsystem pointer is not null
-    if (MultiplayerSessionsSubsystem == nullptr){
-        return;
+bool UMenu::ServerTravelSeamless(UWorld *World){
+    AGameModeBase *GameMode = World->GetAuthGameMode();
+    // Seamless travel is switched on in the defaults of the game mode (see README), the menu doesn't change it at runtime
+    if (GameMode == nullptr || !GameMode->bUseSeamlessTravel){
+        return false;
     }
-    for (auto Result : SessionResults){
-        FString SettingsValue;
-        // Check if it has a matching key value pair that we are looking for
-        Result.Session.SessionSettings.Get(FName("MatchType"), MatchType);
-        // If it's the correct match type
-        if (SettingsValue == MatchType){
-            // Call JoinSession
-            MultiplayerSessionsSubsystem->JoinSession(Result);
-            return;
+    // Check everything ServerTravel would refuse (e.g. a lobby package that doesn't exist) before changing anything, so that the hard travel starts from an untouched menu
+    if (!GameMode->CanServerTravel(LobbyPackageName, false)){
+        return false;
+    }
+    // Seamless travel keeps the net driver rather than creating one from the '?listen' option, so start listening before leaving
+    bool bHasStartedListening = false;
+    if (World->GetNetMode() == NM_Standalone){
+        FURL ListenURL(nullptr, *PathToLobby, TRAVEL_Absolute);
+        if (!World->Listen(ListenURL)){
+            return false;
         }
+        bHasStartedListening = true;
     }
-    // Enable JoinButton if failed to find session or no session is found
-    if (!bWasSuccessful || SessionResults.Num() == 0){
-        JoinButton->SetIsEnabled(true);
+    if (!World->ServerTravel(LobbyPackageName)){
+        // The hard travel opens its own net driver from the '?listen' option
+        if (bHasStartedListening){
+            GEngine->ShutdownWorldNetDriver(World);
+        }
+        return false;
     }
+    // The travel has started and the player controller survives it, so the menu has to release it now rather than when the old world goes away
+    MenuTearDown();
+    return true;
 }
 
 
 void UMenu::OnJoinSession(EOnJoinSessionCompleteResult::Type Result){
-    // Get online subsystem
-    IOnlineSubsystem *OnlineSubsystem = IOnlineSubsystem::Get();
-    if (OnlineSubsystem){
-        // Make a local pointer for session interface
-        IOnlineSessionPtr SessionInterface = OnlineSubsystem->GetSessionInterface();
-        // Check if OnlineSessionInterface is valid
-        if (SessionInterface.IsValid()){ // The way to check if TSharedPtr is valid is by using the 'IsValid' function
-            FString Address;
-            bool AddressExist = SessionInterface->GetResolvedConnectString(NAME_GameSession, Address); // This function will fill in that string with the address we need
-            // Call ClientTravel
-            APlayerController *PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
-            if (PlayerController){
-                PlayerController->ClientTravel(
-                    Address,
-                    ETravelType::TRAVEL_Absolute
-                );
-            }
+    /*
+    Travel to the host
+    */
+    // A client connects to the host with an absolute travel, seamless travel only applies to the travels the host makes afterwards
+    FString Address;
+    if (Result == EOnJoinSessionCompleteResult::Success && MultiplayerSessionsSubsystem && MultiplayerSessionsSubsystem->GetResolvedConnectString(Address)){ // This function will fill in that string with the address we need
+        // Call ClientTravel
+        APlayerController *PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
+        if (PlayerController){
+            PlayerController->ClientTravel(
+                Address,
+                ETravelType::TRAVEL_Absolute
+            );
+            return;
         }
     }
     // Enable JoinButton if failed to join session
-    if (Result != EOnJoinSessionCompleteResult::Success){
-        JoinButton->SetIsEnabled(true);
-    }
+    JoinButton->SetIsEnabled(true);
 }
 
 
@@ -159,13 +186,16 @@ void UMenu::OnStartSession(bool bWasSuccessful){
 }
 
 
-void UMenu::MenuSetup(int32 NumberOfPublicConnections, FString TypeOfMatch, FString LobbyPath){
+void UMenu::MenuSetup(int32 NumberOfPublicConnections, FString TypeOfMatch, FString LobbyPath, bool bPrefetchSessions, bool bSeamlessTravel){
     /*
     Set member variables with inputs
     */
     NumPublicConnections = NumberOfPublicConnections;
     MatchType = TypeOfMatch;
     PathToLobby = FString::Printf(TEXT("%s?listen"), *LobbyPath); // 
+    LobbyPackageName = LobbyPath;
+    bUseSeamlessTravel = bSeamlessTravel;
+    bIsTornDown = false;
 
     // Add the widget to viewport
     AddToViewport();
@@ -209,18 +239,45 @@ void UMenu::MenuSetup(int32 NumberOfPublicConnections, FString TypeOfMatch, FStr
     */
     if (MultiplayerSessionsSubsystem){
         MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete.AddDynamic(this, &UMenu::OnCreateSession);
-        MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsComplete.AddUObject(this, &UMenu::OnFindSessions);
         MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionsComplete.AddUObject(this, &UMenu::OnJoinSession);
         MultiplayerSessionsSubsystem->MultiplayerOnDestroySessionComplete.AddDynamic(this, &UMenu::OnDestroySession);
         MultiplayerSessionsSubsystem->MultiplayerOnStartSessionComplete.AddDynamic(this, &UMenu::OnStartSession);
+
+        // Rank the sessions of our match type and build first
+        FSessionRankingPreferences RankingPreferences;
+        RankingPreferences.MatchType = MatchType;
+        RankingPreferences.BuildUniqueId = 1; // Same build id as the sessions created by CreateSession
+        MultiplayerSessionsSubsystem->SetRankingPreferences(RankingPreferences);
+
+        // Start searching before the player clicks Join
+        if (bPrefetchSessions){
+            MultiplayerSessionsSubsystem->StartSearchPrefetch(MaxJoinSearchResults, MakeJoinFilter());
+        }
     }
 }
 
 
 void UMenu::MenuTearDown(){
+    // Seamless travel tears the menu down before the old world destructs it
+    if (bIsTornDown){
+        return;
+    }
+    bIsTornDown = true;
     // Remove the widget from the viewport
     RemoveFromParent();
 
+    /*
+    Unbind callback functions from the subsystem, which outlives the menu
+    */
+    if (MultiplayerSessionsSubsystem){
+        // Nobody is going to join the prefetched sessions anymore
+        MultiplayerSessionsSubsystem->StopSearchPrefetch();
+        MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete.RemoveDynamic(this, &UMenu::OnCreateSession);
+        MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionsComplete.RemoveAll(this);
+        MultiplayerSessionsSubsystem->MultiplayerOnDestroySessionComplete.RemoveDynamic(this, &UMenu::OnDestroySession);
+        MultiplayerSessionsSubsystem->MultiplayerOnStartSessionComplete.RemoveDynamic(this, &UMenu::OnStartSession);
+    }
+
     /*
     Reset the input mode
     */
@@ -2,9 +2,24 @@
 
 #include "MultiplayerSessionsSubsystem.h"
 
+#include "Async/Async.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/PlayerController.h"
 #include "OnlineSubsystem.h"
 #include "OnlineSessionSettings.h"
 #include "Online/OnlineSessionNames.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+#include "LoopbackSessionInterface.h"
+
+
+DECLARE_CYCLE_STAT(TEXT("Collect Search Results"), STAT_SessionCollectSearchResults, STATGROUP_MultiplayerSessions);
+DECLARE_CYCLE_STAT(TEXT("Rank Search Results"), STAT_SessionRankSearchResults, STATGROUP_MultiplayerSessions);
+DECLARE_CYCLE_STAT(TEXT("Process Search Results"), STAT_SessionProcessSearchResults, STATGROUP_MultiplayerSessions);
 
 
 UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem() :
@@ -25,255 +40,2160 @@ UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem() :
     ),
     StartSessionCompleteDelegate(
         FOnStartSessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnStartSessionComplete)
+    ),
+    UpdateSessionCompleteDelegate(
+        FOnUpdateSessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnUpdateSessionComplete)
     ){
+}
+
+
+void UMultiplayerSessionsSubsystem::Initialize(FSubsystemCollectionBase &Collection){
+    // Call the super version
+    Super::Initialize(Collection);
+
+    /*
+    Get session interface, unless one has been injected already
+    */
+    // The loopback backend stands in for the online subsystem when selected with 'SessionBackend=Loopback' in the [MultiplayerSessions] section of the game ini or '-SessionBackend=Loopback' on the command line
+    FString SessionBackend;
+    GConfig->GetString(TEXT("MultiplayerSessions"), TEXT("SessionBackend"), SessionBackend, GGameIni);
+    FParse::Value(FCommandLine::Get(), TEXT("SessionBackend="), SessionBackend);
+    if (!SessionInterface.IsValid() && SessionBackend == TEXT("Loopback")){
+        SessionInterface = MakeShared<FLoopbackSessionInterface, ESPMode::ThreadSafe>(FLoopbackSessionConfig::Load());
+        SubsystemName = LOOPBACK_SUBSYSTEM;
+    }
+    if (!SessionInterface.IsValid()){
+        IOnlineSubsystem *OnlineSubsystem = IOnlineSubsystem::Get();
+        if (OnlineSubsystem){
+            SessionInterface = OnlineSubsystem->GetSessionInterface();
+            SubsystemName = OnlineSubsystem->GetSubsystemName();
+        }
+    }
+    BindSessionDelegates();
+    // A dedicated server has no local player, so its sessions are hosted with the identity of the server
+    bIsDedicatedServer = IsRunningDedicatedServer();
+    // Offer the sessions joined in earlier runs right away, a dedicated server doesn't join any
+    if (!bIsDedicatedServer){
+        KnownHostLookup->Load(FSessionKnownHosts::GetDefaultFilePath());
+    }
+    // The preloaded package has served its purpose once the travel has loaded a map
+    PostLoadMapDelegateHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UMultiplayerSessionsSubsystem::OnPostLoadMap);
+}
+
+
+void UMultiplayerSessionsSubsystem::Deinitialize(){
+    UnbindSessionDelegates();
+    FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapDelegateHandle);
+    ReleasePreloadedPackage();
+    // Drop whatever is still queued
+    PendingOperations.Empty();
+    bIsSearchInProgress = false;
+    CancelSearchProcessing();
+    NamedSessions.Empty();
+    LastSessionSearch.Reset();
+    ObjectPool.Reset();
+    StopSearchPolling();
+    CancelMatchmaking();
+    StopSearchPrefetch();
+    StopSessionUpdates();
+    StopProbeResponder();
+    KnownHostLookup->Save();
+    // Call the super version
+    Super::Deinitialize();
+}
+
+
+void UMultiplayerSessionsSubsystem::SetSessionInterface(IOnlineSessionPtr NewSessionInterface, FName NewSubsystemName){
+    UnbindSessionDelegates();
+
+    /*
+    Forget everything that belongs to the previous session interface
+    */
+    // Its completions won't arrive anymore
+    PendingOperations.Empty();
+    // Neither is the session joined last reachable through the new one
+    ForgetLastJoinedSession();
+    bIsSearchInProgress = false;
+    CancelSearchProcessing();
+    for (TPair<FName, TUniquePtr<FNamedSessionState>> &NamedSession : NamedSessions){
+        NamedSession.Value->OperationState = ESessionOperationState::Idle;
+        ObjectPool.ReleaseSettings(NamedSession.Value->Settings);
+        DiscardDirtySettings(*NamedSession.Value);
+    }
+    Reservations->CancelAll();
+    // Nor do its sessions take reservations anymore
+    Reservations->RemoveHostedSessions();
+    StopSessionUpdates();
+    bIsQuickJoinActive = false;
+    StopSearchPolling();
+    PendingSearchResults.Reset();
+    ObjectPool.ReleaseSearch(LastSessionSearch);
+    LastSearchResults.Reset();
+    RankedSearchResults.Reset();
+    // Its sessions aren't visible through the new one
+    InvalidateSearchCache();
+    CancelMatchmaking();
+    if (Matchmaker.IsValid()){
+        Matchmaker->Reset();
+    }
+
+    /*
+    Switch to the new session interface
+    */
+    SessionInterface = NewSessionInterface;
+    SubsystemName = NewSubsystemName;
+    BindSessionDelegates();
+}
+
+
+void UMultiplayerSessionsSubsystem::BindSessionDelegates(){
+    /*
+    Bind the session delegates once, so that overlapping operations don't overwrite each other's handles
+    */
+    if (SessionInterface.IsValid() && !bAreSessionDelegatesBound){
+        CreateSessionCompleteDelegateHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate);
+        FindSessionsCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
+        JoinSessionCompleteDelegateHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate);
+        DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate);
+        StartSessionCompleteDelegateHandle = SessionInterface->AddOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate);
+        UpdateSessionCompleteDelegateHandle = SessionInterface->AddOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegate);
+        bAreSessionDelegatesBound = true;
+    }
+}
+
+
+void UMultiplayerSessionsSubsystem::UnbindSessionDelegates(){
+    /*
+    Unbind the session delegates
+    */
+    if (SessionInterface.IsValid() && bAreSessionDelegatesBound){
+        SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
+        SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+        SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
+        SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
+        SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
+        SessionInterface->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegateHandle);
+    }
+    bAreSessionDelegatesBound = false;
+}
+
+
+void UMultiplayerSessionsSubsystem::EnqueueOperation(FSessionOperation Operation){
     /*
-    Get session interface
+    Coalesce with the queued operations
     */
-    IOnlineSubsystem *OnlineSubsystem = IOnlineSubsystem::Get();
-    if (OnlineSubsystem){
-        SessionInterface = OnlineSubsystem->GetSessionInterface();
+    for (FSessionOperation &QueuedOperation : PendingOperations){
+        if (QueuedOperation.Type != Operation.Type){
+            continue;
+        }
+        if (Operation.Type == ESessionOperationType::Find){
+            // Repeated searches collapse into one, a foreground request makes the merged search foreground
+            if (QueuedOperation.Query == Operation.Query){
+                QueuedOperation.bIsBackground &= Operation.bIsBackground;
+                QueuedOperation.PageSize = FMath::Max(QueuedOperation.PageSize, Operation.PageSize);
+            }
+            // The latest foreground search replaces an older one, a background refresh never does
+            else if (!Operation.bIsBackground){
+                QueuedOperation = Operation;
+            }
+            ProcessOperationQueue();
+            return;
+        }
+        if (QueuedOperation.SessionName != Operation.SessionName){
+            continue;
+        }
+        // The latest creation or joint of a session replaces an older one that hasn't run yet
+        if (Operation.Type == ESessionOperationType::Create || Operation.Type == ESessionOperationType::Join){
+            QueuedOperation = Operation;
+        }
+        // Destroying, starting or updating a session twice is pointless, a queued update sends whatever is pending when it runs
+        ProcessOperationQueue();
+        return;
+    }
+    PendingOperations.Add(MoveTemp(Operation));
+    ProcessOperationQueue();
+}
+
+
+void UMultiplayerSessionsSubsystem::ProcessOperationQueue(){
+    // Operations enqueued by callbacks during processing get picked up by the loop below
+    if (bIsProcessingOperations){
+        return;
+    }
+    bIsProcessingOperations = true;
+    // Run every operation whose session (or the search) is free, operations on the same session keep their order and operations that fail right away don't block the queue
+    bool bHasExecutedOperation = true;
+    while (bHasExecutedOperation){
+        bHasExecutedOperation = false;
+        bool bIsSearchBlocked = bIsSearchInProgress;
+        TArray<FName, TInlineAllocator<4>> BlockedSessionNames;
+        for (int32 Index = 0; Index < PendingOperations.Num(); ++Index){
+            const FSessionOperation &QueuedOperation = PendingOperations[Index];
+            if (QueuedOperation.Type == ESessionOperationType::Find){
+                const bool bIsBlocked = bIsSearchBlocked;
+                bIsSearchBlocked = true;
+                if (bIsBlocked){
+                    continue;
+                }
+            }
+            else{
+                const bool bIsBlocked = BlockedSessionNames.Contains(QueuedOperation.SessionName) || GetOperationState(QueuedOperation.SessionName) != ESessionOperationState::Idle;
+                BlockedSessionNames.AddUnique(QueuedOperation.SessionName);
+                if (bIsBlocked){
+                    continue;
+                }
+            }
+            // Executing may change the queue (e.g. pipelining a destruction), so start over afterwards
+            const FSessionOperation Operation = QueuedOperation;
+            PendingOperations.RemoveAt(Index);
+            ExecuteOperation(Operation);
+            bHasExecutedOperation = true;
+            break;
+        }
+    }
+    bIsProcessingOperations = false;
+}
+
+
+bool UMultiplayerSessionsSubsystem::ExecuteOperation(const FSessionOperation &Operation){
+    switch (Operation.Type){
+        case ESessionOperationType::Create:
+            return ExecuteCreateSession(Operation);
+        case ESessionOperationType::Find:{
+            bIsQuickJoinActive = Operation.bIsQuickJoin;
+            QuickJoinDeadline = Operation.QuickJoinDeadline;
+            SearchPageSize = Operation.PageSize;
+            const bool bIsWaiting = StartSessionSearch(Operation.Query, Operation.bIsBackground);
+            // A quick join whose search couldn't even be started
+            if (!bIsWaiting && bIsQuickJoinActive){
+                bIsQuickJoinActive = false;
+                MultiplayerOnJoinSessionsComplete.Broadcast(
+                    EOnJoinSessionCompleteResult::UnknownError
+                );
+            }
+            return bIsWaiting;
+        }
+        case ESessionOperationType::Join:
+            return ExecuteJoinSession(Operation);
+        case ESessionOperationType::Destroy:
+            return ExecuteDestroySession(Operation);
+        case ESessionOperationType::Start:
+            return ExecuteStartSession(Operation);
+        case ESessionOperationType::Update:
+            return ExecuteUpdateSession(Operation);
+        default:
+            return false;
+    }
+}
+
+
+FUniqueNetIdPtr UMultiplayerSessionsSubsystem::GetLocalPlayerNetId() const{
+    // A dedicated server has neither a world with a local player nor a player login
+    if (bIsDedicatedServer){
+        return nullptr;
+    }
+    UWorld *World = GetWorld();
+    const ULocalPlayer *LocalPlayer = World ? World->GetFirstLocalPlayerFromController() : nullptr;
+    return LocalPlayer ? LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId() : nullptr;
+}
+
+
+FNamedSessionState &UMultiplayerSessionsSubsystem::GetOrAddNamedSession(FName SessionName){
+    TUniquePtr<FNamedSessionState> &SessionState = NamedSessions.FindOrAdd(SessionName);
+    if (!SessionState.IsValid()){
+        SessionState = MakeUnique<FNamedSessionState>();
+        SessionState->SessionName = SessionName;
     }
+    return *SessionState;
 }
 
 
-void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, FString MatchType){
+FNamedSessionState *UMultiplayerSessionsSubsystem::FindNamedSession(FName SessionName){
+    TUniquePtr<FNamedSessionState> *SessionState = NamedSessions.Find(SessionName);
+    return SessionState ? SessionState->Get() : nullptr;
+}
+
+
+ESessionOperationState UMultiplayerSessionsSubsystem::GetOperationState(FName SessionName) const{
+    const TUniquePtr<FNamedSessionState> *SessionState = NamedSessions.Find(SessionName);
+    return SessionState ? (*SessionState)->OperationState : ESessionOperationState::Idle;
+}
+
+
+TSharedPtr<const FOnlineSessionSettings> UMultiplayerSessionsSubsystem::GetSessionSettings(FName SessionName) const{
+    const TUniquePtr<FNamedSessionState> *SessionState = NamedSessions.Find(SessionName);
+    return SessionState ? (*SessionState)->Settings : nullptr;
+}
+
+
+FMultiplayerOnSessionOperationComplete &UMultiplayerSessionsSubsystem::OnSessionOperationComplete(FName SessionName){
+    return GetOrAddNamedSession(SessionName).OnOperationComplete;
+}
+
+
+void UMultiplayerSessionsSubsystem::BeginSessionOperation(FNamedSessionState &SessionState, const FSessionOperation &Operation, ESessionOperationState OperationState){
+    // Called before the operation is sent, since some backends complete right inside the call
+    SessionState.ActiveOperation = Operation;
+    SessionState.ActiveOperation.BeginTime = Stats.BeginOperation(Operation.Type, Operation.SessionName);
+    SessionState.OperationState = OperationState;
+}
+
+
+void UMultiplayerSessionsSubsystem::CompleteSessionOperation(FNamedSessionState &SessionState, bool bWasSuccessful){
+    SessionState.OperationState = ESessionOperationState::Idle;
+    Stats.EndOperation(SessionState.ActiveOperation.Type, SessionState.ActiveOperation.BeginTime, bWasSuccessful, 0, 0, SessionState.ActiveOperation.SessionName);
+}
+
+
+bool UMultiplayerSessionsSubsystem::CompleteRefusedOperation(FNamedSessionState &SessionState, ESessionOperationState OperationState){
+    // Some backends report the failure through the completion delegate before returning false, in which case the operation is complete already
+    if (SessionState.OperationState != OperationState){
+        return false;
+    }
+    CompleteSessionOperation(SessionState, false);
+    return true;
+}
+
+
+FNamedSessionState *UMultiplayerSessionsSubsystem::FindWaitingSession(FName SessionName, ESessionOperationState OperationState){
+    // The backend reports every session through the same delegates, so the session name picks the state
+    FNamedSessionState *SessionState = FindNamedSession(SessionName);
+    return SessionState && SessionState->OperationState == OperationState ? SessionState : nullptr;
+}
+
+
+void UMultiplayerSessionsSubsystem::BroadcastSessionOperation(FName SessionName, ESessionOperationType OperationType, bool bWasSuccessful){
+    // The delegates without session name keep reporting the game session only
+    if (SessionName == NAME_GameSession){
+        switch (OperationType){
+            case ESessionOperationType::Create:
+                MultiplayerOnCreateSessionComplete.Broadcast(bWasSuccessful);
+                break;
+            case ESessionOperationType::Destroy:
+                MultiplayerOnDestroySessionComplete.Broadcast(bWasSuccessful);
+                break;
+            case ESessionOperationType::Start:
+                MultiplayerOnStartSessionComplete.Broadcast(bWasSuccessful);
+                break;
+            default:
+                break;
+        }
+    }
+    if (FNamedSessionState *SessionState = FindNamedSession(SessionName)){
+        SessionState->OnOperationComplete.Broadcast(SessionName, OperationType, bWasSuccessful);
+    }
+    MultiplayerOnSessionOperationComplete.Broadcast(SessionName, OperationType, bWasSuccessful);
+}
+
+
+void UMultiplayerSessionsSubsystem::BroadcastJoinSession(FName SessionName, EOnJoinSessionCompleteResult::Type Result){
+    // A rejoin travels on its own, since whoever joined the session the first time (e.g. the menu) is gone by now
+    if (bIsRejoinActive && SessionName == LastJoinedSessionName){
+        bIsRejoinActive = false;
+        if (Result == EOnJoinSessionCompleteResult::Success && !TravelToJoinedSession(SessionName)){
+            Result = EOnJoinSessionCompleteResult::CouldNotRetrieveAddress;
+        }
+        // The session is gone, so there is nothing to rejoin anymore
+        else if (Result == EOnJoinSessionCompleteResult::SessionDoesNotExist){
+            ForgetLastJoinedSession();
+        }
+    }
+    // The delegate without session name keeps reporting the game session only
+    if (SessionName == NAME_GameSession){
+        MultiplayerOnJoinSessionsComplete.Broadcast(Result);
+    }
+    const bool bWasSuccessful = Result == EOnJoinSessionCompleteResult::Success;
+    if (FNamedSessionState *SessionState = FindNamedSession(SessionName)){
+        SessionState->OnOperationComplete.Broadcast(SessionName, ESessionOperationType::Join, bWasSuccessful);
+    }
+    MultiplayerOnSessionOperationComplete.Broadcast(SessionName, ESessionOperationType::Join, bWasSuccessful);
+}
+
+
+void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, FString MatchType, FName SessionName, int32 MatchPort){
     // Check if SessionInterface is not valid
     if (!SessionInterface.IsValid()){ // The way to check if TSharedPtr is valid is by using the 'IsValid' function
         return;
     }
 
+    /*
+    Queue the session creation, an existing session gets destroyed right before it by the queue
+    */
+    FSessionOperation Operation;
+    Operation.Type = ESessionOperationType::Create;
+    Operation.SessionName = SessionName; // Every name is a session of its own, creating one under a name that exists replaces that session
+    Operation.NumPublicConnections = NumPublicConnections;
+    Operation.MatchType = MatchType;
+    Operation.MatchPort = MatchPort;
+    EnqueueOperation(MoveTemp(Operation));
+}
+
+
+bool UMultiplayerSessionsSubsystem::ExecuteCreateSession(const FSessionOperation &Operation){
+    // Check if SessionInterface is not valid
+    if (!SessionInterface.IsValid()){
+        BroadcastSessionOperation(Operation.SessionName, ESessionOperationType::Create, false);
+        return false;
+    }
+
     /*
     Check and destroy the existing session
     */
     // Get the existing session pointer
     auto ExistingSession = SessionInterface->GetNamedSession(
-        NAME_GameSession // If we always use this NAME_GameSession, then we'll always be checking to see if a session with this name exists
+        Operation.SessionName
     );
 	// Check to see if the existing session pointer is not null
 	if (ExistingSession != nullptr)
 	{
-        /* Destroy the existing session */
-        // SessionInterface->DestroySession(
-        //     NAME_GameSession // Same as above
-        // ); // We should be handling this call in DestroySession rather than accessing the SessionInterface directly
-        bCreateSessionOnDestroy = true;
-        LastNumPublicConnections = NumPublicConnections;
-        LastMatchType = MatchType;
-        DestroySession();
+        // The session is still there although it has been destroyed for this creation
+        if (Operation.bHasDestroyedExistingSession){
+            BroadcastSessionOperation(Operation.SessionName, ESessionOperationType::Create, false);
+            return false;
+        }
+        // Pipeline the destruction and the creation, the creation runs as soon as the destruction completes without a round trip through the UI
+        FSessionOperation CreateAfterDestroy = Operation;
+        CreateAfterDestroy.bHasDestroyedExistingSession = true;
+        PendingOperations.Insert(MoveTemp(CreateAfterDestroy), 0);
+        FSessionOperation DestroyOperation;
+        DestroyOperation.Type = ESessionOperationType::Destroy;
+        DestroyOperation.SessionName = Operation.SessionName;
+        return ExecuteDestroySession(DestroyOperation);
     }
 
 	/*
     Create a new session
     */
-    // Add CreateSessionCompleteDelegate to SessionInterface's delegate list and store it in a FDelegateHandle
-    CreateSessionCompleteDelegateHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate); // Once a session is created, then the fallback function which bound to this delegate will be called
-    // Initialize LastSessionSettings TSharedPtr to class FOnlineSessionSettings
-    LastSessionSettings = MakeShareable(new FOnlineSessionSettings());
+    FNamedSessionState &SessionState = GetOrAddNamedSession(Operation.SessionName);
+    // Every session keeps the settings it was created with, the ones of its previous creation go back to the pool
+    ObjectPool.ReleaseSettings(SessionState.Settings);
+    bool bWereSettingsReused = false;
+    SessionState.Settings = ObjectPool.AcquireSettings(bWereSettingsReused);
+    Stats.RecordSettingsAcquire(bWereSettingsReused);
+    FOnlineSessionSettings &SessionSettings = *SessionState.Settings;
     // Configure session settings
-    LastSessionSettings->bIsLANMatch = IOnlineSubsystem::Get()->GetSubsystemName() == "Null" ? true : false; // Using ternary operator by checking SubsystemName to decide whether to connect over the internet
-    LastSessionSettings->NumPublicConnections = NumPublicConnections; // Determine how many players can connect to the game
-	LastSessionSettings->bAllowJoinInProgress = true; // Allow players to join when session is running
-    LastSessionSettings->bAllowJoinViaPresence = true; // Allow steam to search for sessions going on players' regions
-    LastSessionSettings->bShouldAdvertise = true; // Allow steam to advertise sessions
-	LastSessionSettings->bUsesPresence = true; // Allow players to find sessions going on their regions
-    //LastSessionSettings->bUseLobbiesIfAvailable = true; // Fix sessions finding issue
-    LastSessionSettings->Set( // Specify a match type so we can check that type once we've found the session
+    SessionSettings.bIsLANMatch = SubsystemName == "Null" ? true : false; // Using ternary operator by checking SubsystemName to decide whether to connect over the internet
+    SessionSettings.NumPublicConnections = Operation.NumPublicConnections; // Determine how many players can connect to the game
+	SessionSettings.bAllowJoinInProgress = true; // Allow players to join when session is running
+    SessionSettings.bIsDedicated = bIsDedicatedServer; // A dedicated server advertises with the identity of the server rather than of a player
+    SessionSettings.bAllowJoinViaPresence = !bIsDedicatedServer; // Allow steam to search for sessions going on players' regions
+    SessionSettings.bShouldAdvertise = true; // Allow steam to advertise sessions
+	SessionSettings.bUsesPresence = !bIsDedicatedServer && Operation.SessionName == NAME_GameSession; // Allow players to find sessions going on their regions, only one session can use presence and a server has none
+    //SessionSettings.bUseLobbiesIfAvailable = true; // Fix sessions finding issue
+    SessionSettings.Set( // Specify a match type so we can check that type once we've found the session
         FName("MatchType"), // FName key to define a match type
-        MatchType, // FString value to define the match type
+        Operation.MatchType, // FString value to define the match type
         EOnlineDataAdvertisementType::ViaOnlineServiceAndPing // Session will be advertised via the online service and ping
     );
-    LastSessionSettings->BuildUniqueId = 1; // Allow multiple users to launch their own build and host
-    // Get the world's first local player
-    const ULocalPlayer *LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-    bool IsCreationSuccessful = SessionInterface->CreateSession(
-        *LocalPlayer->GetPreferredUniqueNetId(),
-        NAME_GameSession,
-        *LastSessionSettings
+    SessionSettings.BuildUniqueId = 1; // Allow multiple users to launch their own build and host
+    // Changes made before the creation go out with it rather than with an update
+    ApplyDirtySettings(SessionState);
+    // Several match instances of one dedicated server process share its address, so each advertises the port it listens on
+    if (Operation.MatchPort > 0){
+        SessionSettings.Set(
+            FName("MatchPort"),
+            Operation.MatchPort,
+            EOnlineDataAdvertisementType::ViaOnlineServiceAndPing
+        );
+    }
+    // Advertise the probe responder so that clients can measure their latency to this host before joining
+    if (Reservations->IsResponderRunning()){
+        SessionSettings.Set(
+            FName("ProbePort"),
+            Reservations->GetResponderPort(),
+            EOnlineDataAdvertisementType::ViaOnlineServiceAndPing
+        );
+        // The same port takes slot reservations
+        SessionSettings.Set(
+            FName("Reservations"),
+            true,
+            EOnlineDataAdvertisementType::ViaOnlineServiceAndPing
+        );
+    }
+    BeginSessionOperation(SessionState, Operation, ESessionOperationState::Creating);
+    // Get the unique net id of the world's first local player, without one the session is hosted by the server itself (player number 0 is the server login)
+    const FUniqueNetIdPtr HostingPlayerId = GetLocalPlayerNetId();
+    bool IsCreationSuccessful = HostingPlayerId.IsValid() ? SessionInterface->CreateSession(
+        *HostingPlayerId,
+        Operation.SessionName,
+        SessionSettings
+    ) : SessionInterface->CreateSession(
+        0,
+        Operation.SessionName,
+        SessionSettings
     );
     // If session creation is failed
     if (!IsCreationSuccessful){
-        // Remove CreateSessionCompleteDelegate from the list
-        SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
-        // Broadcast custom multicast delegate
-        MultiplayerOnCreateSessionComplete.Broadcast(
-            false
-        );
+        if (CompleteRefusedOperation(SessionState, ESessionOperationState::Creating)){
+            // Broadcast custom multicast delegate
+            BroadcastSessionOperation(Operation.SessionName, ESessionOperationType::Create, false);
+        }
+        return false;
     }
+    return true;
 }
 
 
 void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuccessful){
-    if (SessionInterface){
-        // Remove CreateSessionCompleteDelegate from the list
-        SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
+    // Only the completion of our own session creation is of interest
+    FNamedSessionState *SessionState = FindWaitingSession(SessionName, ESessionOperationState::Creating);
+    if (SessionState == nullptr){
+        return;
+    }
+    CompleteSessionOperation(*SessionState, bWasSuccessful);
+    // Start taking reservations for the session
+    if (bWasSuccessful){
+        UpdateReservableSession(SessionName);
     }
     // Broadcast custom multicast delegate
-    MultiplayerOnCreateSessionComplete.Broadcast(
-        bWasSuccessful
-    );
+    BroadcastSessionOperation(SessionName, ESessionOperationType::Create, bWasSuccessful);
+    ProcessOperationQueue();
 }
 
 
-void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults){
+void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults, const FSessionSearchFilter &Filter){
     // Check if SessionInterface is not valid
     if (!SessionInterface.IsValid()) // The way to check if TSharedPtr is valid is by using the 'IsValid' function
 	{
 		return;
 	}
+    RequestSessionSearch(MakeSearchQuery(MaxSearchResults, Filter), 0);
+}
+
+
+void UMultiplayerSessionsSubsystem::FindSessionsPaged(int32 MaxSearchResults, int32 PageSize, const FSessionSearchFilter &Filter){
+    // Check if SessionInterface is not valid
+    if (!SessionInterface.IsValid()){ // The way to check if TSharedPtr is valid is by using the 'IsValid' function
+        return;
+    }
+    RequestSessionSearch(MakeSearchQuery(MaxSearchResults, Filter), FMath::Max(PageSize, 1));
+}
+
+
+void UMultiplayerSessionsSubsystem::RequestSessionSearch(const FSessionSearchQuery &Query, int32 PageSize){
+    /*
+    Coalesce with the running search
+    */
+    if (IsSearchInProgress() && !bIsQuickJoinActive && PendingSearchQuery == Query){
+        // If the same search is already running in the background, just let its results be broadcast
+        if (bIsBackgroundSearch){
+            bIsBackgroundSearch = false;
+            SearchPageSize = PageSize;
+            // Results that arrived before the promotion haven't been broadcast yet
+            SearchPageCursor = 0;
+            SearchPageIndex = 0;
+            StartSearchPolling();
+        }
+        // If the same search is already running in the foreground, its results will be broadcast anyway
+        else if (PageSize > 0 && SearchPageSize <= 0){
+            SearchPageSize = PageSize;
+            SearchPageCursor = 0;
+            SearchPageIndex = 0;
+            StartSearchPolling();
+        }
+        return;
+    }
+
+    /*
+    Answer from the search cache
+    */
+    // The cached results stay alive even if a subscriber invalidates the cache during the broadcast
+    TSharedPtr<const TArray<FOnlineSessionSearchResult>> CachedResults;
+    const ESessionSearchCacheFreshness Freshness = SearchCache.Find(Query, FPlatformTime::Seconds(), CachedResults);
+    if (Freshness != ESessionSearchCacheFreshness::Missing){
+        // Serve pages of the cached results as well
+        LastSearchResults = CachedResults;
+        // Stale results are returned as well, but get refreshed in the background
+        if (Freshness == ESessionSearchCacheFreshness::Stale){
+            EnqueueCacheRefresh(Query);
+        }
+        if (PageSize > 0){
+            // Page through the cached results, a background search doesn't broadcast pages
+            int32 CachedPageCursor = 0;
+            int32 CachedPageIndex = 0;
+            BroadcastSearchPages(*CachedResults, PageSize, CachedPageCursor, CachedPageIndex, true);
+        }
+        MultiplayerOnFindSessionsComplete.Broadcast(
+            FSessionSearchSnapshot(CachedResults.ToSharedRef()),
+            true
+        );
+        return;
+    }
 
     /*
     Find game sessions
     */
-    // Add FindSessionsCompleteDelegate to SessionInterface's delegate list and store it in a FDelegateHandle
-    FindSessionsCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate); // Once all sessions are found, then the fallback function which bound to this delegate will be called
-    // Initialize LastSessionSearch TSharedPtr to class FOnlineSessionSearch
-    LastSessionSearch = MakeShareable(new FOnlineSessionSearch);
+    FSessionOperation Operation;
+    Operation.Type = ESessionOperationType::Find;
+    Operation.Query = Query;
+    Operation.PageSize = PageSize;
+    EnqueueOperation(MoveTemp(Operation));
+}
+
+
+void UMultiplayerSessionsSubsystem::EnqueueCacheRefresh(const FSessionSearchQuery &Query){
+    if (IsSearchInProgress()){
+        return;
+    }
+    FSessionOperation Operation;
+    Operation.Type = ESessionOperationType::Find;
+    Operation.Query = Query;
+    Operation.bIsBackground = true; // The results only go into the cache
+    EnqueueOperation(MoveTemp(Operation));
+}
+
+
+FSessionSearchQuery UMultiplayerSessionsSubsystem::MakeSearchQuery(int32 MaxSearchResults, const FSessionSearchFilter &Filter) const{
+    FSessionSearchQuery Query;
+    Query.bIsLanQuery = SubsystemName == "Null" ? true : false; // Using ternary operator by checking SubsystemName to decide whether to connect over the internet
+    Query.bUsePresence = true; // Make sure any session we find is using presence
+    Query.Filter = Filter;
+    Query.MaxSearchResults = MaxSearchResults;
+    return Query;
+}
+
+
+bool UMultiplayerSessionsSubsystem::StartSessionSearch(const FSessionSearchQuery &Query, bool bIsBackground){
+    // Check if SessionInterface is not valid
+    if (!SessionInterface.IsValid()){
+        if (!bIsBackground){
+            MultiplayerOnFindSessionsComplete.Broadcast(
+                FSessionSearchSnapshot(), // Empty snapshot
+                false
+            );
+        }
+        return false;
+    }
+    // Take a search object from the pool, the previous one goes back into it
+    ObjectPool.ReleaseSearch(LastSessionSearch);
+    bool bWasSearchReused = false;
+    LastSessionSearch = ObjectPool.AcquireSearch(bWasSearchReused);
+    Stats.RecordSearchAcquire(bWasSearchReused);
 	// Configure search settings
-    LastSessionSearch->MaxSearchResults = MaxSearchResults;
-    LastSessionSearch->bIsLanQuery = IOnlineSubsystem::Get()->GetSubsystemName() == "Null" ? true : false; // Using ternary operator by checking SubsystemName to decide whether to connect over the internet
+    LastSessionSearch->MaxSearchResults = Query.MaxSearchResults;
+    LastSessionSearch->bIsLanQuery = Query.bIsLanQuery;
     LastSessionSearch->QuerySettings.Set( // Make sure any session we find is using presence
 		SEARCH_PRESENCE, // Macro
-		true,
+		Query.bUsePresence,
 		EOnlineComparisonOp::Equals
 	);
-    // Get the world's first local player
-    const ULocalPlayer *LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	bool IsSearchSuccessful = SessionInterface->FindSessions(
-		*LocalPlayer->GetPreferredUniqueNetId(),
+    // Let the backend skip sessions which don't satisfy the filter
+    Query.Filter.ApplyToQuerySettings(LastSessionSearch->QuerySettings);
+    // Whatever the backend doesn't skip gets filtered on the client
+    bBackendFiltersSettings = FSessionSearchFilter::DoesBackendFilterSettings(SubsystemName);
+    PendingSearchResults = MakeShared<TArray<FOnlineSessionSearchResult>>();
+    SearchFilterCursor = 0;
+    PendingSearchSessionIds.Reset();
+    // Remember what is running so that the results can be cached under the right key
+    PendingSearchQuery = Query;
+    bIsBackgroundSearch = bIsBackground;
+    // Background searches aren't paged
+    if (bIsBackground){
+        SearchPageSize = 0;
+    }
+    SearchPageCursor = 0;
+    SearchPageIndex = 0;
+    // Wait for the backend
+    bIsSearchInProgress = true;
+    StartSearchPolling();
+    // Get the unique net id of the world's first local player, a server searches as player number 0
+    const FUniqueNetIdPtr SearchingPlayerId = GetLocalPlayerNetId();
+    // Searches run one at a time, so their Insights region needs no name of its own
+    SearchBeginTime = Stats.BeginOperation(ESessionOperationType::Find);
+	bool IsSearchSuccessful = SearchingPlayerId.IsValid() ? SessionInterface->FindSessions(
+		*SearchingPlayerId,
+		LastSessionSearch.ToSharedRef()
+	) : SessionInterface->FindSessions(
+		0,
 		LastSessionSearch.ToSharedRef()
 	);
     // If sessions search is failed
     if (!IsSearchSuccessful){
-        // Remove FindSessionsCompleteDelegate from the list
-        SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+        // Nothing is left to do if the completion delegate has reported the failure already, like for the operations on sessions (see CompleteRefusedOperation)
+        if (!IsSearchInProgress()){
+            return false;
+        }
+        // Their results are being processed and will be broadcast once they come back
+        if (ActiveSearchProcessing.IsValid()){
+            return true;
+        }
+        bIsSearchInProgress = false;
+        Stats.EndOperation(ESessionOperationType::Find, SearchBeginTime, false);
+        StopSearchPolling();
+        PendingSearchResults.Reset();
+        // Background refreshes fail silently since the stale results were already broadcast
+        if (bIsBackground){
+            return false;
+        }
         // Broadcast custom multicast delegate
         MultiplayerOnFindSessionsComplete.Broadcast(
-            TArray<FOnlineSessionSearchResult>(), // Empty array
+            FSessionSearchSnapshot(), // Empty snapshot
             false
         );
+        return false;
     }
+    return true;
 }
 
 
 void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful){
-    if (SessionInterface){
-        // Remove FindSessionsCompleteDelegate from the list
-        SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+    // Only the completion of our own session search is of interest
+    if (!IsSearchInProgress()){
+        return;
     }
-    // Broadcast custom multicast delegate
-    if (LastSessionSearch->SearchResults.Num() <= 0){
-        MultiplayerOnFindSessionsComplete.Broadcast(
-            TArray<FOnlineSessionSearchResult>(), // Empty array
-            false
-        );
+    // Some backends report completion more than once
+    if (ActiveSearchProcessing.IsValid()){
+        return;
     }
-    else{
-        MultiplayerOnFindSessionsComplete.Broadcast(
-            LastSessionSearch->SearchResults,
-            bWasSuccessful
-        );
+    StopSearchPolling();
+    ProcessSessionSearch(bWasSuccessful);
+}
+
+
+void UMultiplayerSessionsSubsystem::ProcessSessionSearch(bool bWasSuccessful){
+    /*
+    Hand the results to a worker thread, the search stays in progress until they come back so that no other search can overtake it
+    */
+    TSharedRef<FSessionSearchProcessing, ESPMode::ThreadSafe> Processing = MakeShared<FSessionSearchProcessing, ESPMode::ThreadSafe>();
+    // The backend is done with the search, so its results can be moved rather than copied
+    if (LastSessionSearch.IsValid()){
+        Processing->SearchResults = MoveTemp(LastSessionSearch->SearchResults);
+    }
+    if (PendingSearchResults.IsValid()){
+        Processing->Results = MoveTemp(*PendingSearchResults);
+        Processing->SeenSessionIds = MoveTemp(PendingSearchSessionIds);
+    }
+    Processing->FirstUnfilteredResult = SearchFilterCursor;
+    Processing->Filter = PendingSearchQuery.Filter;
+    Processing->bBackendFiltersSettings = bBackendFiltersSettings;
+    Processing->RankingWeights = RankingWeights;
+    Processing->RankingPreferences = RankingPreferences;
+    Processing->RankingRevision = RankingRevision;
+    Processing->bWasSuccessful = bWasSuccessful;
+    if (bWasSuccessful && KnownHostLookup->GetHosts().Num() > 0){
+        KnownHostLookup->GetHosts().GetSessionIds(Processing->KnownHostIds);
     }
+    ActiveSearchProcessing = Processing;
+    TWeakObjectPtr<UMultiplayerSessionsSubsystem> WeakThis(this);
+    Async(EAsyncExecution::ThreadPool, [WeakThis, Processing](){
+        ProcessSearchResults(*Processing);
+        if (Processing->bIsCancelled){
+            return;
+        }
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, Processing](){
+            // Only the search that is still active may finish, a superseded one has already been cleaned up
+            if (!WeakThis.IsValid() || WeakThis->ActiveSearchProcessing.Get() != &Processing.Get() || Processing->bIsCancelled){
+                return;
+            }
+            WeakThis->ActiveSearchProcessing.Reset();
+            WeakThis->bIsSearchInProgress = false;
+            WeakThis->FinishSessionSearch(*Processing);
+            WeakThis->ProcessOperationQueue();
+        });
+    });
 }
 
 
-void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult &SessionResult){
-    // Check if SessionInterface is not valid
-    if (!SessionInterface.IsValid()){ // The way to check if TSharedPtr is valid is by using the 'IsValid' function
-        // Broadcast custom multicast delegate
-        MultiplayerOnJoinSessionsComplete.Broadcast(
-            EOnJoinSessionCompleteResult::UnknownError
-        );
+void UMultiplayerSessionsSubsystem::ProcessSearchResults(FSessionSearchProcessing &Processing){
+    SCOPE_CYCLE_COUNTER(STAT_SessionProcessSearchResults);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("MultiplayerSessions::ProcessSearchResults", MultiplayerSessionsChannel);
+    // Number of results between two checks whether the search has been cancelled
+    constexpr int32 CancelCheckInterval = 256;
+
+    /*
+    Filter and deduplicate the results which arrived since the last poll
+    */
+    // The results collected while polling have been deduplicated already
+    for (int32 Index = 0; Index < Processing.Results.Num(); ++Index){
+        if (Processing.KnownHostIds.Contains(Processing.Results[Index].GetSessionIdStr())){
+            Processing.SeenKnownHosts.Add(Index);
+        }
+    }
+    // Record what the backend delivered before the results get moved out
+    TArray<FOnlineSessionSearchResult> &SearchResults = Processing.SearchResults;
+    for (const FOnlineSessionSearchResult &SearchResult : SearchResults){
+        Processing.PayloadBytes += FSessionStatsCollector::EstimatePayloadBytes(SearchResult);
+    }
+    for (int32 Index = Processing.FirstUnfilteredResult; Index < SearchResults.Num(); ++Index){
+        if ((Index & (CancelCheckInterval - 1)) == 0 && Processing.bIsCancelled){
+            return;
+        }
+        FOnlineSessionSearchResult &SearchResult = SearchResults[Index];
+        if (!Processing.Filter.Matches(SearchResult, Processing.bBackendFiltersSettings)){
+            continue;
+        }
+        const FString SessionId = SearchResult.GetSessionIdStr();
+        if (MarkSessionSeen(Processing.SeenSessionIds, SessionId)){
+            if (Processing.KnownHostIds.Contains(SessionId)){
+                Processing.SeenKnownHosts.Add(Processing.Results.Num());
+            }
+            Processing.Results.Add(MoveTemp(SearchResult));
+        }
+    }
+    // Free what is left of the raw results here rather than on the game thread, their storage keeps its capacity for the next search
+    SearchResults.Reset();
+    if (Processing.bIsCancelled){
         return;
     }
 
     /*
-    Join the game session
+    Rank every result up front, so that joining the best of them doesn't have to score them on the game thread
     */
-	// Add JoinSessionCompleteDelegate to SessionInterface's delegate list
-    JoinSessionCompleteDelegateHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate); // Once the session is joined, then the fallback function which bound to this delegate will be called
-    // Get the world's first local player
-    const ULocalPlayer *LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	bool IsJointSuccessful = SessionInterface->JoinSession(
-		*LocalPlayer->GetPreferredUniqueNetId(),
-		NAME_GameSession,
-		SessionResult
-	);
-    // If sessions joint is failed
-    if (!IsJointSuccessful){
-        // Remove JoinSessionCompleteDelegate from the list
-        SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
-        // Broadcast custom multicast delegate
-        MultiplayerOnJoinSessionsComplete.Broadcast(
-            EOnJoinSessionCompleteResult::UnknownError
-        );
+    FSessionRankingTable RankingTable;
+    RankingTable.Build(Processing.Results);
+    RankingTable.Score(Processing.RankingWeights, Processing.RankingPreferences);
+    RankingTable.GetTopK(Processing.Results.Num(), Processing.RankedOrder);
+}
+
+
+bool UMultiplayerSessionsSubsystem::MarkSessionSeen(TSet<FString> &SeenSessionIds, const FString &SessionId){
+    // Results without a session id can't be told apart, so they are all kept
+    if (SessionId.IsEmpty()){
+        return true;
     }
+    bool bIsAlreadySeen = false;
+    SeenSessionIds.Add(SessionId, &bIsAlreadySeen);
+    return !bIsAlreadySeen;
 }
 
 
-void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result){
-    if (SessionInterface){
-        // Remove JoinSessionCompleteDelegate from the list
-        SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
+void UMultiplayerSessionsSubsystem::CancelSearchProcessing(){
+    if (ActiveSearchProcessing.IsValid()){
+        ActiveSearchProcessing->bIsCancelled = true;
+        ActiveSearchProcessing.Reset();
     }
-    // Broadcast custom multicast delegate
-    MultiplayerOnJoinSessionsComplete.Broadcast(
-        Result
-    );
 }
 
 
-void UMultiplayerSessionsSubsystem::DestroySession(){
-    // Check if SessionInterface is not valid
-    if (!SessionInterface.IsValid()){ // The way to check if TSharedPtr is valid is by using the 'IsValid' function
-        // Broadcast custom multicast delegate
-        MultiplayerOnDestroySessionComplete.Broadcast(
-            false
-        );
+void UMultiplayerSessionsSubsystem::FinishSessionSearch(FSessionSearchProcessing &Processing){
+    const bool bWasSuccessful = Processing.bWasSuccessful;
+    TSharedRef<const TArray<FOnlineSessionSearchResult>> Results = MakeShared<TArray<FOnlineSessionSearchResult>>(MoveTemp(Processing.Results));
+    PendingSearchResults.Reset();
+    Stats.EndOperation(ESessionOperationType::Find, SearchBeginTime, bWasSuccessful, Results->Num(), Processing.PayloadBytes);
+    LastSearchResults = Results;
+    // Keep the ranking computed along with the results
+    RankedSearchResults = Results;
+    RankedSearchOrder = MoveTemp(Processing.RankedOrder);
+    RankedSearchRevision = Processing.RankingRevision;
+    // Hand the storage of the raw results back to the search object, which keeps it for the next search once it's back in the pool
+    if (LastSessionSearch.IsValid() && LastSessionSearch->SearchResults.Num() == 0){
+        LastSessionSearch->SearchResults = MoveTemp(Processing.SearchResults);
+    }
+    Stats.RecordRetainedResultStorage(ObjectPool.GetRetainedResultBytes() + (LastSessionSearch.IsValid() ? LastSessionSearch->SearchResults.GetAllocatedSize() : 0));
+    // Known hosts that the search reports are still alive
+    for (int32 ResultIndex : Processing.SeenKnownHosts){
+        const FOnlineSessionSearchResult &SearchResult = (*Results)[ResultIndex];
+        KnownHostLookup->RecordSeen(SearchResult);
+    }
+    // Pace the prefetching by what it finds
+    if (bIsPrefetchEnabled && PendingSearchQuery == PrefetchQuery){
+        OnPrefetchSearchComplete(Results->Num(), bWasSuccessful);
+    }
+    // Store the results in the search cache
+    if (bWasSuccessful){
+        SearchCache.Add(PendingSearchQuery, Results, FPlatformTime::Seconds());
+        // Keep the index of the matchmaker up to date with what the backend reports
+        if (Matchmaker.IsValid()){
+            for (const FOnlineSessionSearchResult &SearchResult : *Results){
+                Matchmaker->AddOrUpdateSession(SearchResult);
+            }
+        }
+    }
+    // A quick join that didn't see a qualifying result while polling takes the first one now
+    if (bIsQuickJoinActive){
+        bIsQuickJoinActive = false;
+        if (Results->Num() > 0){
+            JoinBestSearchResult(*Results);
+        }
+        else{
+            MultiplayerOnJoinSessionsComplete.Broadcast(
+                EOnJoinSessionCompleteResult::SessionDoesNotExist
+            );
+        }
         return;
     }
-
-    /*
-    Destroy the game session
-    */
-    // Add DestroySessionCompleteDelegate to SessionInterface's delegate list
-    DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate); // Once the session is joined, then the fallback function which bound to this delegate will be called
-    // Get the world's first local player
-    const ULocalPlayer *LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-    bool IsDestructionSuccessful = SessionInterface->DestroySession(
-        NAME_GameSession
+    // Nobody is waiting for the results of a background refresh
+    if (bIsBackgroundSearch){
+        return;
+    }
+    // Broadcast whatever hasn't been paged yet
+    if (SearchPageSize > 0){
+        BroadcastSearchPages(*Results, SearchPageSize, SearchPageCursor, SearchPageIndex, true);
+    }
+    // Broadcast custom multicast delegate, a search that found nothing still succeeded, like the same search answered from the cache
+    MultiplayerOnFindSessionsComplete.Broadcast(
+        FSessionSearchSnapshot(Results),
+        bWasSuccessful
     );
-    // If sessions destruction is failed
-    if (!IsDestructionSuccessful){
-        // Remove DestroySessionCompleteDelegate from the list
-        SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
-        // Broadcast custom multicast delegate
-        MultiplayerOnDestroySessionComplete.Broadcast(
-            false
+}
+
+
+void UMultiplayerSessionsSubsystem::BroadcastSearchPages(const TArray<FOnlineSessionSearchResult> &Results, int32 PageSize, int32 &PageCursor, int32 &PageIndex, bool bIsSearchFinished){
+    // Broadcast every full page
+    while (Results.Num() - PageCursor >= PageSize){
+        const bool bIsLastPage = bIsSearchFinished && Results.Num() - PageCursor == PageSize;
+        MultiplayerOnFindSessionsPage.Broadcast(
+            TArrayView<const FOnlineSessionSearchResult>(Results.GetData() + PageCursor, PageSize),
+            PageIndex++,
+            bIsLastPage
+        );
+        PageCursor += PageSize;
+        if (bIsLastPage){
+            return;
+        }
+    }
+    // Broadcast the remaining results (possibly none) as the last page
+    if (bIsSearchFinished){
+        MultiplayerOnFindSessionsPage.Broadcast(
+            TArrayView<const FOnlineSessionSearchResult>(Results.GetData() + PageCursor, Results.Num() - PageCursor),
+            PageIndex++,
+            true
         );
+        PageCursor = Results.Num();
     }
 }
 
 
-void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessful){
-    if (SessionInterface){
-        // Remove DestroySessionCompleteDelegate from the list
-        SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
+void UMultiplayerSessionsSubsystem::CollectSearchResults(){
+    SCOPE_CYCLE_COUNTER(STAT_SessionCollectSearchResults);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("MultiplayerSessions::CollectSearchResults", MultiplayerSessionsChannel);
+    if (!LastSessionSearch.IsValid() || !PendingSearchResults.IsValid()){
+        return;
     }
-    // If new session creation is needed
-    if (bWasSuccessful && bCreateSessionOnDestroy){
-        bCreateSessionOnDestroy = false;
-        CreateSession(LastNumPublicConnections, LastMatchType);
+    const TArray<FOnlineSessionSearchResult> &SearchResults = LastSessionSearch->SearchResults;
+    for (; SearchFilterCursor < SearchResults.Num(); ++SearchFilterCursor){
+        const FOnlineSessionSearchResult &SearchResult = SearchResults[SearchFilterCursor];
+        if (PendingSearchQuery.Filter.Matches(SearchResult, bBackendFiltersSettings) && MarkSessionSeen(PendingSearchSessionIds, SearchResult.GetSessionIdStr())){
+            PendingSearchResults->Add(SearchResult);
+        }
     }
-    // Broadcast custom multicast delegate
-    MultiplayerOnDestroySessionComplete.Broadcast(
-        bWasSuccessful
-    );
 }
 
 
-void UMultiplayerSessionsSubsystem::StartSession(){
+void UMultiplayerSessionsSubsystem::AbortSessionSearch(){
+    if (!IsSearchInProgress()){
+        return;
+    }
+    bIsSearchInProgress = false;
+    Stats.CancelOperation(ESessionOperationType::Find, SearchBeginTime);
+    StopSearchPolling();
+    // A search whose results are being processed has already completed on the backend
+    if (ActiveSearchProcessing.IsValid()){
+        CancelSearchProcessing();
+    }
+    else if (SessionInterface){
+        // A cancelled search doesn't complete
+        SessionInterface->CancelFindSessions();
+    }
+    // Partial results aren't cached
+    PendingSearchResults.Reset();
+}
+
+
+bool UMultiplayerSessionsSubsystem::UpdateQuickJoin(){
+    // Join the best of the qualifying sessions that have arrived so far right away
+    if (PendingSearchResults.IsValid() && PendingSearchResults->Num() > 0){
+        // Hold the collected results since aborting the search releases them
+        TSharedPtr<TArray<FOnlineSessionSearchResult>> CollectedResults = PendingSearchResults;
+        bIsQuickJoinActive = false;
+        AbortSessionSearch();
+        JoinBestSearchResult(*CollectedResults);
+        return true;
+    }
+    // Give up once the deadline has passed
+    if (FPlatformTime::Seconds() >= QuickJoinDeadline){
+        bIsQuickJoinActive = false;
+        AbortSessionSearch();
+        MultiplayerOnJoinSessionsComplete.Broadcast(
+            EOnJoinSessionCompleteResult::SessionDoesNotExist
+        );
+        ProcessOperationQueue();
+        return true;
+    }
+    return false;
+}
+
 
+bool UMultiplayerSessionsSubsystem::PollSessionSearch(float DeltaTime){
+    // Keep ticking until the completion callback stops the polling
+    if (!IsSearchInProgress() || !PendingSearchResults.IsValid()){
+        return true;
+    }
+    CollectSearchResults();
+    if (bIsQuickJoinActive){
+        UpdateQuickJoin();
+        return true;
+    }
+    if (!bIsBackgroundSearch && SearchPageSize > 0){
+        BroadcastSearchPages(*PendingSearchResults, SearchPageSize, SearchPageCursor, SearchPageIndex, false);
+    }
+    return true;
 }
 
-void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful){
-}
\ No newline at end of file
+
+void UMultiplayerSessionsSubsystem::StartSearchPolling(){
+    // Poll the search for results that arrive before it completes, some backends add them one by one while searching
+    if ((SearchPageSize > 0 || bIsQuickJoinActive) && !SearchPollTickerHandle.IsValid()){
+        SearchPollTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+            FTickerDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::PollSessionSearch),
+            SearchPollInterval
+        );
+    }
+}
+
+
+void UMultiplayerSessionsSubsystem::StopSearchPolling(){
+    if (SearchPollTickerHandle.IsValid()){
+        FTSTicker::GetCoreTicker().RemoveTicker(SearchPollTickerHandle);
+        SearchPollTickerHandle.Reset();
+    }
+}
+
+
+int32 UMultiplayerSessionsSubsystem::GetSearchResultsPage(int32 Cursor, int32 PageSize, TArray<FOnlineSessionSearchResult> &OutPageResults) const{
+    OutPageResults.Reset();
+    if (!LastSearchResults.IsValid() || Cursor < 0 || PageSize <= 0){
+        return INDEX_NONE;
+    }
+    const TArray<FOnlineSessionSearchResult> &Results = *LastSearchResults;
+    const int32 NumPageResults = FMath::Clamp(Results.Num() - Cursor, 0, PageSize);
+    OutPageResults.Append(Results.GetData() + Cursor, NumPageResults);
+    // Return the cursor of the next page if there are more results
+    const int32 NextCursor = Cursor + NumPageResults;
+    return NextCursor < Results.Num() ? NextCursor : INDEX_NONE;
+}
+
+
+FSessionSearchSnapshot UMultiplayerSessionsSubsystem::GetLastSearchResults() const{
+    return LastSearchResults.IsValid() ? FSessionSearchSnapshot(LastSearchResults.ToSharedRef()) : FSessionSearchSnapshot();
+}
+
+
+void UMultiplayerSessionsSubsystem::RankSearchResults(TArrayView<const FOnlineSessionSearchResult> Results, int32 TopK, TArray<int32> &OutResultIndices){
+    SCOPE_CYCLE_COUNTER(STAT_SessionRankSearchResults);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("MultiplayerSessions::RankSearchResults", MultiplayerSessionsChannel);
+    // Results of the last search come ranked from the worker thread, as long as the weights and preferences haven't changed since
+    if (RankedSearchResults.IsValid() && RankedSearchResults->GetData() == Results.GetData() && RankedSearchResults->Num() == Results.Num() && RankedSearchRevision == RankingRevision){
+        const int32 NumRanked = FMath::Clamp(TopK, 0, RankedSearchOrder.Num());
+        OutResultIndices.Reset(NumRanked);
+        OutResultIndices.Append(RankedSearchOrder.GetData(), NumRanked);
+        return;
+    }
+    RankingTable.Build(Results);
+    RankingTable.Score(RankingWeights, RankingPreferences);
+    RankingTable.GetTopK(TopK, OutResultIndices);
+}
+
+
+const FOnlineSessionSearchResult *UMultiplayerSessionsSubsystem::GetBestSearchResult(TArrayView<const FOnlineSessionSearchResult> Results){
+    // No need to rank a single result
+    if (Results.Num() <= 1){
+        return Results.Num() == 1 ? &Results[0] : nullptr;
+    }
+    TArray<int32> BestIndex;
+    RankSearchResults(Results, 1, BestIndex);
+    return BestIndex.Num() > 0 ? &Results[BestIndex[0]] : nullptr;
+}
+
+
+void UMultiplayerSessionsSubsystem::JoinBestSearchResult(TArrayView<const FOnlineSessionSearchResult> Results){
+    if (Results.Num() == 0){
+        MultiplayerOnJoinSessionsComplete.Broadcast(
+            EOnJoinSessionCompleteResult::SessionDoesNotExist
+        );
+        return;
+    }
+    // Without probing (or anything to choose from) the ranking alone decides
+    if (!bProbeBeforeJoin || Results.Num() == 1 || !SessionInterface.IsValid()){
+        TArray<int32> CandidateIndices;
+        RankSearchResults(Results, MaxJoinAttempts, CandidateIndices);
+        TArray<FOnlineSessionSearchResult> Candidates;
+        Candidates.Reserve(CandidateIndices.Num());
+        for (int32 CandidateIndex : CandidateIndices){
+            Candidates.Add(Results[CandidateIndex]);
+        }
+        JoinWithFailover(MoveTemp(Candidates));
+        return;
+    }
+
+    /*
+    Probe the best ranked candidates
+    */
+    TArray<int32> CandidateIndices;
+    RankSearchResults(Results, NumProbeCandidates, CandidateIndices);
+    TArray<FOnlineSessionSearchResult> Candidates;
+    TArray<FSessionProbeTarget> Targets;
+    for (int32 CandidateIndex : CandidateIndices){
+        const FOnlineSessionSearchResult &Candidate = Results[CandidateIndex];
+        Candidates.Add(Candidate);
+        // Hosts which don't advertise a probe port or whose address isn't an IP address can't be probed
+        FSessionProbeTarget &Target = Targets.AddDefaulted_GetRef();
+        int32 ProbePort = 0;
+        FString ConnectString;
+        if (Candidate.Session.SessionSettings.Get(FName("ProbePort"), ProbePort) && SessionInterface->GetResolvedConnectString(Candidate, NAME_GamePort, ConnectString)){
+            Target.Address = FSessionLatencyProber::MakeProbeAddress(ConnectString, ProbePort);
+        }
+    }
+    // Only the latest probing stage may join
+    const int32 StageSerial = ++ProbeStageSerial;
+    TWeakObjectPtr<UMultiplayerSessionsSubsystem> WeakThis(this);
+    FSessionLatencyProber::ProbeTargets(
+        Targets,
+        NumProbesPerCandidate,
+        ProbeTimeout,
+        [WeakThis, StageSerial, Candidates = MoveTemp(Candidates)](const TArray<FSessionProbeResult> &ProbeResults){
+            if (WeakThis.IsValid() && WeakThis->ProbeStageSerial == StageSerial){
+                WeakThis->JoinProbedCandidates(Candidates, ProbeResults);
+            }
+        }
+    );
+}
+
+
+void UMultiplayerSessionsSubsystem::JoinProbedCandidates(const TArray<FOnlineSessionSearchResult> &Candidates, const TArray<FSessionProbeResult> &ProbeResults){
+    // Order the candidates by their effective latency, ties keep the ranking order
+    TArray<TPair<float, int32>> CandidateLatencies;
+    for (int32 Index = 0; Index < Candidates.Num(); ++Index){
+        const FSessionProbeResult &ProbeResult = ProbeResults[Index];
+        float Latency;
+        if (ProbeResult.bWasReachable){
+            // Lost probes count as if they had taken the whole timeout
+            Latency = ProbeResult.RoundTripMs + ProbeJitterWeight * ProbeResult.JitterMs + ProbeResult.LossRatio * ProbeTimeout * 1000.f;
+        }
+        else if (!Candidates[Index].Session.SessionSettings.Settings.Contains(FName("ProbePort"))){
+            // Unprobeable hosts fall back to the ping reported by the backend
+            const int32 PingInMs = Candidates[Index].PingInMs;
+            Latency = PingInMs > 0 && PingInMs < MAX_QUERY_PING ? PingInMs : RankingWeights.UnknownPing;
+        }
+        else{
+            // Probeable hosts that didn't answer at all rank last
+            Latency = TNumericLimits<float>::Max() * 0.5f;
+        }
+        CandidateLatencies.Emplace(Latency, Index);
+    }
+    CandidateLatencies.StableSort([](const TPair<float, int32> &A, const TPair<float, int32> &B){
+        return A.Key < B.Key;
+    });
+    // The fastest candidates are the ones to fail over to
+    TArray<FOnlineSessionSearchResult> OrderedCandidates;
+    for (int32 Rank = 0; Rank < CandidateLatencies.Num() && Rank < MaxJoinAttempts; ++Rank){
+        OrderedCandidates.Add(Candidates[CandidateLatencies[Rank].Value]);
+    }
+    JoinWithFailover(MoveTemp(OrderedCandidates));
+}
+
+
+void UMultiplayerSessionsSubsystem::JoinWithFailover(TArray<FOnlineSessionSearchResult> Candidates){
+    if (Candidates.Num() == 0){
+        MultiplayerOnJoinSessionsComplete.Broadcast(
+            EOnJoinSessionCompleteResult::SessionDoesNotExist
+        );
+        return;
+    }
+    JoinCandidates = MoveTemp(Candidates);
+    JoinCandidateCursor = 0;
+    JoinFailoverDeadline = FPlatformTime::Seconds() + JoinFailoverTimeout;
+    EnqueueJoinSession(JoinCandidates[0], true);
+}
+
+
+bool UMultiplayerSessionsSubsystem::JoinNextCandidate(){
+    ++JoinCandidateCursor;
+    if (JoinCandidateCursor >= JoinCandidates.Num() || JoinCandidateCursor >= MaxJoinAttempts || FPlatformTime::Seconds() >= JoinFailoverDeadline){
+        JoinCandidates.Reset();
+        return false;
+    }
+    EnqueueJoinSession(JoinCandidates[JoinCandidateCursor], true);
+    return true;
+}
+
+
+void UMultiplayerSessionsSubsystem::FailOverOrBroadcastJoin(FName SessionName, bool bIsFailoverJoin, bool bCanFailOver, EOnJoinSessionCompleteResult::Type Result){
+    // The next best candidate is joined without another search round trip
+    if (bIsFailoverJoin && bCanFailOver && JoinNextCandidate()){
+        ProcessOperationQueue();
+        return;
+    }
+    if (bIsFailoverJoin){
+        JoinCandidates.Reset();
+    }
+    // Broadcast custom multicast delegate
+    BroadcastJoinSession(SessionName, Result);
+    ProcessOperationQueue();
+}
+
+
+void UMultiplayerSessionsSubsystem::SetJoinFailover(int32 MaxAttempts, float TimeoutSeconds){
+    MaxJoinAttempts = FMath::Max(MaxAttempts, 1);
+    JoinFailoverTimeout = FMath::Max(TimeoutSeconds, 0.f);
+}
+
+
+bool UMultiplayerSessionsSubsystem::StartProbeResponder(int32 Port){
+    return Reservations->StartResponder(Port);
+}
+
+
+void UMultiplayerSessionsSubsystem::StopProbeResponder(){
+    Reservations->StopResponder();
+}
+
+
+void UMultiplayerSessionsSubsystem::SetLatencyProbing(bool bEnabled, int32 NumCandidates, int32 NumProbes, float TimeoutSeconds){
+    bProbeBeforeJoin = bEnabled;
+    NumProbeCandidates = FMath::Max(NumCandidates, 1);
+    NumProbesPerCandidate = FMath::Max(NumProbes, 1);
+    ProbeTimeout = FMath::Max(TimeoutSeconds, 0.f);
+}
+
+
+void UMultiplayerSessionsSubsystem::SetSlotReservation(bool bEnabled, int32 NumAttempts, float TimeoutSeconds){
+    Reservations->Configure(bEnabled, NumAttempts, TimeoutSeconds);
+}
+
+
+void UMultiplayerSessionsSubsystem::SetReservationHoldTime(float Seconds){
+    Reservations->SetHoldSeconds(Seconds);
+}
+
+
+void UMultiplayerSessionsSubsystem::SetReservationLimitPerAddress(int32 MaxReservations){
+    Reservations->SetMaxReservationsPerAddress(MaxReservations);
+}
+
+
+int32 UMultiplayerSessionsSubsystem::GetOpenReservableSlots(FName SessionName){
+    return Reservations->GetOpenSlots(SessionName);
+}
+
+
+void UMultiplayerSessionsSubsystem::UpdateReservableSession(FName SessionName){
+    if (Reservations->IsResponderRunning() && SessionInterface.IsValid()){
+        Reservations->UpdateHostedSession(SessionName, SessionInterface->GetNamedSession(SessionName));
+    }
+}
+
+
+void UMultiplayerSessionsSubsystem::PreloadPackage(const FString &PackagePath){
+    // Strip the travel options
+    FString PackageNameString = PackagePath;
+    int32 OptionsIndex;
+    if (PackageNameString.FindChar(TEXT('?'), OptionsIndex)){
+        PackageNameString.LeftInline(OptionsIndex);
+    }
+    if (!FPackageName::IsValidLongPackageName(PackageNameString)){
+        return;
+    }
+    // Play-in-editor travels to a duplicate of the map, so the preloaded package wouldn't be used
+    UWorld *World = GetWorld();
+    if (World && World->IsPlayInEditor()){
+        return;
+    }
+    // Already loading or loaded
+    const FName PackageName(*PackageNameString);
+    if (PreloadingPackageName == PackageName){
+        return;
+    }
+    ReleasePreloadedPackage();
+    PreloadingPackageName = PackageName;
+
+    /*
+    Load the package in the background
+    */
+    TWeakObjectPtr<UMultiplayerSessionsSubsystem> WeakThis(this);
+    LoadPackageAsync(
+        PackageNameString,
+        FLoadPackageAsyncDelegate::CreateLambda([WeakThis, PackageName](const FName &LoadedPackageName, UPackage *LoadedPackage, EAsyncLoadingResult::Type Result){
+            // Only hold on to the package if it's still wanted
+            if (WeakThis.IsValid() && WeakThis->PreloadingPackageName == PackageName && Result == EAsyncLoadingResult::Succeeded){
+                WeakThis->PreloadedPackage = LoadedPackage;
+            }
+        })
+    );
+}
+
+
+void UMultiplayerSessionsSubsystem::ReleasePreloadedPackage(){
+    PreloadedPackage = nullptr;
+    PreloadingPackageName = NAME_None;
+}
+
+
+void UMultiplayerSessionsSubsystem::OnPostLoadMap(UWorld *LoadedWorld){
+    // The travel has picked up the package that was already in memory, from now on the world holds it
+    if (PreloadingPackageName != NAME_None){
+        ReleasePreloadedPackage();
+    }
+}
+
+
+void UMultiplayerSessionsSubsystem::StartSearchPrefetch(int32 MaxSearchResults, const FSessionSearchFilter &Filter, float IntervalSeconds, float MaxIntervalSeconds){
+    if (!SessionInterface.IsValid()){
+        return;
+    }
+    bIsPrefetchEnabled = true;
+    PrefetchQuery = MakeSearchQuery(MaxSearchResults, Filter);
+    // Bound the rate of the background searches
+    PrefetchInterval = FMath::Max(IntervalSeconds, 1.f);
+    PrefetchMaxInterval = FMath::Max(MaxIntervalSeconds, PrefetchInterval);
+    CurrentPrefetchInterval = PrefetchInterval;
+    // The first search is due right away
+    NextPrefetchTime = 0.0;
+    if (!PrefetchTickerHandle.IsValid()){
+        PrefetchTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+            FTickerDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::TickSearchPrefetch),
+            PrefetchTickInterval
+        );
+    }
+    TickSearchPrefetch(0.f);
+}
+
+
+void UMultiplayerSessionsSubsystem::StopSearchPrefetch(){
+    bIsPrefetchEnabled = false;
+    if (PrefetchTickerHandle.IsValid()){
+        FTSTicker::GetCoreTicker().RemoveTicker(PrefetchTickerHandle);
+        PrefetchTickerHandle.Reset();
+    }
+}
+
+
+bool UMultiplayerSessionsSubsystem::TickSearchPrefetch(float DeltaTime){
+    if (!bIsPrefetchEnabled || !SessionInterface.IsValid()){
+        return true;
+    }
+    const double Now = FPlatformTime::Seconds();
+    if (Now < NextPrefetchTime){
+        return true;
+    }
+    // Pause while a session exists, there is nothing to join then
+    if (SessionInterface->GetNamedSession(NAME_GameSession) != nullptr){
+        return true;
+    }
+    // Never compete with the operations of the player
+    if (IsSearchInProgress() || GetOperationState(NAME_GameSession) != ESessionOperationState::Idle || PendingOperations.Num() > 0){
+        return true;
+    }
+    // Until the search completes, it isn't due again
+    NextPrefetchTime = Now + CurrentPrefetchInterval;
+    // Results that are still fresh don't need a refresh yet
+    TSharedPtr<const TArray<FOnlineSessionSearchResult>> CachedResults;
+    if (SearchCache.Find(PrefetchQuery, Now, CachedResults) == ESessionSearchCacheFreshness::Fresh){
+        return true;
+    }
+    FSessionOperation Operation;
+    Operation.Type = ESessionOperationType::Find;
+    Operation.Query = PrefetchQuery;
+    Operation.bIsBackground = true; // The results only go into the cache
+    EnqueueOperation(MoveTemp(Operation));
+    return true;
+}
+
+
+void UMultiplayerSessionsSubsystem::OnPrefetchSearchComplete(int32 NumResults, bool bWasSuccessful){
+    // Back off while the searches keep coming back empty, and return to the normal pace once something shows up
+    if (!bWasSuccessful || NumResults == 0){
+        CurrentPrefetchInterval = FMath::Min(CurrentPrefetchInterval * 2.f, PrefetchMaxInterval);
+    }
+    else{
+        CurrentPrefetchInterval = PrefetchInterval;
+    }
+    NextPrefetchTime = FPlatformTime::Seconds() + CurrentPrefetchInterval;
+}
+
+
+void UMultiplayerSessionsSubsystem::SetMatchmaker(TSharedPtr<FSessionMatchmaker> NewMatchmaker){
+    CancelMatchmaking();
+    Matchmaker = NewMatchmaker;
+    // Start off with the results that are known already
+    if (Matchmaker.IsValid() && LastSearchResults.IsValid()){
+        for (const FOnlineSessionSearchResult &SearchResult : *LastSearchResults){
+            Matchmaker->AddOrUpdateSession(SearchResult);
+        }
+    }
+}
+
+
+void UMultiplayerSessionsSubsystem::JoinViaMatchmaker(const FMatchmakingTicket &Ticket, int32 MaxSearchResults, float TimeoutSeconds){
+    if (!SessionInterface.IsValid() || !Matchmaker.IsValid()){
+        MultiplayerOnJoinSessionsComplete.Broadcast(
+            EOnJoinSessionCompleteResult::UnknownError
+        );
+        return;
+    }
+    CancelMatchmaking();
+    const double Now = FPlatformTime::Seconds();
+    MatchmakingTicketId = Matchmaker->EnqueuePlayer(Ticket, Now);
+    MatchmakingDeadline = Now + FMath::Max(TimeoutSeconds, 0.f);
+    // Keep the index fed with the sessions of the player's match type, more often than a menu would since new sessions are what the player waits for
+    if (!bIsPrefetchEnabled){
+        FSessionSearchFilter Filter;
+        Filter.MatchType = Ticket.MatchType;
+        Filter.MinOpenSlots = 1;
+        StartSearchPrefetch(MaxSearchResults, Filter, 5.f, 20.f);
+        bIsPrefetchingForMatchmaking = true;
+    }
+    if (!MatchmakingTickerHandle.IsValid()){
+        MatchmakingTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+            FTickerDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::TickMatchmaking),
+            MatchmakingTickInterval
+        );
+    }
+    // A session in reach is joined right away
+    TickMatchmaking(0.f);
+}
+
+
+void UMultiplayerSessionsSubsystem::CancelMatchmaking(){
+    if (Matchmaker.IsValid() && MatchmakingTicketId != 0){
+        Matchmaker->CancelPlayer(MatchmakingTicketId);
+    }
+    MatchmakingTicketId = 0;
+    if (bIsPrefetchingForMatchmaking){
+        bIsPrefetchingForMatchmaking = false;
+        StopSearchPrefetch();
+    }
+    if (MatchmakingTickerHandle.IsValid()){
+        FTSTicker::GetCoreTicker().RemoveTicker(MatchmakingTickerHandle);
+        MatchmakingTickerHandle.Reset();
+    }
+}
+
+
+bool UMultiplayerSessionsSubsystem::TickMatchmaking(float DeltaTime){
+    if (!Matchmaker.IsValid() || MatchmakingTicketId == 0){
+        CancelMatchmaking();
+        return false;
+    }
+    const double Now = FPlatformTime::Seconds();
+    // Assign every waiting player, the local one included
+    TArray<FMatchmakingAssignment> Assignments;
+    Matchmaker->Tick(Now, Assignments);
+    const FMatchmakingAssignment *Assignment = Assignments.FindByPredicate([this](const FMatchmakingAssignment &Candidate){
+        return Candidate.TicketId == MatchmakingTicketId;
+    });
+    if (Assignment){
+        // The ticket has been used up by the assignment
+        MatchmakingTicketId = 0;
+        const FOnlineSessionSearchResult *SearchResult = Matchmaker->GetSearchResult(Assignment->SessionId);
+        TArray<FOnlineSessionSearchResult> Candidates;
+        if (SearchResult){
+            Candidates.Add(*SearchResult);
+        }
+        CancelMatchmaking();
+        JoinWithFailover(MoveTemp(Candidates));
+        return false;
+    }
+    // Give up once the player has waited long enough
+    if (Now >= MatchmakingDeadline){
+        CancelMatchmaking();
+        MultiplayerOnJoinSessionsComplete.Broadcast(
+            EOnJoinSessionCompleteResult::SessionDoesNotExist
+        );
+        return false;
+    }
+    return true;
+}
+
+
+void UMultiplayerSessionsSubsystem::SetSearchCacheTTL(float FreshSeconds, float StaleSeconds){
+    SearchCache.SetTTL(FreshSeconds, StaleSeconds);
+}
+
+
+void UMultiplayerSessionsSubsystem::InvalidateSearchCache(){
+    SearchCache.Invalidate();
+}
+
+
+void UMultiplayerSessionsSubsystem::QuickJoin(const FSessionSearchFilter &Filter, float DeadlineSeconds, int32 MaxSearchResults){
+    // Check if SessionInterface is not valid
+    if (!SessionInterface.IsValid()){ // The way to check if TSharedPtr is valid is by using the 'IsValid' function
+        MultiplayerOnJoinSessionsComplete.Broadcast(
+            EOnJoinSessionCompleteResult::UnknownError
+        );
+        return;
+    }
+    // Lookups of known hosts started by an earlier quick join mustn't join anymore
+    KnownHostLookup->Cancel();
+
+    /*
+    Join straight from the search cache
+    */
+    const FSessionSearchQuery Query = MakeSearchQuery(MaxSearchResults, Filter);
+    // The cached results stay alive since a failing join replaces them in the cache
+    TSharedPtr<const TArray<FOnlineSessionSearchResult>> CachedResults;
+    const ESessionSearchCacheFreshness Freshness = SearchCache.Find(Query, FPlatformTime::Seconds(), CachedResults);
+    if (Freshness != ESessionSearchCacheFreshness::Missing && CachedResults->Num() > 0){
+        JoinBestSearchResult(*CachedResults);
+        // Stale results are joined as well, but get refreshed in the background like in RequestSessionSearch
+        if (Freshness == ESessionSearchCacheFreshness::Stale){
+            EnqueueCacheRefresh(Query);
+        }
+        return;
+    }
+
+    /*
+    Search until the first qualifying session shows up
+    */
+    // The backend runs one search at a time, so the quick join takes over from the running and queued searches
+    bool bHasDroppedForegroundSearch = false;
+    if (IsSearchInProgress()){
+        bHasDroppedForegroundSearch = !bIsBackgroundSearch && !bIsQuickJoinActive;
+        bIsQuickJoinActive = false;
+        AbortSessionSearch();
+    }
+    PendingOperations.RemoveAll([&bHasDroppedForegroundSearch](const FSessionOperation &QueuedOperation){
+        if (QueuedOperation.Type != ESessionOperationType::Find){
+            return false;
+        }
+        bHasDroppedForegroundSearch |= !QueuedOperation.bIsBackground && !QueuedOperation.bIsQuickJoin;
+        return true;
+    });
+    // Let whoever waited for the dropped searches know that they're over, without pretending that they found nothing
+    if (bHasDroppedForegroundSearch){
+        MultiplayerOnFindSessionsSuperseded.Broadcast();
+    }
+    FSessionOperation Operation;
+    Operation.Type = ESessionOperationType::Find;
+    Operation.Query = Query;
+    Operation.bIsBackground = true; // The results aren't broadcast
+    Operation.bIsQuickJoin = true;
+    Operation.QuickJoinDeadline = FPlatformTime::Seconds() + FMath::Max(DeadlineSeconds, 0.f);
+    EnqueueOperation(MoveTemp(Operation));
+    // Hosts joined in earlier runs are looked up while the search is running, whichever finds a session first gets joined
+    LookupKnownHosts(Filter);
+}
+
+
+void UMultiplayerSessionsSubsystem::LookupKnownHosts(const FSessionSearchFilter &Filter){
+    // The search may have joined already, e.g. when it ran synchronously
+    if (!IsQuickJoinPending()){
+        return;
+    }
+    // Backends that fail every lookup by id leave it to the search
+    if (!FSessionKnownHostLookup::DoesBackendFindSessionsById(SubsystemName)){
+        return;
+    }
+    // A lookup by id needs a searching player
+    const FUniqueNetIdPtr SearchingPlayerId = GetLocalPlayerNetId();
+    if (!SearchingPlayerId.IsValid()){
+        return;
+    }
+    TWeakObjectPtr<UMultiplayerSessionsSubsystem> WeakThis(this);
+    KnownHostLookup->Start(SessionInterface, *SearchingPlayerId, Filter, [WeakThis](const FOnlineSessionSearchResult &SearchResult){
+        return WeakThis.IsValid() && WeakThis->JoinKnownHost(SearchResult);
+    });
+}
+
+
+bool UMultiplayerSessionsSubsystem::JoinKnownHost(const FOnlineSessionSearchResult &SearchResult){
+    // The search may have joined already
+    if (!IsQuickJoinPending()){
+        return false;
+    }
+    // The known host beat the search, which isn't needed anymore
+    if (bIsQuickJoinActive){
+        bIsQuickJoinActive = false;
+        AbortSessionSearch();
+    }
+    PendingOperations.RemoveAll([](const FSessionOperation &Operation){
+        return Operation.bIsQuickJoin;
+    });
+    JoinBestSearchResult(MakeArrayView(&SearchResult, 1));
+    ProcessOperationQueue();
+    return true;
+}
+
+
+bool UMultiplayerSessionsSubsystem::IsQuickJoinPending() const{
+    return bIsQuickJoinActive || PendingOperations.ContainsByPredicate([](const FSessionOperation &Operation){
+        return Operation.bIsQuickJoin;
+    });
+}
+
+
+bool UMultiplayerSessionsSubsystem::Rejoin(){
+    if (!LastJoinedResult.IsSet() || !SessionInterface.IsValid()){
+        return false;
+    }
+    const int32 Serial = ++RejoinSerial;
+    // One lookup by id refreshes the session, on backends that can look sessions up by id
+    const FUniqueNetIdPtr SearchingPlayerId = GetLocalPlayerNetId();
+    const FUniqueNetIdPtr SessionId = SessionInterface->CreateSessionIdFromString(LastJoinedResult->GetSessionIdStr());
+    const bool bIsLookingUp = FSessionKnownHostLookup::DoesBackendFindSessionsById(SubsystemName) && SearchingPlayerId.IsValid() && SessionId.IsValid() && SessionInterface->FindSessionById(
+        *SearchingPlayerId,
+        *SessionId,
+        *SearchingPlayerId, // No friend is involved
+        FOnSingleSessionResultCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnRejoinSessionFound, Serial)
+    );
+    // Backends that can't look sessions up by id confirm the session through the joint itself, unless the lookup has already completed
+    if (!bIsLookingUp && Serial == RejoinSerial){
+        ++RejoinSerial;
+        ResumeRejoin(*LastJoinedResult);
+    }
+    return true;
+}
+
+
+void UMultiplayerSessionsSubsystem::OnRejoinSessionFound(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult &SearchResult, int32 Serial){
+    if (Serial != RejoinSerial){
+        return;
+    }
+    ++RejoinSerial;
+    // A failed lookup doesn't tell whether the session is gone, so the joint confirms it with the result remembered from the first joint
+    if (!bWasSuccessful || !SearchResult.IsValid()){
+        if (LastJoinedResult.IsSet()){
+            ResumeRejoin(*LastJoinedResult);
+        }
+        return;
+    }
+    ResumeRejoin(SearchResult);
+}
+
+
+void UMultiplayerSessionsSubsystem::ResumeRejoin(const FOnlineSessionSearchResult &SessionResult){
+    /*
+    Travel straight back if the local session survived the disconnect
+    */
+    if (const FNamedOnlineSession *Session = SessionInterface->GetNamedSession(LastJoinedSessionName)){
+        // The name may have been reused since, e.g. for hosting, in which case the session can't be joined under it
+        if (Session->GetSessionIdStr() != SessionResult.GetSessionIdStr()){
+            BroadcastJoinSession(LastJoinedSessionName, EOnJoinSessionCompleteResult::AlreadyInSession);
+            return;
+        }
+        const bool bHasTraveled = TravelToJoinedSession(LastJoinedSessionName);
+        BroadcastJoinSession(LastJoinedSessionName, bHasTraveled ? EOnJoinSessionCompleteResult::Success : EOnJoinSessionCompleteResult::CouldNotRetrieveAddress);
+        return;
+    }
+
+    /*
+    Otherwise join it again, the joint travels once it has completed
+    */
+    bIsRejoinActive = true;
+    JoinSession(SessionResult, LastJoinedSessionName);
+}
+
+
+bool UMultiplayerSessionsSubsystem::TravelToJoinedSession(FName SessionName){
+    // The address remembered from the first joint stands in if the backend can't resolve it anymore
+    FString Address;
+    if (!GetResolvedConnectString(Address, SessionName)){
+        Address = LastJoinedConnectString;
+    }
+    UGameInstance *GameInstance = GetGameInstance();
+    APlayerController *PlayerController = GameInstance ? GameInstance->GetFirstLocalPlayerController() : nullptr;
+    if (Address.IsEmpty() || PlayerController == nullptr){
+        return false;
+    }
+    // A client connects to the host with an absolute travel
+    PlayerController->ClientTravel(
+        Address,
+        ETravelType::TRAVEL_Absolute
+    );
+    return true;
+}
+
+
+void UMultiplayerSessionsSubsystem::ForgetLastJoinedSession(){
+    LastJoinedResult.Reset();
+    LastJoinedConnectString.Reset();
+    bIsRejoinActive = false;
+    ++RejoinSerial;
+}
+
+
+void UMultiplayerSessionsSubsystem::GetKnownHosts(const FString &MatchType, TArray<FKnownHost> &OutHosts) const{
+    KnownHostLookup->GetHosts().GetHosts(MatchType, OutHosts);
+}
+
+
+void UMultiplayerSessionsSubsystem::ClearKnownHosts(){
+    KnownHostLookup->Reset();
+}
+
+
+void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult &SessionResult, FName SessionName){
+    // Check if SessionInterface is not valid
+    if (!SessionInterface.IsValid()){ // The way to check if TSharedPtr is valid is by using the 'IsValid' function
+        // Broadcast custom multicast delegate
+        BroadcastJoinSession(SessionName, EOnJoinSessionCompleteResult::UnknownError);
+        return;
+    }
+
+    // A session picked by hand doesn't fail over
+    if (SessionName == NAME_GameSession){
+        JoinCandidates.Reset();
+    }
+    EnqueueJoinSession(SessionResult, false, SessionName);
+}
+
+
+void UMultiplayerSessionsSubsystem::EnqueueJoinSession(const FOnlineSessionSearchResult &SessionResult, bool bIsFailoverJoin, FName SessionName){
+    /*
+    Queue the session joint
+    */
+    FSessionOperation Operation;
+    Operation.Type = ESessionOperationType::Join;
+    Operation.SessionName = SessionName;
+    Operation.SessionResult = SessionResult;
+    Operation.bIsFailoverJoin = bIsFailoverJoin;
+    EnqueueOperation(MoveTemp(Operation));
+}
+
+
+bool UMultiplayerSessionsSubsystem::ExecuteJoinSession(const FSessionOperation &Operation){
+    // Check if SessionInterface is not valid
+    if (!SessionInterface.IsValid()){
+        BroadcastJoinSession(Operation.SessionName, EOnJoinSessionCompleteResult::UnknownError);
+        return false;
+    }
+
+    /*
+    Join the game session
+    */
+    FNamedSessionState &SessionState = GetOrAddNamedSession(Operation.SessionName);
+    BeginSessionOperation(SessionState, Operation, ESessionOperationState::Joining);
+    // Ask the host for a slot first, the joint is sent to the backend once the host answered
+    if (BeginJoinReservation(SessionState)){
+        return true;
+    }
+    return SendJoinSession(SessionState);
+}
+
+
+bool UMultiplayerSessionsSubsystem::SendJoinSession(FNamedSessionState &SessionState){
+    const FName SessionName = SessionState.ActiveOperation.SessionName;
+    // Get the unique net id of the world's first local player, a server joins as player number 0
+    const FUniqueNetIdPtr JoiningPlayerId = GetLocalPlayerNetId();
+	bool IsJointSuccessful = JoiningPlayerId.IsValid() ? SessionInterface->JoinSession(
+		*JoiningPlayerId,
+		SessionName,
+		SessionState.ActiveOperation.SessionResult
+	) : SessionInterface->JoinSession(
+		0,
+		SessionName,
+		SessionState.ActiveOperation.SessionResult
+	);
+    // If sessions joint is failed
+    if (!IsJointSuccessful){
+        if (CompleteRefusedOperation(SessionState, ESessionOperationState::Joining)){
+            Reservations->Cancel(SessionName);
+            // Broadcast custom multicast delegate
+            BroadcastJoinSession(SessionName, EOnJoinSessionCompleteResult::UnknownError);
+        }
+        return false;
+    }
+    return true;
+}
+
+
+bool UMultiplayerSessionsSubsystem::BeginJoinReservation(FNamedSessionState &SessionState){
+    TWeakObjectPtr<UMultiplayerSessionsSubsystem> WeakThis(this);
+    const FName SessionName = SessionState.ActiveOperation.SessionName;
+    return Reservations->Reserve(SessionInterface, SessionName, SessionState.ActiveOperation.SessionResult, [WeakThis, SessionName](const FSessionReservationReply &Reply){
+        if (WeakThis.IsValid()){
+            WeakThis->OnJoinReservationComplete(SessionName, Reply);
+        }
+    });
+}
+
+
+void UMultiplayerSessionsSubsystem::OnJoinReservationComplete(FName SessionName, const FSessionReservationReply &Reply){
+    // The joint may have been dropped in the meantime, e.g. because the session interface was replaced
+    FNamedSessionState *SessionState = FindWaitingSession(SessionName, ESessionOperationState::Joining);
+    if (SessionState == nullptr){
+        return;
+    }
+    // A full host turns the player away before the joint
+    if (Reply.Result == ESessionReservationResult::Full){
+        OnJoinReservationDenied(*SessionState);
+        return;
+    }
+    // Hosts that don't answer or don't know the session are joined without a reservation, the backend still has the last word
+    if (!SendJoinSession(*SessionState)){
+        ProcessOperationQueue();
+    }
+}
+
+
+void UMultiplayerSessionsSubsystem::OnJoinReservationDenied(FNamedSessionState &SessionState){
+    const FName SessionName = SessionState.ActiveOperation.SessionName;
+    // The joint never reached the backend, so it isn't recorded as a failed one, and the cached results of the other sessions are still good
+    SessionState.OperationState = ESessionOperationState::Idle;
+    Stats.CancelOperation(ESessionOperationType::Join, SessionState.ActiveOperation.BeginTime, SessionName);
+    // Only this session is full, the matchmaker stops assigning players to it until a search reports free slots again
+    if (Matchmaker.IsValid()){
+        Matchmaker->MarkSessionFull(SessionState.ActiveOperation.SessionResult.GetSessionIdStr());
+    }
+    FailOverOrBroadcastJoin(SessionName, SessionState.ActiveOperation.bIsFailoverJoin, true, EOnJoinSessionCompleteResult::SessionIsFull);
+}
+
+
+void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result){
+    // Only the completion of our own session joint is of interest
+    FNamedSessionState *SessionState = FindWaitingSession(SessionName, ESessionOperationState::Joining);
+    if (SessionState == nullptr){
+        return;
+    }
+    CompleteSessionOperation(*SessionState, Result == EOnJoinSessionCompleteResult::Success);
+    // The host takes up the held slot once the player arrives, a failed joint gives it back right away
+    if (Result == EOnJoinSessionCompleteResult::Success){
+        Reservations->Keep(SessionName);
+    }
+    else{
+        Reservations->Cancel(SessionName);
+    }
+    // Remember the host for the next run, or forget it if it's gone
+    if (Result == EOnJoinSessionCompleteResult::Success){
+        LastJoinedResult = SessionState->ActiveOperation.SessionResult;
+        LastJoinedSessionName = SessionName;
+        GetResolvedConnectString(LastJoinedConnectString, SessionName);
+        KnownHostLookup->RecordJoin(SessionState->ActiveOperation.SessionResult, LastJoinedConnectString);
+    }
+    else if (Result == EOnJoinSessionCompleteResult::SessionDoesNotExist){
+        KnownHostLookup->Forget(SessionState->ActiveOperation.SessionResult.GetSessionIdStr());
+    }
+    // The cached results didn't reflect the session correctly (e.g. it's full or gone), so it isn't served from the cache anymore. The rest of the cache stays, so that failing over through full sessions doesn't throw away every cached search
+    if (Result != EOnJoinSessionCompleteResult::Success){
+        SearchCache.RemoveSession(SessionState->ActiveOperation.SessionResult.GetSessionIdStr());
+        // Neither should the matchmaker pick it again until a search reports it anew
+        if (Matchmaker.IsValid()){
+            Matchmaker->RemoveSession(SessionState->ActiveOperation.SessionResult.GetSessionIdStr());
+        }
+    }
+    // A full or unreachable session makes way for the next best candidate
+    const bool bCanFailOver = Result == EOnJoinSessionCompleteResult::SessionIsFull || Result == EOnJoinSessionCompleteResult::CouldNotRetrieveAddress;
+    FailOverOrBroadcastJoin(SessionName, SessionState->ActiveOperation.bIsFailoverJoin, bCanFailOver, Result);
+}
+
+
+bool UMultiplayerSessionsSubsystem::GetResolvedConnectString(FString &OutAddress, FName SessionName) const{
+    if (!SessionInterface.IsValid() || !SessionInterface->GetResolvedConnectString(SessionName, OutAddress)){
+        return false;
+    }
+    // The backend resolves the address of the server process, a match instance of it listens on a port of its own
+    int32 MatchPort = 0;
+    const FOnlineSessionSettings *SessionSettings = SessionInterface->GetSessionSettings(SessionName);
+    FString Host;
+    if (SessionSettings && SessionSettings->Get(FName("MatchPort"), MatchPort) && MatchPort > 0 && OutAddress.Split(TEXT(":"), &Host, nullptr, ESearchCase::CaseSensitive, ESearchDir::FromEnd)){
+        OutAddress = FString::Printf(TEXT("%s:%d"), *Host, MatchPort);
+    }
+    return true;
+}
+
+
+void UMultiplayerSessionsSubsystem::DestroySession(FName SessionName){
+    // Check if SessionInterface is not valid
+    if (!SessionInterface.IsValid()){ // The way to check if TSharedPtr is valid is by using the 'IsValid' function
+        // Broadcast custom multicast delegate
+        BroadcastSessionOperation(SessionName, ESessionOperationType::Destroy, false);
+        return;
+    }
+
+    /*
+    Queue the session destruction
+    */
+    FSessionOperation Operation;
+    Operation.Type = ESessionOperationType::Destroy;
+    Operation.SessionName = SessionName;
+    EnqueueOperation(MoveTemp(Operation));
+}
+
+
+bool UMultiplayerSessionsSubsystem::ExecuteDestroySession(const FSessionOperation &Operation){
+    // Check if SessionInterface is not valid
+    if (!SessionInterface.IsValid()){
+        BroadcastSessionOperation(Operation.SessionName, ESessionOperationType::Destroy, false);
+        DropPipelinedCreation(Operation.SessionName);
+        return false;
+    }
+
+    /*
+    Destroy the game session
+    */
+    FNamedSessionState &SessionState = GetOrAddNamedSession(Operation.SessionName);
+    BeginSessionOperation(SessionState, Operation, ESessionOperationState::Destroying);
+    bool IsDestructionSuccessful = SessionInterface->DestroySession(
+        Operation.SessionName
+    );
+    // If sessions destruction is failed
+    if (!IsDestructionSuccessful){
+        if (CompleteRefusedOperation(SessionState, ESessionOperationState::Destroying)){
+            // Broadcast custom multicast delegate
+            BroadcastSessionOperation(Operation.SessionName, ESessionOperationType::Destroy, false);
+            DropPipelinedCreation(Operation.SessionName);
+        }
+        return false;
+    }
+    return true;
+}
+
+
+void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessful){
+    // Only the completion of our own session destruction is of interest
+    FNamedSessionState *SessionState = FindWaitingSession(SessionName, ESessionOperationState::Destroying);
+    if (SessionState == nullptr){
+        return;
+    }
+    CompleteSessionOperation(*SessionState, bWasSuccessful);
+    // Broadcast custom multicast delegate
+    BroadcastSessionOperation(SessionName, ESessionOperationType::Destroy, bWasSuccessful);
+    // The creation pipelined behind a failed destruction can't succeed, otherwise it runs next
+    if (!bWasSuccessful){
+        DropPipelinedCreation(SessionName);
+    }
+    // A session that is gone has nothing left to advertise, nor slots to reserve
+    else{
+        DiscardDirtySettings(*SessionState);
+        Reservations->RemoveHostedSession(SessionName);
+    }
+    ProcessOperationQueue();
+}
+
+
+void UMultiplayerSessionsSubsystem::DropPipelinedCreation(FName SessionName){
+    // The pipelined creation is the first queued operation on the session
+    const int32 Index = PendingOperations.IndexOfByPredicate([SessionName](const FSessionOperation &Operation){
+        return Operation.Type != ESessionOperationType::Find && Operation.SessionName == SessionName;
+    });
+    if (Index != INDEX_NONE && PendingOperations[Index].Type == ESessionOperationType::Create && PendingOperations[Index].bHasDestroyedExistingSession){
+        PendingOperations.RemoveAt(Index);
+        BroadcastSessionOperation(SessionName, ESessionOperationType::Create, false);
+    }
+}
+
+
+void UMultiplayerSessionsSubsystem::StartSession(FName SessionName){
+    // Check if SessionInterface is not valid
+    if (!SessionInterface.IsValid()){
+        BroadcastSessionOperation(SessionName, ESessionOperationType::Start, false);
+        return;
+    }
+
+    /*
+    Queue the session start
+    */
+    FSessionOperation Operation;
+    Operation.Type = ESessionOperationType::Start;
+    Operation.SessionName = SessionName;
+    EnqueueOperation(MoveTemp(Operation));
+}
+
+
+bool UMultiplayerSessionsSubsystem::ExecuteStartSession(const FSessionOperation &Operation){
+    FNamedSessionState &SessionState = GetOrAddNamedSession(Operation.SessionName);
+    BeginSessionOperation(SessionState, Operation, ESessionOperationState::Starting);
+    bool IsStartSuccessful = SessionInterface.IsValid() && SessionInterface->StartSession(
+        Operation.SessionName
+    );
+    // If session start is failed
+    if (!IsStartSuccessful){
+        if (CompleteRefusedOperation(SessionState, ESessionOperationState::Starting)){
+            // Broadcast custom multicast delegate
+            BroadcastSessionOperation(Operation.SessionName, ESessionOperationType::Start, false);
+        }
+        return false;
+    }
+    return true;
+}
+
+
+void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful){
+    // Only the completion of our own session start is of interest
+    FNamedSessionState *SessionState = FindWaitingSession(SessionName, ESessionOperationState::Starting);
+    if (SessionState == nullptr){
+        return;
+    }
+    CompleteSessionOperation(*SessionState, bWasSuccessful);
+    // Broadcast custom multicast delegate
+    BroadcastSessionOperation(SessionName, ESessionOperationType::Start, bWasSuccessful);
+    ProcessOperationQueue();
+}
+
+
+void UMultiplayerSessionsSubsystem::SetSessionSettingData(FName Key, const FVariantData &Data, FName SessionName){
+    if (!SessionInterface.IsValid()){
+        return;
+    }
+    FNamedSessionState &SessionState = GetOrAddNamedSession(SessionName);
+    // A later change of the same key replaces the earlier one
+    SessionState.DirtySettings.Add(Key, FOnlineSessionSetting(Data, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing));
+    MarkSessionUpdatePending(SessionState);
+}
+
+
+void UMultiplayerSessionsSubsystem::SetSessionPublicConnections(int32 NumPublicConnections, FName SessionName){
+    if (!SessionInterface.IsValid()){
+        return;
+    }
+    FNamedSessionState &SessionState = GetOrAddNamedSession(SessionName);
+    SessionState.DirtyNumPublicConnections = FMath::Max(NumPublicConnections, 0);
+    MarkSessionUpdatePending(SessionState);
+}
+
+
+void UMultiplayerSessionsSubsystem::MarkSessionPlayersChanged(FName SessionName){
+    if (!SessionInterface.IsValid()){
+        return;
+    }
+    // The backend keeps count of the registered players, the update only has to happen
+    MarkSessionUpdatePending(GetOrAddNamedSession(SessionName));
+    // Arriving players take up their reservations right away, rather than once the update is through
+    UpdateReservableSession(SessionName);
+}
+
+
+void UMultiplayerSessionsSubsystem::SetSessionUpdateInterval(float IntervalSeconds){
+    SessionUpdateInterval = FMath::Max(IntervalSeconds, 0.f);
+}
+
+
+void UMultiplayerSessionsSubsystem::MarkSessionUpdatePending(FNamedSessionState &SessionState){
+    SessionState.bIsUpdatePending = true;
+    // The ticker only runs while updates are pending
+    if (!SessionUpdateTickerHandle.IsValid()){
+        SessionUpdateTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+            FTickerDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::TickSessionUpdates),
+            SessionUpdateTickInterval
+        );
+    }
+}
+
+
+void UMultiplayerSessionsSubsystem::ApplyDirtySettings(FNamedSessionState &SessionState){
+    if (SessionState.Settings.IsValid()){
+        FOnlineSessionSettings &SessionSettings = *SessionState.Settings;
+        for (const TPair<FName, FOnlineSessionSetting> &DirtySetting : SessionState.DirtySettings){
+            SessionSettings.Settings.Add(DirtySetting.Key, DirtySetting.Value);
+        }
+        if (SessionState.DirtyNumPublicConnections >= 0){
+            SessionSettings.NumPublicConnections = SessionState.DirtyNumPublicConnections;
+        }
+    }
+    DiscardDirtySettings(SessionState);
+}
+
+
+void UMultiplayerSessionsSubsystem::DiscardDirtySettings(FNamedSessionState &SessionState){
+    SessionState.DirtySettings.Reset();
+    SessionState.DirtyNumPublicConnections = -1;
+    SessionState.bIsUpdatePending = false;
+}
+
+
+bool UMultiplayerSessionsSubsystem::TickSessionUpdates(float DeltaTime){
+    if (!SessionInterface.IsValid()){
+        SessionUpdateTickerHandle.Reset();
+        return false;
+    }
+    const double Now = FPlatformTime::Seconds();
+    // Queueing runs operations whose callbacks may add sessions, so the due ones are collected first
+    TArray<FName, TInlineAllocator<4>> DueSessionNames;
+    for (TPair<FName, TUniquePtr<FNamedSessionState>> &NamedSession : NamedSessions){
+        FNamedSessionState &SessionState = *NamedSession.Value;
+        // Wait for the operation running on the session (e.g. its creation) and for the rate limit
+        if (!SessionState.bIsUpdatePending || SessionState.OperationState != ESessionOperationState::Idle || Now < SessionState.NextUpdateTime){
+            continue;
+        }
+        // Only a session hosted by this subsystem is advertised, the changes to one that is about to be created go out with the creation
+        const FNamedOnlineSession *Session = SessionInterface->GetNamedSession(SessionState.SessionName);
+        if (!SessionState.Settings.IsValid() || Session == nullptr || !Session->bHosting){
+            const bool bIsCreationQueued = PendingOperations.ContainsByPredicate([&SessionState](const FSessionOperation &Operation){
+                return Operation.Type == ESessionOperationType::Create && Operation.SessionName == SessionState.SessionName;
+            });
+            if (!bIsCreationQueued){
+                DiscardDirtySettings(SessionState);
+            }
+            continue;
+        }
+        // Everything changed until the update runs goes out with it
+        SessionState.bIsUpdatePending = false;
+        SessionState.NextUpdateTime = Now + SessionUpdateInterval;
+        DueSessionNames.Add(SessionState.SessionName);
+    }
+    for (FName SessionName : DueSessionNames){
+        FSessionOperation Operation;
+        Operation.Type = ESessionOperationType::Update;
+        Operation.SessionName = SessionName;
+        EnqueueOperation(MoveTemp(Operation));
+    }
+    // Keep ticking while anything is pending, including the updates that failed right away, changes arriving later register the ticker again
+    for (const TPair<FName, TUniquePtr<FNamedSessionState>> &NamedSession : NamedSessions){
+        if (NamedSession.Value->bIsUpdatePending){
+            return true;
+        }
+    }
+    SessionUpdateTickerHandle.Reset();
+    return false;
+}
+
+
+void UMultiplayerSessionsSubsystem::StopSessionUpdates(){
+    if (SessionUpdateTickerHandle.IsValid()){
+        FTSTicker::GetCoreTicker().RemoveTicker(SessionUpdateTickerHandle);
+        SessionUpdateTickerHandle.Reset();
+    }
+}
+
+
+bool UMultiplayerSessionsSubsystem::ExecuteUpdateSession(const FSessionOperation &Operation){
+    FNamedSessionState *SessionState = FindNamedSession(Operation.SessionName);
+    // The session may have been destroyed or replaced while the update was queued
+    if (!SessionInterface.IsValid() || SessionState == nullptr || !SessionState->Settings.IsValid() || SessionInterface->GetNamedSession(Operation.SessionName) == nullptr){
+        return false;
+    }
+
+    /*
+    Update the session advertisement
+    */
+    ApplyDirtySettings(*SessionState);
+    SessionState->NextUpdateTime = FPlatformTime::Seconds() + SessionUpdateInterval;
+    BeginSessionOperation(*SessionState, Operation, ESessionOperationState::Updating);
+    bool IsUpdateSuccessful = SessionInterface->UpdateSession(
+        Operation.SessionName,
+        *SessionState->Settings,
+        true // Push the settings to the online service
+    );
+    // If session update is failed
+    if (!IsUpdateSuccessful){
+        if (CompleteRefusedOperation(*SessionState, ESessionOperationState::Updating)){
+            BroadcastSessionOperation(Operation.SessionName, ESessionOperationType::Update, false);
+            // The settings are applied locally already, so the next attempt only has to happen
+            MarkSessionUpdatePending(*SessionState);
+        }
+        return false;
+    }
+    return true;
+}
+
+
+void UMultiplayerSessionsSubsystem::OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful){
+    // Only the completion of our own session update is of interest
+    FNamedSessionState *SessionState = FindWaitingSession(SessionName, ESessionOperationState::Updating);
+    if (SessionState == nullptr){
+        return;
+    }
+    CompleteSessionOperation(*SessionState, bWasSuccessful);
+    // Retry once the rate limit allows, together with whatever changed since
+    if (!bWasSuccessful){
+        MarkSessionUpdatePending(*SessionState);
+    }
+    // The number of public connections may have changed
+    else{
+        UpdateReservableSession(SessionName);
+    }
+    // Broadcast custom multicast delegate
+    BroadcastSessionOperation(SessionName, ESessionOperationType::Update, bWasSuccessful);
+    ProcessOperationQueue();
+}
+
+
+FSessionStatsSnapshot UMultiplayerSessionsSubsystem::GetStatsSnapshot() const{
+    return Stats.GetSnapshot();
+}
+
+
+void UMultiplayerSessionsSubsystem::ResetStats(){
+    Stats.Reset();
+}
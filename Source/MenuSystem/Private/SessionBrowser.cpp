@@ -0,0 +1,414 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionBrowser.h"
+
+#include "Components/Button.h"
+#include "Components/ListView.h"
+#include "Components/TextBlock.h"
+#include "OnlineSessionSettings.h"
+
+
+/*
+Item
+*/
+bool USessionBrowserItem::UpdateFrom(const FOnlineSessionSearchResult &Result){
+    SearchResult = Result;
+    const FOnlineSessionSettings &SessionSettings = Result.Session.SessionSettings;
+    FString NewMatchType;
+    SessionSettings.Get(FName("MatchType"), NewMatchType);
+    const int32 NewMaxPlayers = SessionSettings.NumPublicConnections;
+    const int32 NewNumPlayers = FMath::Max(NewMaxPlayers - Result.Session.NumOpenPublicConnections, 0);
+    // Backends report MAX_QUERY_PING or nothing when they couldn't measure the ping
+    const int32 NewPingMs = Result.PingInMs > 0 && Result.PingInMs < MAX_QUERY_PING ? Result.PingInMs : -1;
+    // Most sessions don't change between two searches, their rows are left alone
+    if (ServerName == Result.Session.OwningUserName && MatchType == NewMatchType && NumPlayers == NewNumPlayers && MaxPlayers == NewMaxPlayers && PingMs == NewPingMs){
+        return false;
+    }
+    ServerName = Result.Session.OwningUserName;
+    MatchType = MoveTemp(NewMatchType);
+    NumPlayers = NewNumPlayers;
+    MaxPlayers = NewMaxPlayers;
+    PingMs = NewPingMs;
+    OnItemChanged.Broadcast();
+    return true;
+}
+
+
+/*
+Row
+*/
+void USessionBrowserRow::NativeOnListItemObjectSet(UObject *ListItemObject){
+    // Rows are recycled while scrolling, so the previous item has to let go of this row
+    ReleaseItem();
+    Item = Cast<USessionBrowserItem>(ListItemObject);
+    if (Item){
+        ItemChangedHandle = Item->OnItemChanged.AddUObject(this, &USessionBrowserRow::RefreshRow);
+    }
+    RefreshRow();
+}
+
+
+void USessionBrowserRow::NativeOnEntryReleased(){
+    ReleaseItem();
+}
+
+
+void USessionBrowserRow::ReleaseItem(){
+    if (Item){
+        Item->OnItemChanged.Remove(ItemChangedHandle);
+    }
+    ItemChangedHandle.Reset();
+    Item = nullptr;
+}
+
+
+void USessionBrowserRow::RefreshRow(){
+    if (Item == nullptr){
+        return;
+    }
+    if (ServerNameText){
+        ServerNameText->SetText(FText::FromString(Item->ServerName));
+    }
+    if (MatchTypeText){
+        MatchTypeText->SetText(FText::FromString(Item->MatchType));
+    }
+    if (PlayersText){
+        PlayersText->SetText(FText::Format(FText::FromString(TEXT("{0}/{1}")), FText::AsNumber(Item->NumPlayers), FText::AsNumber(Item->MaxPlayers)));
+    }
+    if (PingText){
+        PingText->SetText(Item->PingMs >= 0 ? FText::AsNumber(Item->PingMs) : FText::FromString(TEXT("-")));
+    }
+}
+
+
+/*
+Browser
+*/
+bool USessionBrowser::Initialize(){
+    // Call the super version
+    if (!Super::Initialize()){
+        return false;
+    }
+
+    /*
+    Bind callbacks to buttons and the list view
+    */
+    if (RefreshButton){
+        RefreshButton->OnClicked.AddDynamic(this, &USessionBrowser::RefreshButtonClicked);
+    }
+    if (JoinButton){
+        JoinButton->OnClicked.AddDynamic(this, &USessionBrowser::JoinButtonClicked);
+    }
+    if (ServerNameHeaderButton){
+        ServerNameHeaderButton->OnClicked.AddDynamic(this, &USessionBrowser::ServerNameHeaderClicked);
+    }
+    if (MatchTypeHeaderButton){
+        MatchTypeHeaderButton->OnClicked.AddDynamic(this, &USessionBrowser::MatchTypeHeaderClicked);
+    }
+    if (PlayersHeaderButton){
+        PlayersHeaderButton->OnClicked.AddDynamic(this, &USessionBrowser::PlayersHeaderClicked);
+    }
+    if (PingHeaderButton){
+        PingHeaderButton->OnClicked.AddDynamic(this, &USessionBrowser::PingHeaderClicked);
+    }
+    if (SessionList){
+        SessionList->OnItemDoubleClicked().AddUObject(this, &USessionBrowser::OnItemDoubleClicked);
+    }
+    return true;
+}
+
+
+void USessionBrowser::BrowserSetup(int32 NumberOfSearchResults, FString TypeOfMatch){
+    /*
+    Set member variables with inputs
+    */
+    MaxSearchResults = NumberOfSearchResults;
+    MatchType = TypeOfMatch;
+    bIsTornDown = false;
+
+    // Add the widget to viewport
+    AddToViewport();
+    // Set the widget's visibility to visible
+    SetVisibility(ESlateVisibility::Visible);
+    // Set the widget to be focusable
+    SetIsFocusable(true);
+
+    /*
+    Set the input mode via player controller
+    */
+    UWorld *World = GetWorld();
+    if (World){
+        APlayerController *PlayerController = World->GetFirstPlayerController();
+        if (PlayerController){
+            // Focus on the UI rather than on pawns, and let the cursor leave the viewport
+            FInputModeUIOnly InputModeData;
+            InputModeData.SetWidgetToFocus(TakeWidget());
+            InputModeData.SetLockMouseToViewportBehavior(EMouseLockMode::DoNotLock);
+            PlayerController->SetInputMode(InputModeData);
+            PlayerController->SetShowMouseCursor(true);
+        }
+    }
+
+    UGameInstance *GameInstance = GetGameInstance();
+    if (GameInstance){
+        // Get subsystem and store it in MultiplayerSessionsSubsystem pointer
+        MultiplayerSessionsSubsystem = GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>();
+    }
+
+    /*
+    Bind callback functions to multicast delegates
+    */
+    if (MultiplayerSessionsSubsystem){
+        MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsComplete.AddUObject(this, &USessionBrowser::OnFindSessions);
+        MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionsComplete.AddUObject(this, &USessionBrowser::OnJoinSession);
+        // Show what is known already while the refresh is running
+        FSessionSearchSnapshot CachedResults = MultiplayerSessionsSubsystem->GetLastSearchResults();
+        if (!CachedResults.IsEmpty()){
+            OnFindSessions(CachedResults, true);
+        }
+        Refresh();
+    }
+}
+
+
+void USessionBrowser::Refresh(){
+    if (MultiplayerSessionsSubsystem){
+        FSessionSearchFilter Filter;
+        Filter.MatchType = MatchType;
+        MultiplayerSessionsSubsystem->FindSessions(MaxSearchResults, Filter);
+    }
+}
+
+
+void USessionBrowser::RefreshButtonClicked(){
+    Refresh();
+}
+
+
+void USessionBrowser::JoinButtonClicked(){
+    if (SessionList){
+        JoinItem(SessionList->GetSelectedItem<USessionBrowserItem>());
+    }
+}
+
+
+void USessionBrowser::OnItemDoubleClicked(UObject *ListItemObject){
+    JoinItem(Cast<USessionBrowserItem>(ListItemObject));
+}
+
+
+void USessionBrowser::JoinItem(USessionBrowserItem *Item){
+    if (Item == nullptr || MultiplayerSessionsSubsystem == nullptr){
+        return;
+    }
+    if (JoinButton){
+        JoinButton->SetIsEnabled(false);
+    }
+    MultiplayerSessionsSubsystem->JoinSession(Item->SearchResult);
+}
+
+
+void USessionBrowser::OnFindSessions(const FSessionSearchSnapshot &SessionResults, bool bWasSuccessful){
+    // A failed search leaves the list as it is
+    if (!bWasSuccessful){
+        return;
+    }
+    // The snapshot shares the results rather than copying them, so holding on to it across frames is cheap. A newer search replaces one that is still being applied
+    PendingResults = SessionResults;
+    PendingResultCursor = 0;
+    ++SearchGeneration;
+}
+
+
+void USessionBrowser::NativeTick(const FGeometry &MyGeometry, float InDeltaTime){
+    Super::NativeTick(MyGeometry, InDeltaTime);
+    if (PendingResultCursor == INDEX_NONE){
+        return;
+    }
+    // Spread big result sets over several frames rather than stalling one
+    if (!ApplyPendingResults(FPlatformTime::Seconds() + UpdateBudgetSeconds)){
+        return;
+    }
+    PendingResultCursor = INDEX_NONE;
+    PendingResults = FSessionSearchSnapshot();
+    RemoveStaleItems();
+    // Rows whose values changed have refreshed themselves already, the list itself only changes if the order did
+    if (bIsOrderDirty){
+        SortItems();
+    }
+}
+
+
+bool USessionBrowser::ApplyPendingResults(double Deadline){
+    const int32 NumResults = PendingResults.Num();
+    while (PendingResultCursor < NumResults){
+        // Checking the clock every result would cost more than applying it
+        const int32 BatchEnd = FMath::Min(PendingResultCursor + 64, NumResults);
+        for (; PendingResultCursor < BatchEnd; ++PendingResultCursor){
+            const FOnlineSessionSearchResult &Result = PendingResults[PendingResultCursor];
+            const FString SessionId = Result.GetSessionIdStr();
+            USessionBrowserItem *&Item = ItemsById.FindOrAdd(SessionId);
+            if (Item == nullptr){
+                // Reuse the item of a session that went away before creating a new one
+                Item = ItemPool.Num() > 0 ? ItemPool.Pop() : NewObject<USessionBrowserItem>(this);
+                Item->SessionId = SessionId;
+                Items.Add(Item);
+                Item->UpdateFrom(Result);
+                bIsOrderDirty = true;
+            }
+            else if (Item->UpdateFrom(Result)){
+                bIsOrderDirty = true;
+            }
+            Item->SearchGeneration = SearchGeneration;
+        }
+        if (FPlatformTime::Seconds() >= Deadline){
+            return PendingResultCursor >= NumResults;
+        }
+    }
+    return true;
+}
+
+
+void USessionBrowser::RemoveStaleItems(){
+    const int32 NumItems = Items.Num();
+    Items.RemoveAll([this](USessionBrowserItem *Item){
+        if (Item->SearchGeneration == SearchGeneration){
+            return false;
+        }
+        ItemsById.Remove(Item->SessionId);
+        Item->OnItemChanged.Clear();
+        ItemPool.Add(Item);
+        return true;
+    });
+    if (Items.Num() != NumItems){
+        bIsOrderDirty = true;
+    }
+}
+
+
+void USessionBrowser::SortBy(ESessionBrowserColumn Column){
+    // Sorting by the same column again flips the order
+    bIsSortAscending = Column == SortColumn ? !bIsSortAscending : true;
+    SortColumn = Column;
+    SortItems();
+}
+
+
+void USessionBrowser::SortItems(){
+    bIsOrderDirty = false;
+    const ESessionBrowserColumn Column = SortColumn;
+    const bool bIsAscending = bIsSortAscending;
+    Items.Sort([Column, bIsAscending](const USessionBrowserItem &A, const USessionBrowserItem &B){
+        int32 Order = 0;
+        switch (Column){
+            case ESessionBrowserColumn::ServerName:
+                Order = A.ServerName.Compare(B.ServerName, ESearchCase::IgnoreCase);
+                break;
+            case ESessionBrowserColumn::MatchType:
+                Order = A.MatchType.Compare(B.MatchType, ESearchCase::IgnoreCase);
+                break;
+            case ESessionBrowserColumn::Players:
+                Order = A.NumPlayers - B.NumPlayers;
+                break;
+            case ESessionBrowserColumn::Ping:{
+                // Unknown pings go last
+                const int32 PingA = A.PingMs < 0 ? MAX_int32 : A.PingMs;
+                const int32 PingB = B.PingMs < 0 ? MAX_int32 : B.PingMs;
+                Order = PingA < PingB ? -1 : (PingA > PingB ? 1 : 0);
+                break;
+            }
+        }
+        // Ties are broken by the session id, so that rows don't jump around between refreshes
+        if (Order == 0){
+            return A.SessionId < B.SessionId;
+        }
+        return bIsAscending ? Order < 0 : Order > 0;
+    });
+    // The list view only creates and refreshes the rows that are visible
+    if (SessionList){
+        SessionList->SetListItems(Items);
+    }
+}
+
+
+void USessionBrowser::ServerNameHeaderClicked(){
+    SortBy(ESessionBrowserColumn::ServerName);
+}
+
+
+void USessionBrowser::MatchTypeHeaderClicked(){
+    SortBy(ESessionBrowserColumn::MatchType);
+}
+
+
+void USessionBrowser::PlayersHeaderClicked(){
+    SortBy(ESessionBrowserColumn::Players);
+}
+
+
+void USessionBrowser::PingHeaderClicked(){
+    SortBy(ESessionBrowserColumn::Ping);
+}
+
+
+void USessionBrowser::OnJoinSession(EOnJoinSessionCompleteResult::Type Result){
+    /*
+    Travel to the host
+    */
+    FString Address;
+    if (Result == EOnJoinSessionCompleteResult::Success && MultiplayerSessionsSubsystem && MultiplayerSessionsSubsystem->GetResolvedConnectString(Address)){
+        APlayerController *PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
+        if (PlayerController){
+            PlayerController->ClientTravel(
+                Address,
+                ETravelType::TRAVEL_Absolute
+            );
+            return;
+        }
+    }
+    // Enable JoinButton if failed to join session
+    if (JoinButton){
+        JoinButton->SetIsEnabled(true);
+    }
+}
+
+
+void USessionBrowser::BrowserTearDown(){
+    if (bIsTornDown){
+        return;
+    }
+    bIsTornDown = true;
+    // Remove the widget from the viewport
+    RemoveFromParent();
+
+    /*
+    Unbind callback functions from the subsystem, which outlives the browser
+    */
+    if (MultiplayerSessionsSubsystem){
+        MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsComplete.RemoveAll(this);
+        MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionsComplete.RemoveAll(this);
+    }
+    PendingResultCursor = INDEX_NONE;
+    PendingResults = FSessionSearchSnapshot();
+
+    /*
+    Reset the input mode
+    */
+    UWorld *World = GetWorld();
+    if (World){
+        APlayerController *PlayerController = World->GetFirstPlayerController();
+        if (PlayerController){
+            FInputModeGameOnly InputModeData;
+            PlayerController->SetInputMode(InputModeData);
+            PlayerController->SetShowMouseCursor(false);
+        }
+    }
+}
+
+
+void USessionBrowser::NativeDestruct(){
+    // Remove the widget from the viewport and reset the input mode
+    BrowserTearDown();
+    // Call the super version
+    Super::NativeDestruct();
+}
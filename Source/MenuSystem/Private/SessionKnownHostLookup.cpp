@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionKnownHostLookup.h"
+
+#include "OnlineSessionSettings.h"
+#include "OnlineSubsystemNames.h"
+
+
+namespace
+{
+    // Function to get the ping of a search result in milliseconds, negative if the backend couldn't measure it
+    float GetPingMs(const FOnlineSessionSearchResult &SearchResult){
+        const int32 PingInMs = SearchResult.PingInMs;
+        return PingInMs > 0 && PingInMs < MAX_QUERY_PING ? PingInMs : -1.f;
+    }
+}
+
+
+/*
+File
+*/
+void FSessionKnownHostLookup::Load(const FString &InFilePath){
+    FilePath = InFilePath;
+    Hosts.Load(FilePath);
+}
+
+
+void FSessionKnownHostLookup::Save(){
+    if (!FilePath.IsEmpty()){
+        Hosts.Save(FilePath);
+    }
+}
+
+
+/*
+Lookups
+*/
+void FSessionKnownHostLookup::Start(const IOnlineSessionPtr &SessionInterface, const FUniqueNetId &SearchingPlayerId, const FSessionSearchFilter &Filter, TFunction<bool(const FOnlineSessionSearchResult&)> OnFound){
+    const int32 Serial = ++LookupSerial;
+    if (NumLookups <= 0 || !SessionInterface.IsValid()){
+        return;
+    }
+    TArray<FKnownHost> KnownHosts;
+    Hosts.GetHosts(Filter.MatchType, KnownHosts);
+    const int32 NumHostLookups = FMath::Min(KnownHosts.Num(), NumLookups);
+    for (int32 Index = 0; Index < NumHostLookups; ++Index){
+        const FUniqueNetIdPtr SessionId = SessionInterface->CreateSessionIdFromString(KnownHosts[Index].SessionId);
+        if (!SessionId.IsValid()){
+            continue;
+        }
+        SessionInterface->FindSessionById(
+            SearchingPlayerId,
+            *SessionId,
+            SearchingPlayerId, // No friend is involved
+            FOnSingleSessionResultCompleteDelegate::CreateSP(AsShared(), &FSessionKnownHostLookup::OnHostFound, Serial, Filter, OnFound)
+        );
+    }
+}
+
+
+void FSessionKnownHostLookup::OnHostFound(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult &SearchResult, int32 Serial, FSessionSearchFilter Filter, TFunction<bool(const FOnlineSessionSearchResult&)> OnFound){
+    // Only the lookups of the latest quick join may report, and only the first of them to find its session
+    if (Serial != LookupSerial){
+        return;
+    }
+    // A failed lookup doesn't tell whether the host is gone (e.g. a transient backend error), only a joint reporting the session as missing forgets it
+    if (!bWasSuccessful || !SearchResult.IsValid()){
+        return;
+    }
+    // The session may have changed since it was joined, e.g. filled up, so it has to satisfy the filter like any search result
+    if (!Filter.Matches(SearchResult, false)){
+        return;
+    }
+    if (OnFound && OnFound(SearchResult)){
+        ++LookupSerial;
+    }
+}
+
+
+bool FSessionKnownHostLookup::DoesBackendFindSessionsById(FName SubsystemName){
+    return SubsystemName != NULL_SUBSYSTEM && SubsystemName != STEAM_SUBSYSTEM;
+}
+
+
+/*
+Hosts
+*/
+void FSessionKnownHostLookup::RecordJoin(const FOnlineSessionSearchResult &SessionResult, const FString &ConnectString){
+    if (FilePath.IsEmpty()){
+        return;
+    }
+    FString JoinedMatchType;
+    SessionResult.Session.SessionSettings.Get(FName("MatchType"), JoinedMatchType);
+    Hosts.RecordJoin(SessionResult.GetSessionIdStr(), ConnectString, JoinedMatchType, GetPingMs(SessionResult));
+    Hosts.Save(FilePath);
+}
+
+
+void FSessionKnownHostLookup::RecordSeen(const FOnlineSessionSearchResult &SearchResult){
+    Hosts.RecordSeen(SearchResult.GetSessionIdStr(), GetPingMs(SearchResult));
+}
+
+
+void FSessionKnownHostLookup::Reset(){
+    ++LookupSerial;
+    Hosts.Reset();
+    Save();
+}
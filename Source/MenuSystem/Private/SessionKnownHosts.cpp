@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionKnownHosts.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+
+namespace
+{
+    // Magic number at the start of the file, "MSKH" in little endian
+    constexpr uint32 KnownHostsMagic = 0x484B534D;
+    // Version of the file format, files of another version are discarded
+    constexpr uint32 KnownHostsVersion = 1;
+    // Upper bound on the number of entries a file may claim, anything above is treated as corrupt
+    constexpr int32 MaxFileEntries = 1024;
+
+    int64 GetUnixTime(){
+        return FDateTime::UtcNow().ToUnixTimestamp();
+    }
+
+    // Layout of an entry, used for reading and writing alike
+    void SerializeHost(FArchive &Ar, FKnownHost &Host){
+        Ar << Host.SessionId;
+        Ar << Host.ConnectString;
+        Ar << Host.LastRttMs;
+        Ar << Host.MatchType;
+        Ar << Host.Timestamp;
+    }
+}
+
+
+/*
+File
+*/
+bool FSessionKnownHosts::Load(const FString &FilePath){
+    Hosts.Reset();
+    bIsDirty = false;
+    // The whole file is read at once, it's a few kilobytes at most
+    TArray<uint8> FileData;
+    if (!FFileHelper::LoadFileToArray(FileData, *FilePath, FILEREAD_Silent)){
+        return false;
+    }
+    FMemoryReader Reader(FileData);
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    int32 NumEntries = 0;
+    Reader << Magic;
+    Reader << Version;
+    Reader << NumEntries;
+    if (Reader.IsError() || Magic != KnownHostsMagic || Version != KnownHostsVersion || NumEntries < 0 || NumEntries > MaxFileEntries){
+        return false;
+    }
+    Hosts.Reserve(NumEntries);
+    for (int32 Index = 0; Index < NumEntries; ++Index){
+        FKnownHost Host;
+        SerializeHost(Reader, Host);
+        // A truncated file loses all of its entries rather than keeping half-read ones
+        if (Reader.IsError()){
+            Hosts.Reset();
+            return false;
+        }
+        if (!Host.SessionId.IsEmpty()){
+            Hosts.Add(Host.SessionId, MoveTemp(Host));
+        }
+    }
+    Prune();
+    return true;
+}
+
+
+bool FSessionKnownHosts::Save(const FString &FilePath){
+    if (!bIsDirty){
+        return true;
+    }
+    Prune();
+    TArray<uint8> FileData;
+    FMemoryWriter Writer(FileData);
+    uint32 Magic = KnownHostsMagic;
+    uint32 Version = KnownHostsVersion;
+    int32 NumEntries = Hosts.Num();
+    Writer << Magic;
+    Writer << Version;
+    Writer << NumEntries;
+    for (TPair<FString, FKnownHost> &Host : Hosts){
+        SerializeHost(Writer, Host.Value);
+    }
+    // Write next to the file and move it over, so that a crash while saving doesn't leave a truncated file behind
+    const FString TempFilePath = FilePath + TEXT(".tmp");
+    if (!FFileHelper::SaveArrayToFile(FileData, *TempFilePath) || !IFileManager::Get().Move(*FilePath, *TempFilePath, true, true)){
+        IFileManager::Get().Delete(*TempFilePath, false, false, true);
+        return false;
+    }
+    bIsDirty = false;
+    return true;
+}
+
+
+FString FSessionKnownHosts::GetDefaultFilePath(){
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MultiplayerSessions"), TEXT("KnownHosts.bin"));
+}
+
+
+/*
+Entries
+*/
+void FSessionKnownHosts::RecordJoin(const FString &SessionId, const FString &ConnectString, const FString &MatchType, float RttMs){
+    if (SessionId.IsEmpty()){
+        return;
+    }
+    FKnownHost &Host = Hosts.FindOrAdd(SessionId);
+    Host.SessionId = SessionId;
+    Host.ConnectString = ConnectString;
+    Host.MatchType = MatchType;
+    // Keep the last measurement if there is no new one
+    if (RttMs >= 0.f){
+        Host.LastRttMs = RttMs;
+    }
+    Host.Timestamp = GetUnixTime();
+    bIsDirty = true;
+    Prune();
+}
+
+
+bool FSessionKnownHosts::RecordSeen(const FString &SessionId, float RttMs){
+    FKnownHost *Host = Hosts.Find(SessionId);
+    if (Host == nullptr){
+        return false;
+    }
+    if (RttMs >= 0.f){
+        Host->LastRttMs = RttMs;
+    }
+    Host->Timestamp = GetUnixTime();
+    bIsDirty = true;
+    return true;
+}
+
+
+void FSessionKnownHosts::Forget(const FString &SessionId){
+    if (Hosts.Remove(SessionId) > 0){
+        bIsDirty = true;
+    }
+}
+
+
+void FSessionKnownHosts::Reset(){
+    if (Hosts.Num() > 0){
+        Hosts.Reset();
+        bIsDirty = true;
+    }
+}
+
+
+void FSessionKnownHosts::GetHosts(const FString &MatchType, TArray<FKnownHost> &OutHosts) const{
+    OutHosts.Reset();
+    const int64 OldestTimestamp = GetUnixTime() - MaxAgeSeconds;
+    for (const TPair<FString, FKnownHost> &Host : Hosts){
+        if (Host.Value.Timestamp >= OldestTimestamp && (MatchType.IsEmpty() || Host.Value.MatchType == MatchType)){
+            OutHosts.Add(Host.Value);
+        }
+    }
+    OutHosts.Sort([](const FKnownHost &A, const FKnownHost &B){ return A.Timestamp > B.Timestamp; });
+}
+
+
+void FSessionKnownHosts::GetSessionIds(TSet<FString> &OutSessionIds) const{
+    OutSessionIds.Reset();
+    for (const TPair<FString, FKnownHost> &Host : Hosts){
+        OutSessionIds.Add(Host.Key);
+    }
+}
+
+
+void FSessionKnownHosts::Prune(){
+    const int64 OldestTimestamp = GetUnixTime() - MaxAgeSeconds;
+    const int32 NumBefore = Hosts.Num();
+    for (auto It = Hosts.CreateIterator(); It; ++It){
+        if (It->Value.Timestamp < OldestTimestamp){
+            It.RemoveCurrent();
+        }
+    }
+    // Drop the least recently used sessions beyond the limit
+    if (Hosts.Num() > MaxHosts){
+        Hosts.ValueSort([](const FKnownHost &A, const FKnownHost &B){ return A.Timestamp > B.Timestamp; });
+        int32 Index = 0;
+        for (auto It = Hosts.CreateIterator(); It; ++It, ++Index){
+            if (Index >= MaxHosts){
+                It.RemoveCurrent();
+            }
+        }
+    }
+    bIsDirty |= Hosts.Num() != NumBefore;
+}
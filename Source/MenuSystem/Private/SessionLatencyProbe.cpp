@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionLatencyProbe.h"
+
+#include "Async/Async.h"
+#include "Common/UdpSocketBuilder.h"
+#include "HAL/RunnableThread.h"
+#include "IPAddress.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+
+namespace
+{
+    // Magic number at the start of a probe sent by a client
+    const uint32 ProbeRequestMagic = 0x4D535051; // 'MSPQ'
+    // Magic number at the start of a probe echoed by a responder
+    const uint32 ProbeReplyMagic = 0x4D535052; // 'MSPR'
+
+    /*
+    Layout of a probe datagram, the responder echoes it back unchanged except for the magic number
+    */
+    struct FProbePacket{
+        uint32 Magic;
+        uint32 Sequence;
+        double SendTime;
+    };
+}
+
+
+/*
+FSessionProbeResponder
+*/
+FSessionProbeResponder::~FSessionProbeResponder(){
+    Shutdown();
+}
+
+
+bool FSessionProbeResponder::Start(int32 Port){
+    if (IsRunning()){
+        return true;
+    }
+    Socket = FUdpSocketBuilder(TEXT("SessionProbeResponder"))
+        .AsNonBlocking()
+        .AsReusable()
+        .BoundToPort(Port)
+        .Build();
+    if (Socket == nullptr){
+        return false;
+    }
+    // Read back the port in case a free one was picked
+    BoundPort = Socket->GetPortNo();
+    bIsStopping = false;
+    Thread = FRunnableThread::Create(this, TEXT("SessionProbeResponder"), 0, TPri_AboveNormal);
+    if (Thread == nullptr){
+        Shutdown();
+        return false;
+    }
+    return true;
+}
+
+
+void FSessionProbeResponder::Shutdown(){
+    if (Thread){
+        // Kill calls Stop and waits for Run to return
+        Thread->Kill(true);
+        delete Thread;
+        Thread = nullptr;
+    }
+    if (Socket){
+        Socket->Close();
+        ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+        Socket = nullptr;
+    }
+    BoundPort = 0;
+}
+
+
+uint32 FSessionProbeResponder::Run(){
+    ISocketSubsystem *SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+    TSharedRef<FInternetAddr> Sender = SocketSubsystem->CreateInternetAddr();
+    uint8 Buffer[256];
+    while (!bIsStopping){
+        // Wake up regularly to check whether the responder is stopping
+        if (!Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromMilliseconds(100))){
+            continue;
+        }
+        // Drain every datagram that has arrived
+        int32 BytesRead = 0;
+        while (Socket->RecvFrom(Buffer, sizeof(Buffer), BytesRead, *Sender)){
+            const int32 BytesToSend = HandleDatagram(Buffer, BytesRead, sizeof(Buffer), *Sender);
+            if (BytesToSend > 0){
+                int32 BytesSent = 0;
+                Socket->SendTo(Buffer, BytesToSend, BytesSent, *Sender);
+            }
+        }
+    }
+    return 0;
+}
+
+
+void FSessionProbeResponder::Stop(){
+    bIsStopping = true;
+}
+
+
+int32 FSessionProbeResponder::HandleDatagram(uint8 *Data, int32 NumBytes, int32 BufferSize, const FInternetAddr &Sender){
+    // Only echo well-formed probes, and never more bytes than were received
+    if (NumBytes != sizeof(FProbePacket)){
+        return 0;
+    }
+    FProbePacket Packet;
+    FMemory::Memcpy(&Packet, Data, sizeof(FProbePacket));
+    if (Packet.Magic != ProbeRequestMagic){
+        return 0;
+    }
+    Packet.Magic = ProbeReplyMagic;
+    FMemory::Memcpy(Data, &Packet, sizeof(FProbePacket));
+    return sizeof(FProbePacket);
+}
+
+
+/*
+FSessionLatencyProber
+*/
+void FSessionLatencyProber::ProbeTargets(const TArray<FSessionProbeTarget> &Targets, int32 NumProbes, float TimeoutSeconds, TFunction<void(const TArray<FSessionProbeResult>&)> OnComplete){
+    if (Targets.Num() == 0){
+        OnComplete(TArray<FSessionProbeResult>());
+        return;
+    }
+    // A single worker task probes every target, so that a batch ties up one pool thread however many hosts it probes
+    Async(EAsyncExecution::ThreadPool, [Targets, NumProbes, TimeoutSeconds, OnComplete = MoveTemp(OnComplete)]() mutable{
+        TArray<FSessionProbeResult> Results = ProbeTargetsOnThisThread(Targets, NumProbes, TimeoutSeconds);
+        AsyncTask(ENamedThreads::GameThread, [Results = MoveTemp(Results), OnComplete = MoveTemp(OnComplete)](){
+            OnComplete(Results);
+        });
+    });
+}
+
+
+FSessionProbeResult FSessionLatencyProber::ProbeTarget(const FSessionProbeTarget &Target, int32 NumProbes, float TimeoutSeconds){
+    return ProbeTargetsOnThisThread({Target}, NumProbes, TimeoutSeconds)[0];
+}
+
+
+TArray<FSessionProbeResult> FSessionLatencyProber::ProbeTargetsOnThisThread(const TArray<FSessionProbeTarget> &Targets, int32 NumProbes, float TimeoutSeconds){
+    TArray<FSessionProbeResult> Results;
+    Results.SetNum(Targets.Num());
+    // Every probe carries the index of its target and its own number, which the responder echoes back
+    if (NumProbes <= 0 || static_cast<int64>(Targets.Num()) * NumProbes > MAX_uint32){
+        return Results;
+    }
+    ISocketSubsystem *SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+
+    // One socket per protocol (IPv4 and IPv6) sends the bursts to every target up front
+    TMap<FName, FSocket*, TInlineSetAllocator<2>> Sockets;
+    int32 NumSent = 0;
+    for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex){
+        const FSessionProbeTarget &Target = Targets[TargetIndex];
+        if (!Target.Address.IsValid()){
+            continue;
+        }
+        const FName ProtocolType = Target.Address->GetProtocolType();
+        FSocket *Socket = Sockets.FindRef(ProtocolType);
+        if (Socket == nullptr){
+            Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("SessionProbe"), ProtocolType);
+            if (Socket == nullptr){
+                continue;
+            }
+            Socket->SetNonBlocking(true);
+            Sockets.Add(ProtocolType, Socket);
+        }
+        for (int32 Sequence = 0; Sequence < NumProbes; ++Sequence){
+            FProbePacket Packet{ProbeRequestMagic, static_cast<uint32>(TargetIndex * NumProbes + Sequence), FPlatformTime::Seconds()};
+            int32 BytesSent = 0;
+            Socket->SendTo(reinterpret_cast<const uint8*>(&Packet), sizeof(FProbePacket), BytesSent, *Target.Address);
+        }
+        NumSent += NumProbes;
+    }
+
+    // Collect the echoes until all of them are back or the timeout has passed
+    const int32 NumExpected = Targets.Num() * NumProbes;
+    int32 NumReceived = 0;
+    TArray<TArray<float, TInlineAllocator<16>>> RoundTrips;
+    RoundTrips.SetNum(Targets.Num());
+    TBitArray<> bIsReceived(false, NumExpected);
+    TSharedRef<FInternetAddr> Sender = SocketSubsystem->CreateInternetAddr();
+    const double Deadline = FPlatformTime::Seconds() + TimeoutSeconds;
+    while (NumReceived < NumSent){
+        const double Remaining = Deadline - FPlatformTime::Seconds();
+        if (Remaining <= 0.0){
+            break;
+        }
+        for (const TPair<FName, FSocket*> &Pair : Sockets){
+            // With a socket per protocol, wait on each in turn for a short while only
+            const double WaitSeconds = Sockets.Num() > 1 ? FMath::Min(Remaining, 0.005) : Remaining;
+            if (!Pair.Value->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(WaitSeconds))){
+                continue;
+            }
+            FProbePacket Packet;
+            int32 BytesRead = 0;
+            while (Pair.Value->RecvFrom(reinterpret_cast<uint8*>(&Packet), sizeof(FProbePacket), BytesRead, *Sender)){
+                // Ignore anything that isn't an echo of one of our probes from its target, and duplicates
+                if (BytesRead != sizeof(FProbePacket) || Packet.Magic != ProbeReplyMagic || Packet.Sequence >= static_cast<uint32>(NumExpected) || bIsReceived[Packet.Sequence]){
+                    continue;
+                }
+                const int32 TargetIndex = Packet.Sequence / NumProbes;
+                if (!Targets[TargetIndex].Address.IsValid() || !Sender->CompareEndpoints(*Targets[TargetIndex].Address)){
+                    continue;
+                }
+                bIsReceived[Packet.Sequence] = true;
+                RoundTrips[TargetIndex].Add(static_cast<float>((FPlatformTime::Seconds() - Packet.SendTime) * 1000.0));
+                ++NumReceived;
+            }
+        }
+    }
+    for (const TPair<FName, FSocket*> &Pair : Sockets){
+        Pair.Value->Close();
+        SocketSubsystem->DestroySocket(Pair.Value);
+    }
+
+    /*
+    Summarize the round trips of each target
+    */
+    for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex){
+        const TArray<float, TInlineAllocator<16>> &TargetRoundTrips = RoundTrips[TargetIndex];
+        if (TargetRoundTrips.Num() == 0){
+            continue;
+        }
+        FSessionProbeResult &Result = Results[TargetIndex];
+        Result.bWasReachable = true;
+        Result.LossRatio = 1.f - static_cast<float>(TargetRoundTrips.Num()) / NumProbes;
+        float Sum = 0.f;
+        float JitterSum = 0.f;
+        for (int32 Index = 0; Index < TargetRoundTrips.Num(); ++Index){
+            Sum += TargetRoundTrips[Index];
+            if (Index > 0){
+                JitterSum += FMath::Abs(TargetRoundTrips[Index] - TargetRoundTrips[Index - 1]);
+            }
+        }
+        Result.RoundTripMs = Sum / TargetRoundTrips.Num();
+        Result.JitterMs = TargetRoundTrips.Num() > 1 ? JitterSum / (TargetRoundTrips.Num() - 1) : 0.f;
+    }
+    return Results;
+}
+
+
+TSharedPtr<FInternetAddr> FSessionLatencyProber::MakeProbeAddress(const FString &ConnectString, int32 ProbePort){
+    if (ProbePort <= 0){
+        return nullptr;
+    }
+    // Strip the game port, and the brackets around IPv6 addresses
+    FString Host = ConnectString;
+    if (Host.StartsWith(TEXT("["))){
+        const int32 ClosingBracket = Host.Find(TEXT("]"));
+        Host = ClosingBracket != INDEX_NONE ? Host.Mid(1, ClosingBracket - 1) : Host.Mid(1);
+    }
+    else{
+        int32 FirstColon, LastColon;
+        // A single colon separates the port of an IPv4 address or host name
+        if (Host.FindChar(TEXT(':'), FirstColon) && Host.FindLastChar(TEXT(':'), LastColon) && FirstColon == LastColon){
+            Host.LeftInline(FirstColon);
+        }
+    }
+    // Connect strings of some backends (e.g. "steam.<id>") aren't IP addresses and can't be probed
+    bool bIsValid = false;
+    TSharedRef<FInternetAddr> Address = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+    Address->SetIp(*Host, bIsValid);
+    if (!bIsValid){
+        return nullptr;
+    }
+    Address->SetPort(ProbePort);
+    return Address;
+}
@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionMatchmaker.h"
+
+#include "Algo/BinarySearch.h"
+
+
+FSessionMatchmaker::FSessionMatchmaker(const FMatchmakingSettings &InSettings) :
+    Settings(InSettings){
+    Settings.SkillBandWidth = FMath::Max(Settings.SkillBandWidth, 1);
+    Settings.MaxSkillWidening = FMath::Max(Settings.MaxSkillWidening, 0);
+}
+
+
+FMatchmakingBucketKey FSessionMatchmaker::MakeKey(const FString &Region, const FString &MatchType, int32 Skill) const{
+    FMatchmakingBucketKey Key;
+    Key.Region = Region;
+    Key.MatchType = MatchType;
+    // Round towards negative infinity, so that band 0 doesn't cover twice the width
+    Key.SkillBand = FMath::FloorToInt(static_cast<float>(Skill) / Settings.SkillBandWidth);
+    return Key;
+}
+
+
+/*
+Open sessions
+*/
+void FSessionMatchmaker::AddOrUpdateSession(const FString &SessionId, const FString &Region, const FString &MatchType, int32 Skill, int32 OpenSlots){
+    FIndexedSession &Session = Sessions.FindOrAdd(SessionId);
+    RemoveFromBuckets(SessionId, Session);
+    Session.Key = MakeKey(Region, MatchType, Skill);
+    Session.OpenSlots = OpenSlots;
+    InsertIntoBuckets(SessionId, Session);
+}
+
+
+void FSessionMatchmaker::AddOrUpdateSession(const FOnlineSessionSearchResult &SearchResult){
+    const FOnlineSessionSettings &SessionSettings = SearchResult.Session.SessionSettings;
+    FString Region;
+    FString MatchType;
+    int32 Skill = 0;
+    SessionSettings.Get(FName("Region"), Region);
+    SessionSettings.Get(FName("MatchType"), MatchType);
+    SessionSettings.Get(FName("Skill"), Skill);
+    const FString SessionId = SearchResult.GetSessionIdStr();
+    AddOrUpdateSession(SessionId, Region, MatchType, Skill, SearchResult.Session.NumOpenPublicConnections);
+    Sessions[SessionId].SearchResult = SearchResult;
+}
+
+
+void FSessionMatchmaker::RemoveSession(const FString &SessionId){
+    if (const FIndexedSession *Session = Sessions.Find(SessionId)){
+        RemoveFromBuckets(SessionId, *Session);
+        Sessions.Remove(SessionId);
+    }
+}
+
+
+void FSessionMatchmaker::MarkSessionFull(const FString &SessionId){
+    FIndexedSession *Session = Sessions.Find(SessionId);
+    if (Session == nullptr){
+        return;
+    }
+    RemoveFromBuckets(SessionId, *Session);
+    Session->OpenSlots = 0;
+}
+
+
+const FOnlineSessionSearchResult *FSessionMatchmaker::GetSearchResult(const FString &SessionId) const{
+    const FIndexedSession *Session = Sessions.Find(SessionId);
+    return Session && Session->SearchResult.IsSet() ? &Session->SearchResult.GetValue() : nullptr;
+}
+
+
+void FSessionMatchmaker::InsertIntoBuckets(const FString &SessionId, const FIndexedSession &Session){
+    // A full session stays known (e.g. for the search result of an assignment) but can't be picked anymore
+    if (Session.OpenSlots <= 0){
+        return;
+    }
+    const FBucketEntry Entry{Session.OpenSlots, SessionId};
+    TArray<FBucketEntry> &Bucket = SessionBuckets.FindOrAdd(Session.Key);
+    Bucket.Insert(Entry, Algo::LowerBound(Bucket, Entry));
+    // Sessions that advertise no region are only in the bucket of every region
+    if (!Session.Key.Region.IsEmpty()){
+        FMatchmakingBucketKey AnyRegionKey = Session.Key;
+        AnyRegionKey.Region.Reset();
+        TArray<FBucketEntry> &AnyRegionBucket = SessionBuckets.FindOrAdd(AnyRegionKey);
+        AnyRegionBucket.Insert(Entry, Algo::LowerBound(AnyRegionBucket, Entry));
+    }
+}
+
+
+void FSessionMatchmaker::RemoveFromBuckets(const FString &SessionId, const FIndexedSession &Session){
+    if (Session.OpenSlots <= 0){
+        return;
+    }
+    const FBucketEntry Entry{Session.OpenSlots, SessionId};
+    auto RemoveEntry = [this, &Entry](const FMatchmakingBucketKey &Key){
+        TArray<FBucketEntry> *Bucket = SessionBuckets.Find(Key);
+        if (Bucket == nullptr){
+            return;
+        }
+        const int32 Index = Algo::BinarySearch(*Bucket, Entry);
+        if (Index != INDEX_NONE){
+            Bucket->RemoveAt(Index);
+        }
+        // Keep the map from filling up with the buckets of sessions that are gone
+        if (Bucket->Num() == 0){
+            SessionBuckets.Remove(Key);
+        }
+    };
+    RemoveEntry(Session.Key);
+    if (!Session.Key.Region.IsEmpty()){
+        FMatchmakingBucketKey AnyRegionKey = Session.Key;
+        AnyRegionKey.Region.Reset();
+        RemoveEntry(AnyRegionKey);
+    }
+}
+
+
+const FSessionMatchmaker::FBucketEntry *FSessionMatchmaker::FindInBucket(const FMatchmakingBucketKey &Key) const{
+    const TArray<FBucketEntry> *Bucket = SessionBuckets.Find(Key);
+    return Bucket && Bucket->Num() > 0 ? &(*Bucket)[0] : nullptr;
+}
+
+
+void FSessionMatchmaker::ReserveSlot(const FString &SessionId){
+    FIndexedSession *Session = Sessions.Find(SessionId);
+    if (Session == nullptr){
+        return;
+    }
+    // Re-sort the session with one slot less, the next refresh from the backend overwrites the count again
+    RemoveFromBuckets(SessionId, *Session);
+    --Session->OpenSlots;
+    InsertIntoBuckets(SessionId, *Session);
+}
+
+
+/*
+Waiting players
+*/
+int64 FSessionMatchmaker::EnqueuePlayer(const FMatchmakingTicket &Ticket, double Now){
+    FWaitingPlayer &WaitingPlayer = WaitingPlayers.AddDefaulted_GetRef();
+    WaitingPlayer.TicketId = NextTicketId++;
+    WaitingPlayer.Ticket = Ticket;
+    WaitingPlayer.EnqueueTime = Now;
+    ++WaitingCounts.FindOrAdd(MakeKey(Ticket.Region, Ticket.MatchType, Ticket.Skill));
+    return WaitingPlayer.TicketId;
+}
+
+
+void FSessionMatchmaker::CancelPlayer(int64 TicketId){
+    const int32 Index = WaitingPlayers.IndexOfByPredicate([TicketId](const FWaitingPlayer &WaitingPlayer){
+        return WaitingPlayer.TicketId == TicketId;
+    });
+    if (Index == INDEX_NONE){
+        return;
+    }
+    const FMatchmakingTicket &Ticket = WaitingPlayers[Index].Ticket;
+    const FMatchmakingBucketKey Key = MakeKey(Ticket.Region, Ticket.MatchType, Ticket.Skill);
+    if (--WaitingCounts.FindChecked(Key) <= 0){
+        WaitingCounts.Remove(Key);
+    }
+    WaitingPlayers.RemoveAt(Index);
+}
+
+
+void FSessionMatchmaker::Tick(double Now, TArray<FMatchmakingAssignment> &OutAssignments){
+    // The players who have waited the longest get the slots first
+    int32 NumKept = 0;
+    for (int32 Index = 0; Index < WaitingPlayers.Num(); ++Index){
+        FWaitingPlayer &WaitingPlayer = WaitingPlayers[Index];
+        FString SessionId;
+        if (FindSession(WaitingPlayer.Ticket, static_cast<float>(Now - WaitingPlayer.EnqueueTime), SessionId)){
+            ReserveSlot(SessionId);
+            OutAssignments.Add(FMatchmakingAssignment{WaitingPlayer.TicketId, SessionId});
+            const FMatchmakingBucketKey Key = MakeKey(WaitingPlayer.Ticket.Region, WaitingPlayer.Ticket.MatchType, WaitingPlayer.Ticket.Skill);
+            if (--WaitingCounts.FindChecked(Key) <= 0){
+                WaitingCounts.Remove(Key);
+            }
+            continue;
+        }
+        // Compact the queue in place, keeping the order
+        if (NumKept != Index){
+            WaitingPlayers[NumKept] = MoveTemp(WaitingPlayer);
+        }
+        ++NumKept;
+    }
+    WaitingPlayers.RemoveAt(NumKept, WaitingPlayers.Num() - NumKept);
+}
+
+
+bool FSessionMatchmaker::FindSession(const FMatchmakingTicket &Ticket, float WaitSeconds, FString &OutSessionId) const{
+    const FMatchmakingBucketKey Key = MakeKey(Ticket.Region, Ticket.MatchType, Ticket.Skill);
+    // The search widens by one skill band on either side per interval
+    const int32 Widening = Settings.SkillWideningInterval > 0.f ? FMath::Min(FMath::FloorToInt(FMath::Max(WaitSeconds, 0.f) / Settings.SkillWideningInterval), Settings.MaxSkillWidening) : Settings.MaxSkillWidening;
+    // A player without a region looks at every region right away, the others once they have waited long enough
+    const bool bIsAnyRegion = !Key.Region.IsEmpty() && Settings.AnyRegionDelay >= 0.f && WaitSeconds >= Settings.AnyRegionDelay;
+    // Closer skill bands first, and within a band the own region first
+    for (int32 Distance = 0; Distance <= Widening; ++Distance){
+        for (int32 Side = Distance == 0 ? 1 : -1; Side <= 1; Side += 2){
+            FMatchmakingBucketKey BandKey = Key;
+            BandKey.SkillBand += Side * Distance;
+            const FBucketEntry *Entry = FindInBucket(BandKey);
+            if (Entry == nullptr && bIsAnyRegion){
+                BandKey.Region.Reset();
+                Entry = FindInBucket(BandKey);
+            }
+            if (Entry){
+                OutSessionId = Entry->SessionId;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+int32 FSessionMatchmaker::GetNumWaitingPlayers(const FMatchmakingTicket &Ticket) const{
+    const int32 *Count = WaitingCounts.Find(MakeKey(Ticket.Region, Ticket.MatchType, Ticket.Skill));
+    return Count ? *Count : 0;
+}
+
+
+void FSessionMatchmaker::Reset(){
+    Sessions.Reset();
+    SessionBuckets.Reset();
+    WaitingPlayers.Reset();
+    WaitingCounts.Reset();
+}
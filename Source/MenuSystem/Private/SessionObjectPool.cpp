@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionObjectPool.h"
+
+
+/*
+Search objects
+*/
+TSharedRef<FOnlineSessionSearch> FSessionObjectPool::AcquireSearch(bool &bOutWasReused){
+    // The backend keeps referencing the last search it ran, so take a pooled search only once nothing else holds it
+    for (int32 Index = 0; Index < Searches.Num(); ++Index){
+        if (Searches[Index].IsUnique()){
+            TSharedRef<FOnlineSessionSearch> Search = Searches[Index];
+            Searches.RemoveAtSwap(Index);
+            ResetSearch(*Search);
+            bOutWasReused = true;
+            return Search;
+        }
+    }
+    bOutWasReused = false;
+    return MakeShared<FOnlineSessionSearch>();
+}
+
+
+void FSessionObjectPool::ReleaseSearch(TSharedPtr<FOnlineSessionSearch> &Search){
+    if (Search.IsValid() && Searches.Num() < MaxPooledSearches){
+        Searches.Add(Search.ToSharedRef());
+    }
+    Search.Reset();
+}
+
+
+void FSessionObjectPool::ResetSearch(FOnlineSessionSearch &Search){
+    // Emptying the results keeps their allocation, the next search fills it up again
+    TArray<FOnlineSessionSearchResult> ResultStorage = MoveTemp(Search.SearchResults);
+    ResultStorage.Reset();
+    Search = FOnlineSessionSearch();
+    Search.SearchResults = MoveTemp(ResultStorage);
+}
+
+
+/*
+Settings objects
+*/
+TSharedRef<FOnlineSessionSettings> FSessionObjectPool::AcquireSettings(bool &bOutWasReused){
+    for (int32 Index = 0; Index < SettingsObjects.Num(); ++Index){
+        if (SettingsObjects[Index].IsUnique()){
+            TSharedRef<FOnlineSessionSettings> Settings = SettingsObjects[Index];
+            SettingsObjects.RemoveAtSwap(Index);
+            ResetSettings(*Settings);
+            bOutWasReused = true;
+            return Settings;
+        }
+    }
+    bOutWasReused = false;
+    return MakeShared<FOnlineSessionSettings>();
+}
+
+
+void FSessionObjectPool::ReleaseSettings(TSharedPtr<FOnlineSessionSettings> &Settings){
+    if (Settings.IsValid() && SettingsObjects.Num() < MaxPooledSettings){
+        SettingsObjects.Add(Settings.ToSharedRef());
+    }
+    Settings.Reset();
+}
+
+
+void FSessionObjectPool::ResetSettings(FOnlineSessionSettings &Settings){
+    // Same as for the search results, the settings map keeps its allocation
+    FSessionSettings SettingStorage = MoveTemp(Settings.Settings);
+    SettingStorage.Reset();
+    Settings = FOnlineSessionSettings();
+    Settings.Settings = MoveTemp(SettingStorage);
+}
+
+
+int64 FSessionObjectPool::GetRetainedResultBytes() const{
+    int64 Bytes = 0;
+    for (const TSharedRef<FOnlineSessionSearch> &Search : Searches){
+        Bytes += Search->SearchResults.GetAllocatedSize();
+    }
+    return Bytes;
+}
+
+
+void FSessionObjectPool::Reset(){
+    Searches.Empty();
+    SettingsObjects.Empty();
+}
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionRanking.h"
+
+#include "OnlineSessionSettings.h"
+
+
+namespace
+{
+    // Hash of an empty string, used for sessions that don't advertise a setting
+    const uint32 EmptyHash = 0;
+
+    // Function to hash an advertised string setting, returns EmptyHash if the session doesn't advertise it
+    uint32 HashSetting(const FOnlineSessionSettings &SessionSettings, FName Key){
+        FString Value;
+        if (!SessionSettings.Get(Key, Value) || Value.IsEmpty()){
+            return EmptyHash;
+        }
+        return GetTypeHash(Value);
+    }
+}
+
+
+void FSessionRankingTable::Build(TArrayView<const FOnlineSessionSearchResult> Results){
+    Reset();
+    const int32 NumRows = Results.Num();
+    Pings.SetNumUninitialized(NumRows);
+    OpenConnections.SetNumUninitialized(NumRows);
+    TotalConnections.SetNumUninitialized(NumRows);
+    BuildIds.SetNumUninitialized(NumRows);
+    MatchTypeHashes.SetNumUninitialized(NumRows);
+    RegionHashes.SetNumUninitialized(NumRows);
+    Scores.SetNumZeroed(NumRows);
+    for (int32 Row = 0; Row < NumRows; ++Row){
+        const FOnlineSessionSearchResult &Result = Results[Row];
+        const FOnlineSessionSettings &SessionSettings = Result.Session.SessionSettings;
+        // Backends report MAX_QUERY_PING or nothing when they couldn't measure the ping
+        Pings[Row] = Result.PingInMs > 0 && Result.PingInMs < MAX_QUERY_PING ? static_cast<float>(Result.PingInMs) : -1.f;
+        OpenConnections[Row] = static_cast<float>(Result.Session.NumOpenPublicConnections);
+        TotalConnections[Row] = static_cast<float>(SessionSettings.NumPublicConnections);
+        BuildIds[Row] = SessionSettings.BuildUniqueId;
+        MatchTypeHashes[Row] = HashSetting(SessionSettings, FName("MatchType"));
+        RegionHashes[Row] = HashSetting(SessionSettings, FName("Region"));
+    }
+}
+
+
+void FSessionRankingTable::Score(const FSessionRankingWeights &Weights, const FSessionRankingPreferences &Preferences){
+    const int32 NumRows = Num();
+    // Preferences turned into plain values so that the loop below has no branches on them
+    const uint32 PreferredMatchType = Preferences.MatchType.IsEmpty() ? EmptyHash : GetTypeHash(Preferences.MatchType);
+    const uint32 PreferredRegion = Preferences.Region.IsEmpty() ? EmptyHash : GetTypeHash(Preferences.Region);
+    const float MatchTypeMismatch = PreferredMatchType == EmptyHash ? 0.f : Weights.MatchTypeMismatch;
+    const float RegionMatch = PreferredRegion == EmptyHash ? 0.f : Weights.RegionMatch;
+    const float BuildMismatch = Preferences.BuildUniqueId == 0 ? 0.f : Weights.BuildMismatch;
+
+    const float *RESTRICT PingData = Pings.GetData();
+    const float *RESTRICT OpenData = OpenConnections.GetData();
+    const float *RESTRICT TotalData = TotalConnections.GetData();
+    const int32 *RESTRICT BuildData = BuildIds.GetData();
+    const uint32 *RESTRICT MatchTypeData = MatchTypeHashes.GetData();
+    const uint32 *RESTRICT RegionData = RegionHashes.GetData();
+    float *RESTRICT ScoreData = Scores.GetData();
+    for (int32 Row = 0; Row < NumRows; ++Row){
+        const float Ping = PingData[Row] < 0.f ? Weights.UnknownPing : PingData[Row];
+        const float Total = FMath::Max(TotalData[Row], 1.f);
+        const float FillRatio = (Total - OpenData[Row]) / Total;
+        ScoreData[Row] =
+            - Weights.Ping * Ping
+            + Weights.FillRatio * FillRatio
+            + (RegionData[Row] == PreferredRegion ? RegionMatch : 0.f)
+            - (MatchTypeData[Row] != PreferredMatchType ? MatchTypeMismatch : 0.f)
+            - (BuildData[Row] != Preferences.BuildUniqueId ? BuildMismatch : 0.f)
+            - (OpenData[Row] <= 0.f ? Weights.NoOpenSlots : 0.f);
+    }
+}
+
+
+void FSessionRankingTable::GetTopK(int32 K, TArray<int32> &OutResultIndices) const{
+    OutResultIndices.Reset();
+    K = FMath::Min(K, Num());
+    if (K <= 0){
+        return;
+    }
+    // Keep the K best rows in a min-heap on the score, so that the worst of them is on top and gets replaced first
+    const float *ScoreData = Scores.GetData();
+    auto IsWorse = [ScoreData](int32 A, int32 B){ return ScoreData[A] < ScoreData[B]; };
+    OutResultIndices.Reserve(K);
+    for (int32 Row = 0; Row < Num(); ++Row){
+        if (OutResultIndices.Num() < K){
+            OutResultIndices.HeapPush(Row, IsWorse);
+        }
+        else if (ScoreData[Row] > ScoreData[OutResultIndices.HeapTop()]){
+            OutResultIndices.HeapPopDiscard(IsWorse);
+            OutResultIndices.HeapPush(Row, IsWorse);
+        }
+    }
+    // Best first
+    OutResultIndices.Sort([ScoreData](int32 A, int32 B){ return ScoreData[A] > ScoreData[B]; });
+}
+
+
+void FSessionRankingTable::Reset(){
+    Pings.Reset();
+    OpenConnections.Reset();
+    TotalConnections.Reset();
+    BuildIds.Reset();
+    MatchTypeHashes.Reset();
+    RegionHashes.Reset();
+    Scores.Reset();
+}
@@ -0,0 +1,262 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionReservationBeacon.h"
+
+#include "Async/Async.h"
+#include "Hash/CityHash.h"
+#include "IPAddress.h"
+#include "Misc/Guid.h"
+#include "Misc/ScopeLock.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+
+namespace
+{
+    // Magic number at the start of a reservation request sent by a client
+    const uint32 ReservationRequestMagic = 0x4D535251; // 'MSRQ'
+    // Magic number at the start of the answer of a responder
+    const uint32 ReservationReplyMagic = 0x4D535252; // 'MSRR'
+
+    /*
+    Layout of a reservation request
+    */
+    struct FReservationRequestPacket{
+        uint32 Magic;
+        uint32 Op;
+        uint64 ReservationId;
+        uint64 SessionKey;
+    };
+
+    /*
+    Layout of the answer, it echoes the reservation id so that the client can match it to its request
+    */
+    struct FReservationReplyPacket{
+        uint32 Magic;
+        uint32 Result;
+        uint64 ReservationId;
+        int32 OpenSlots;
+        int32 MaxSlots;
+        float HoldSeconds;
+        uint32 Padding;
+    };
+}
+
+
+/*
+FSessionReservationResponder
+*/
+void FSessionReservationResponder::SetSessionCapacity(uint64 SessionKey, int32 MaxSlots, int32 NumOccupied){
+    FScopeLock Lock(&Mutex);
+    FReservableSession &Session = Sessions.FindOrAdd(SessionKey);
+    ExpireReservations(Session, FPlatformTime::Seconds());
+    // Every player that arrived since the last update takes up a held slot, the oldest reservation being the most likely to have turned into a player
+    int32 NumArrived = NumOccupied - Session.NumOccupied;
+    if (NumArrived > 0 && Session.Reservations.Num() > 0){
+        // Sort once by expiry time, the oldest reservations then come first
+        Session.Reservations.ValueSort([](const FHeldSlot &A, const FHeldSlot &B){ return A.ExpiryTime < B.ExpiryTime; });
+        for (auto It = Session.Reservations.CreateIterator(); It && NumArrived > 0; ++It){
+            It.RemoveCurrent();
+            --NumArrived;
+        }
+    }
+    Session.MaxSlots = MaxSlots;
+    Session.NumOccupied = NumOccupied;
+}
+
+
+void FSessionReservationResponder::RemoveSession(uint64 SessionKey){
+    FScopeLock Lock(&Mutex);
+    Sessions.Remove(SessionKey);
+}
+
+
+int32 FSessionReservationResponder::GetOpenSlots(uint64 SessionKey){
+    FScopeLock Lock(&Mutex);
+    FReservableSession *Session = Sessions.Find(SessionKey);
+    if (Session == nullptr){
+        return -1;
+    }
+    ExpireReservations(*Session, FPlatformTime::Seconds());
+    return CountOpenSlots(*Session);
+}
+
+
+void FSessionReservationResponder::SetHoldSeconds(float Seconds){
+    FScopeLock Lock(&Mutex);
+    HoldSeconds = FMath::Max(Seconds, 1.f);
+}
+
+
+void FSessionReservationResponder::SetMaxReservationsPerAddress(int32 MaxReservations){
+    FScopeLock Lock(&Mutex);
+    MaxReservationsPerAddress = FMath::Max(MaxReservations, 0);
+}
+
+
+int32 FSessionReservationResponder::HandleDatagram(uint8 *Data, int32 NumBytes, int32 BufferSize, const FInternetAddr &Sender){
+    // Anything that isn't a reservation request is left to the probe responder
+    if (NumBytes != sizeof(FReservationRequestPacket) || BufferSize < static_cast<int32>(sizeof(FReservationReplyPacket))){
+        return FSessionProbeResponder::HandleDatagram(Data, NumBytes, BufferSize, Sender);
+    }
+    FReservationRequestPacket Request;
+    FMemory::Memcpy(&Request, Data, sizeof(FReservationRequestPacket));
+    if (Request.Magic != ReservationRequestMagic || Request.Op > static_cast<uint32>(ESessionReservationOp::Query)){
+        return FSessionProbeResponder::HandleDatagram(Data, NumBytes, BufferSize, Sender);
+    }
+    // Reservations are counted per IP address, the port is left out since a client can pick any
+    const TArray<uint8> RawIp = Sender.GetRawIp();
+    const uint64 AddressHash = CityHash64(reinterpret_cast<const char*>(RawIp.GetData()), RawIp.Num());
+
+    FReservationReplyPacket Reply{ReservationReplyMagic, static_cast<uint32>(ESessionReservationResult::UnknownSession), Request.ReservationId, -1, -1, 0.f, 0};
+    {
+        FScopeLock Lock(&Mutex);
+        Reply.HoldSeconds = HoldSeconds;
+        FReservableSession *Session = Sessions.Find(Request.SessionKey);
+        if (Session){
+            const double Now = FPlatformTime::Seconds();
+            ExpireReservations(*Session, Now);
+            Reply.Result = static_cast<uint32>(ESessionReservationResult::Granted);
+            switch (static_cast<ESessionReservationOp>(Request.Op)){
+                case ESessionReservationOp::Reserve:
+                    // A retransmitted request finds its reservation and only extends it
+                    if (FHeldSlot *HeldSlot = Session->Reservations.Find(Request.ReservationId)){
+                        HeldSlot->ExpiryTime = Now + HoldSeconds;
+                    }
+                    // An address that holds its share of the slots is turned away as if the session were full
+                    else if (CountOpenSlots(*Session) > 0 && (MaxReservationsPerAddress == 0 || CountAddressReservations(*Session, AddressHash) < MaxReservationsPerAddress)){
+                        Session->Reservations.Add(Request.ReservationId, FHeldSlot{Now + HoldSeconds, AddressHash});
+                    }
+                    else{
+                        Reply.Result = static_cast<uint32>(ESessionReservationResult::Full);
+                    }
+                    break;
+                case ESessionReservationOp::Cancel:
+                    Session->Reservations.Remove(Request.ReservationId);
+                    break;
+                case ESessionReservationOp::Query:
+                    break;
+            }
+            Reply.OpenSlots = CountOpenSlots(*Session);
+            Reply.MaxSlots = Session->MaxSlots;
+        }
+    }
+    FMemory::Memcpy(Data, &Reply, sizeof(FReservationReplyPacket));
+    return sizeof(FReservationReplyPacket);
+}
+
+
+void FSessionReservationResponder::ExpireReservations(FReservableSession &Session, double Now){
+    for (auto It = Session.Reservations.CreateIterator(); It; ++It){
+        if (It->Value.ExpiryTime <= Now){
+            It.RemoveCurrent();
+        }
+    }
+}
+
+
+int32 FSessionReservationResponder::CountOpenSlots(const FReservableSession &Session){
+    return FMath::Max(Session.MaxSlots - Session.NumOccupied - Session.Reservations.Num(), 0);
+}
+
+
+int32 FSessionReservationResponder::CountAddressReservations(const FReservableSession &Session, uint64 AddressHash){
+    int32 Count = 0;
+    for (const TPair<uint64, FHeldSlot> &Reservation : Session.Reservations){
+        if (Reservation.Value.AddressHash == AddressHash){
+            ++Count;
+        }
+    }
+    return Count;
+}
+
+
+/*
+FSessionReservationClient
+*/
+void FSessionReservationClient::SendRequestAsync(const FSessionReservationRequest &Request, ESessionReservationOp Op, int32 NumAttempts, float TimeoutSeconds, TFunction<void(const FSessionReservationReply&)> OnComplete){
+    Async(EAsyncExecution::ThreadPool, [Request, Op, NumAttempts, TimeoutSeconds, OnComplete = MoveTemp(OnComplete)]() mutable{
+        const FSessionReservationReply Reply = SendRequest(Request, Op, NumAttempts, TimeoutSeconds);
+        AsyncTask(ENamedThreads::GameThread, [Reply, OnComplete = MoveTemp(OnComplete)](){
+            OnComplete(Reply);
+        });
+    });
+}
+
+
+FSessionReservationReply FSessionReservationClient::SendRequest(const FSessionReservationRequest &Request, ESessionReservationOp Op, int32 NumAttempts, float TimeoutSeconds){
+    FSessionReservationReply Reply;
+    if (!Request.Address.IsValid() || NumAttempts <= 0){
+        return Reply;
+    }
+    ISocketSubsystem *SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+    FSocket *Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("SessionReservation"), Request.Address->GetProtocolType());
+    if (Socket == nullptr){
+        return Reply;
+    }
+    Socket->SetNonBlocking(true);
+
+    // The request is resent when no answer comes back within its share of the timeout, the host answers retransmits the same way
+    const FReservationRequestPacket Packet{ReservationRequestMagic, static_cast<uint32>(Op), Request.ReservationId, Request.SessionKey};
+    const double AttemptSeconds = TimeoutSeconds / NumAttempts;
+    TSharedRef<FInternetAddr> Sender = SocketSubsystem->CreateInternetAddr();
+    bool bWasAnswered = false;
+    for (int32 Attempt = 0; Attempt < NumAttempts && !bWasAnswered; ++Attempt){
+        int32 BytesSent = 0;
+        Socket->SendTo(reinterpret_cast<const uint8*>(&Packet), sizeof(FReservationRequestPacket), BytesSent, *Request.Address);
+        const double Deadline = FPlatformTime::Seconds() + AttemptSeconds;
+        while (!bWasAnswered){
+            const double Remaining = Deadline - FPlatformTime::Seconds();
+            if (Remaining <= 0.0 || !Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(Remaining))){
+                break;
+            }
+            FReservationReplyPacket ReplyPacket;
+            int32 BytesRead = 0;
+            while (Socket->RecvFrom(reinterpret_cast<uint8*>(&ReplyPacket), sizeof(FReservationReplyPacket), BytesRead, *Sender)){
+                // Ignore anything that isn't the answer to this request
+                if (BytesRead != sizeof(FReservationReplyPacket) || ReplyPacket.Magic != ReservationReplyMagic || ReplyPacket.ReservationId != Request.ReservationId || ReplyPacket.Result >= static_cast<uint32>(ESessionReservationResult::Unreachable) || !Sender->CompareEndpoints(*Request.Address)){
+                    continue;
+                }
+                Reply.Result = static_cast<ESessionReservationResult>(ReplyPacket.Result);
+                Reply.OpenSlots = ReplyPacket.OpenSlots;
+                Reply.MaxSlots = ReplyPacket.MaxSlots;
+                Reply.HoldSeconds = ReplyPacket.HoldSeconds;
+                bWasAnswered = true;
+                break;
+            }
+        }
+    }
+    Socket->Close();
+    SocketSubsystem->DestroySocket(Socket);
+    return Reply;
+}
+
+
+void FSessionReservationClient::Cancel(const FSessionReservationRequest &Request){
+    if (!Request.Address.IsValid()){
+        return;
+    }
+    // A lost cancellation only means that the slot is held until the reservation expires
+    ISocketSubsystem *SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+    FSocket *Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("SessionReservation"), Request.Address->GetProtocolType());
+    if (Socket == nullptr){
+        return;
+    }
+    const FReservationRequestPacket Packet{ReservationRequestMagic, static_cast<uint32>(ESessionReservationOp::Cancel), Request.ReservationId, Request.SessionKey};
+    int32 BytesSent = 0;
+    Socket->SendTo(reinterpret_cast<const uint8*>(&Packet), sizeof(FReservationRequestPacket), BytesSent, *Request.Address);
+    Socket->Close();
+    SocketSubsystem->DestroySocket(Socket);
+}
+
+
+uint64 FSessionReservationClient::MakeSessionKey(const FString &SessionId){
+    const FTCHARToUTF8 Utf8SessionId(*SessionId);
+    return CityHash64(Utf8SessionId.Get(), Utf8SessionId.Length());
+}
+
+
+uint64 FSessionReservationClient::MakeReservationId(){
+    const FGuid Guid = FGuid::NewGuid();
+    return (static_cast<uint64>(Guid.A ^ Guid.C) << 32) | static_cast<uint64>(Guid.B ^ Guid.D);
+}
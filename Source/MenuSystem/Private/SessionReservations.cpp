@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionReservations.h"
+
+#include "OnlineSessionSettings.h"
+#include "SessionLatencyProbe.h"
+
+
+/*
+Host
+*/
+bool FSessionReservations::StartResponder(int32 Port){
+    if (!Responder.IsValid()){
+        Responder = MakeUnique<FSessionReservationResponder>();
+    }
+    Responder->SetHoldSeconds(HoldSeconds);
+    Responder->SetMaxReservationsPerAddress(MaxReservationsPerAddress);
+    return Responder->Start(Port);
+}
+
+
+void FSessionReservations::StopResponder(){
+    if (Responder.IsValid()){
+        Responder->Shutdown();
+        Responder.Reset();
+    }
+    HostedSessionKeys.Reset();
+}
+
+
+void FSessionReservations::SetHoldSeconds(float Seconds){
+    HoldSeconds = FMath::Max(Seconds, 1.f);
+    if (Responder.IsValid()){
+        Responder->SetHoldSeconds(HoldSeconds);
+    }
+}
+
+
+void FSessionReservations::SetMaxReservationsPerAddress(int32 MaxReservations){
+    MaxReservationsPerAddress = FMath::Max(MaxReservations, 0);
+    if (Responder.IsValid()){
+        Responder->SetMaxReservationsPerAddress(MaxReservationsPerAddress);
+    }
+}
+
+
+void FSessionReservations::UpdateHostedSession(FName SessionName, const FNamedOnlineSession *Session){
+    if (!IsResponderRunning()){
+        return;
+    }
+    // Only sessions that advertise reservations take them, i.e. those created while the responder was running
+    bool bTakesReservations = false;
+    if (Session == nullptr || !Session->SessionSettings.Get(FName("Reservations"), bTakesReservations) || !bTakesReservations){
+        RemoveHostedSession(SessionName);
+        return;
+    }
+    // A session created anew under the same name has another id
+    const uint64 SessionKey = FSessionReservationClient::MakeSessionKey(Session->GetSessionIdStr());
+    const uint64 *PreviousSessionKey = HostedSessionKeys.Find(SessionName);
+    if (PreviousSessionKey && *PreviousSessionKey != SessionKey){
+        Responder->RemoveSession(*PreviousSessionKey);
+    }
+    HostedSessionKeys.Add(SessionName, SessionKey);
+    // The backend counts the registered players, held slots come on top of them
+    const int32 MaxSlots = Session->SessionSettings.NumPublicConnections;
+    Responder->SetSessionCapacity(SessionKey, MaxSlots, FMath::Max(MaxSlots - Session->NumOpenPublicConnections, 0));
+}
+
+
+void FSessionReservations::RemoveHostedSession(FName SessionName){
+    uint64 SessionKey = 0;
+    if (HostedSessionKeys.RemoveAndCopyValue(SessionName, SessionKey) && Responder.IsValid()){
+        Responder->RemoveSession(SessionKey);
+    }
+}
+
+
+void FSessionReservations::RemoveHostedSessions(){
+    if (Responder.IsValid()){
+        for (const TPair<FName, uint64> &HostedSession : HostedSessionKeys){
+            Responder->RemoveSession(HostedSession.Value);
+        }
+    }
+    HostedSessionKeys.Reset();
+}
+
+
+int32 FSessionReservations::GetOpenSlots(FName SessionName){
+    const uint64 *SessionKey = HostedSessionKeys.Find(SessionName);
+    return SessionKey && Responder.IsValid() ? Responder->GetOpenSlots(*SessionKey) : -1;
+}
+
+
+/*
+Client
+*/
+void FSessionReservations::Configure(bool bInIsEnabled, int32 InNumAttempts, float InTimeoutSeconds){
+    bIsEnabled = bInIsEnabled;
+    NumAttempts = FMath::Max(InNumAttempts, 1);
+    TimeoutSeconds = FMath::Max(InTimeoutSeconds, 0.f);
+}
+
+
+bool FSessionReservations::Reserve(const IOnlineSessionPtr &SessionInterface, FName SessionName, const FOnlineSessionSearchResult &SessionResult, TFunction<void(const FSessionReservationReply&)> OnComplete){
+    // An answer to an earlier reservation doesn't concern this joint
+    FJoinReservation &JoinReservation = JoinReservations.FindOrAdd(SessionName);
+    const int32 Serial = ++JoinReservation.Serial;
+    JoinReservation.Request = FSessionReservationRequest();
+    if (!bIsEnabled || !SessionInterface.IsValid()){
+        return false;
+    }
+    // Only hosts that advertise reservations are asked, through the address of their probe responder
+    bool bTakesReservations = false;
+    int32 ProbePort = 0;
+    FString ConnectString;
+    if (!SessionResult.Session.SessionSettings.Get(FName("Reservations"), bTakesReservations) || !bTakesReservations || !SessionResult.Session.SessionSettings.Get(FName("ProbePort"), ProbePort) || !SessionInterface->GetResolvedConnectString(SessionResult, NAME_GamePort, ConnectString)){
+        return false;
+    }
+    FSessionReservationRequest Request;
+    Request.Address = FSessionLatencyProber::MakeProbeAddress(ConnectString, ProbePort);
+    if (!Request.Address.IsValid()){
+        return false;
+    }
+    Request.SessionKey = FSessionReservationClient::MakeSessionKey(SessionResult.GetSessionIdStr());
+    Request.ReservationId = FSessionReservationClient::MakeReservationId();
+    JoinReservation.Request = Request;
+    // The request is sent on a worker thread, the answer comes back on the game thread
+    TWeakPtr<FSessionReservations> WeakThis = AsShared();
+    FSessionReservationClient::SendRequestAsync(
+        Request,
+        ESessionReservationOp::Reserve,
+        NumAttempts,
+        TimeoutSeconds,
+        [WeakThis, SessionName, Serial, OnComplete = MoveTemp(OnComplete)](const FSessionReservationReply &Reply){
+            if (TSharedPtr<FSessionReservations> This = WeakThis.Pin()){
+                This->OnReserveComplete(SessionName, Serial, Reply, OnComplete);
+            }
+        }
+    );
+    return true;
+}
+
+
+void FSessionReservations::OnReserveComplete(FName SessionName, int32 Serial, const FSessionReservationReply &Reply, const TFunction<void(const FSessionReservationReply&)> &OnComplete){
+    FJoinReservation *JoinReservation = JoinReservations.Find(SessionName);
+    if (JoinReservation == nullptr || JoinReservation->Serial != Serial){
+        return;
+    }
+    // Only a granted slot has to be given back later on
+    if (Reply.Result != ESessionReservationResult::Granted){
+        JoinReservation->Request = FSessionReservationRequest();
+    }
+    if (OnComplete){
+        OnComplete(Reply);
+    }
+}
+
+
+void FSessionReservations::Keep(FName SessionName){
+    if (FJoinReservation *JoinReservation = JoinReservations.Find(SessionName)){
+        JoinReservation->Request = FSessionReservationRequest();
+    }
+}
+
+
+void FSessionReservations::Cancel(FName SessionName){
+    FJoinReservation *JoinReservation = JoinReservations.Find(SessionName);
+    if (JoinReservation == nullptr){
+        return;
+    }
+    // The answer to a reservation that is still on its way doesn't concern the joint anymore
+    ++JoinReservation->Serial;
+    if (JoinReservation->Request.Address.IsValid()){
+        FSessionReservationClient::Cancel(JoinReservation->Request);
+    }
+    JoinReservation->Request = FSessionReservationRequest();
+}
+
+
+void FSessionReservations::CancelAll(){
+    for (TPair<FName, FJoinReservation> &JoinReservation : JoinReservations){
+        Cancel(JoinReservation.Key);
+    }
+}
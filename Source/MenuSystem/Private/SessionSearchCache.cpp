@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionSearchCache.h"
+
+
+ESessionSearchCacheFreshness FSessionSearchCache::Find(const FSessionSearchQuery &Query, double Now, TSharedPtr<const TArray<FOnlineSessionSearchResult>> &OutResults){
+    const FEntry *Entry = Entries.Find(Query);
+    if (Entry == nullptr){
+        return ESessionSearchCacheFreshness::Missing;
+    }
+    const double Age = Now - Entry->Timestamp;
+    // Expired results are dropped
+    if (Age > FreshSeconds + StaleSeconds){
+        Entries.Remove(Query);
+        return ESessionSearchCacheFreshness::Missing;
+    }
+    OutResults = Entry->Results;
+    return Age <= FreshSeconds ? ESessionSearchCacheFreshness::Fresh : ESessionSearchCacheFreshness::Stale;
+}
+
+
+void FSessionSearchCache::Add(const FSessionSearchQuery &Query, TSharedRef<const TArray<FOnlineSessionSearchResult>> Results, double Now){
+    FEntry &Entry = Entries.Add(Query, FEntry{MoveTemp(Results)});
+    Entry.Timestamp = Now;
+}
+
+
+void FSessionSearchCache::RemoveSession(const FString &SessionId){
+    if (SessionId.IsEmpty()){
+        return;
+    }
+    for (auto It = Entries.CreateIterator(); It; ++It){
+        const TArray<FOnlineSessionSearchResult> &Results = *It->Value.Results;
+        const int32 Index = Results.IndexOfByPredicate([&SessionId](const FOnlineSessionSearchResult &SearchResult){
+            return SearchResult.GetSessionIdStr() == SessionId;
+        });
+        if (Index == INDEX_NONE){
+            continue;
+        }
+        // Subscribers may still hold the results, so the entry gets a copy without the session
+        TSharedRef<TArray<FOnlineSessionSearchResult>> RemainingResults = MakeShared<TArray<FOnlineSessionSearchResult>>(Results);
+        RemainingResults->RemoveAt(Index);
+        // Nothing left to serve, the next search asks the backend
+        if (RemainingResults->Num() == 0){
+            It.RemoveCurrent();
+            continue;
+        }
+        It->Value.Results = RemainingResults;
+    }
+}
+
+
+void FSessionSearchCache::Invalidate(){
+    Entries.Empty();
+}
+
+
+void FSessionSearchCache::SetTTL(float InFreshSeconds, float InStaleSeconds){
+    FreshSeconds = FMath::Max(InFreshSeconds, 0.f);
+    StaleSeconds = FMath::Max(InStaleSeconds, 0.f);
+}
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionSearchFilter.h"
+
+#include "OnlineSubsystemNames.h"
+#include "Online/OnlineSessionNames.h"
+
+
+namespace
+{
+    // Function to check whether the data type of a variant is numeric
+    bool IsNumeric(const FVariantData &Data){
+        switch (Data.GetType()){
+            case EOnlineKeyValuePairDataType::Int32:
+            case EOnlineKeyValuePairDataType::UInt32:
+            case EOnlineKeyValuePairDataType::Int64:
+            case EOnlineKeyValuePairDataType::UInt64:
+            case EOnlineKeyValuePairDataType::Float:
+            case EOnlineKeyValuePairDataType::Double:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Function to read a numeric variant as double
+    double ToDouble(const FVariantData &Data){
+        switch (Data.GetType()){
+            case EOnlineKeyValuePairDataType::Int32: { int32 Value; Data.GetValue(Value); return Value; }
+            case EOnlineKeyValuePairDataType::UInt32: { uint32 Value; Data.GetValue(Value); return Value; }
+            case EOnlineKeyValuePairDataType::Int64: { int64 Value; Data.GetValue(Value); return Value; }
+            case EOnlineKeyValuePairDataType::UInt64: { uint64 Value; Data.GetValue(Value); return Value; }
+            case EOnlineKeyValuePairDataType::Float: { float Value; Data.GetValue(Value); return Value; }
+            case EOnlineKeyValuePairDataType::Double: { double Value; Data.GetValue(Value); return Value; }
+            default: return 0.0;
+        }
+    }
+
+    // Function to compare an advertised setting with the value of a criterion, returns true for comparisons that can't be evaluated on the client
+    bool Compare(const FVariantData &SettingValue, const FVariantData &FilterValue, EOnlineComparisonOp::Type ComparisonOp){
+        // Negative means less than, zero means equal, positive means greater than
+        int32 Order;
+        if (IsNumeric(SettingValue) && IsNumeric(FilterValue)){
+            const double Difference = ToDouble(SettingValue) - ToDouble(FilterValue);
+            Order = Difference < 0.0 ? -1 : (Difference > 0.0 ? 1 : 0);
+        }
+        else if (SettingValue.GetType() == FilterValue.GetType()){
+            if (SettingValue.GetType() == EOnlineKeyValuePairDataType::String){
+                FString SettingString, FilterString;
+                SettingValue.GetValue(SettingString);
+                FilterValue.GetValue(FilterString);
+                Order = SettingString.Compare(FilterString);
+            }
+            else{
+                Order = SettingValue == FilterValue ? 0 : 1;
+            }
+        }
+        else{
+            // Values of different types never equal each other
+            return ComparisonOp == EOnlineComparisonOp::NotEquals;
+        }
+
+        switch (ComparisonOp){
+            case EOnlineComparisonOp::Equals: return Order == 0;
+            case EOnlineComparisonOp::NotEquals: return Order != 0;
+            case EOnlineComparisonOp::GreaterThan: return Order > 0;
+            case EOnlineComparisonOp::GreaterThanEquals: return Order >= 0;
+            case EOnlineComparisonOp::LessThan: return Order < 0;
+            case EOnlineComparisonOp::LessThanEquals: return Order <= 0;
+            default: return true; // Near and the like only affect the order of the results
+        }
+    }
+}
+
+
+void FSessionSearchFilter::ApplyToQuerySettings(FOnlineSearchSettings &QuerySettings) const{
+    if (!MatchType.IsEmpty()){
+        QuerySettings.Set( // Let the backend skip sessions of other match types
+            FName("MatchType"),
+            MatchType,
+            EOnlineComparisonOp::Equals
+        );
+    }
+    if (MinOpenSlots > 0){
+        QuerySettings.Set( // Let the backend skip sessions without enough open slots
+            SEARCH_MINSLOTSAVAILABLE, // Macro
+            MinOpenSlots,
+            EOnlineComparisonOp::GreaterThanEquals
+        );
+    }
+    for (const FSessionSettingFilter &SettingFilter : SettingFilters){
+        // Write the search param directly since FOnlineSearchSettings::Set isn't instantiated for FVariantData
+        if (FOnlineSessionSearchParam *SearchParam = QuerySettings.SearchParams.Find(SettingFilter.Key)){
+            SearchParam->Data = SettingFilter.Value;
+            SearchParam->ComparisonOp = SettingFilter.ComparisonOp;
+        }
+        else{
+            QuerySettings.SearchParams.Add(SettingFilter.Key, FOnlineSessionSearchParam(SettingFilter.Value, SettingFilter.ComparisonOp));
+        }
+    }
+}
+
+
+bool FSessionSearchFilter::Matches(const FOnlineSessionSearchResult &SearchResult, bool bBackendFiltersSettings) const{
+    const FOnlineSession &Session = SearchResult.Session;
+    // Integer criteria are cheap enough to always be checked
+    if (MinOpenSlots > 0 && Session.NumOpenPublicConnections < MinOpenSlots){
+        return false;
+    }
+    if (BuildUniqueId != 0 && Session.SessionSettings.BuildUniqueId != BuildUniqueId){
+        return false;
+    }
+    // Criteria on advertised settings have already been applied by backends which honour the query settings
+    if (bBackendFiltersSettings){
+        return true;
+    }
+    if (!MatchType.IsEmpty()){
+        FString SettingsValue;
+        // Check if it has a matching key value pair that we are looking for
+        if (!Session.SessionSettings.Get(FName("MatchType"), SettingsValue) || SettingsValue != MatchType){
+            return false;
+        }
+    }
+    for (const FSessionSettingFilter &SettingFilter : SettingFilters){
+        const FOnlineSessionSetting *Setting = Session.SessionSettings.Settings.Find(SettingFilter.Key);
+        // A session that doesn't advertise the setting can only satisfy a NotEquals criterion
+        if (Setting == nullptr){
+            if (SettingFilter.ComparisonOp != EOnlineComparisonOp::NotEquals){
+                return false;
+            }
+            continue;
+        }
+        if (!Compare(Setting->Data, SettingFilter.Value, SettingFilter.ComparisonOp)){
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool FSessionSearchFilter::DoesBackendFilterSettings(FName SubsystemName){
+    // Steam and EOS turn the query settings into lobby/session attribute filters, the Null subsystem ignores them
+    return SubsystemName == STEAM_SUBSYSTEM || SubsystemName == EOS_SUBSYSTEM;
+}
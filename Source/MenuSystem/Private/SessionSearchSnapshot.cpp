@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionSearchSnapshot.h"
+
+
+/*
+Result view
+*/
+const FVariantData *FSessionSearchResultView::FindSetting(FName Key) const{
+    const FOnlineSessionSetting *Setting = Result->Session.SessionSettings.Settings.Find(Key);
+    return Setting ? &Setting->Data : nullptr;
+}
+
+
+FString FSessionSearchResultView::GetMatchType() const{
+    FString MatchType;
+    if (const FVariantData *Data = FindSetting(FName("MatchType"))){
+        Data->GetValue(MatchType);
+    }
+    return MatchType;
+}
+
+
+/*
+Snapshot
+*/
+namespace{
+    // Storage of all empty snapshots, so that they don't allocate
+    const TSharedRef<const TArray<FOnlineSessionSearchResult>> &GetEmptyResults(){
+        static const TSharedRef<const TArray<FOnlineSessionSearchResult>> EmptyResults = MakeShared<TArray<FOnlineSessionSearchResult>>();
+        return EmptyResults;
+    }
+}
+
+
+FSessionSearchSnapshot::FSessionSearchSnapshot() :
+    Results(GetEmptyResults()){
+}
+
+
+FSessionSearchSnapshot::FSessionSearchSnapshot(TSharedRef<const TArray<FOnlineSessionSearchResult>> InResults) :
+    Results(MoveTemp(InResults)){
+    Count = Results->Num();
+}
+
+
+FSessionSearchSnapshot FSessionSearchSnapshot::Slice(int32 First, int32 SliceCount) const{
+    FSessionSearchSnapshot SliceSnapshot(*this);
+    SliceSnapshot.Offset = Offset + FMath::Clamp(First, 0, Count);
+    SliceSnapshot.Count = FMath::Clamp(SliceCount, 0, Count - (SliceSnapshot.Offset - Offset));
+    return SliceSnapshot;
+}
@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionStats.h"
+
+#include "OnlineSessionSettings.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+
+/*
+Stats, CSV categories and trace channels
+*/
+UE_TRACE_CHANNEL_DEFINE(MultiplayerSessionsChannel);
+
+CSV_DEFINE_CATEGORY(MultiplayerSessions, true);
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Create Latency (ms)"), STAT_SessionCreateLatency, STATGROUP_MultiplayerSessions);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Find Latency (ms)"), STAT_SessionFindLatency, STATGROUP_MultiplayerSessions);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Join Latency (ms)"), STAT_SessionJoinLatency, STATGROUP_MultiplayerSessions);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Destroy Latency (ms)"), STAT_SessionDestroyLatency, STATGROUP_MultiplayerSessions);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Start Latency (ms)"), STAT_SessionStartLatency, STATGROUP_MultiplayerSessions);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Update Latency (ms)"), STAT_SessionUpdateLatency, STATGROUP_MultiplayerSessions);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Succeeded Operations"), STAT_SessionSucceeded, STATGROUP_MultiplayerSessions);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Failed Operations"), STAT_SessionFailed, STATGROUP_MultiplayerSessions);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cancelled Operations"), STAT_SessionCancelled, STATGROUP_MultiplayerSessions);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Search Results"), STAT_SessionSearchResults, STATGROUP_MultiplayerSessions);
+DECLARE_MEMORY_STAT(TEXT("Search Payload"), STAT_SessionSearchPayload, STATGROUP_MultiplayerSessions);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Search Allocations"), STAT_SessionSearchAllocations, STATGROUP_MultiplayerSessions);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Settings Allocations"), STAT_SessionSettingsAllocations, STATGROUP_MultiplayerSessions);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Reuses"), STAT_SessionPooledReuses, STATGROUP_MultiplayerSessions);
+DECLARE_MEMORY_STAT(TEXT("Retained Result Storage"), STAT_SessionRetainedResultStorage, STATGROUP_MultiplayerSessions);
+
+TRACE_DECLARE_FLOAT_COUNTER(SessionCreateLatency, TEXT("MultiplayerSessions/CreateLatencyMs"));
+TRACE_DECLARE_FLOAT_COUNTER(SessionFindLatency, TEXT("MultiplayerSessions/FindLatencyMs"));
+TRACE_DECLARE_FLOAT_COUNTER(SessionJoinLatency, TEXT("MultiplayerSessions/JoinLatencyMs"));
+TRACE_DECLARE_FLOAT_COUNTER(SessionDestroyLatency, TEXT("MultiplayerSessions/DestroyLatencyMs"));
+TRACE_DECLARE_FLOAT_COUNTER(SessionStartLatency, TEXT("MultiplayerSessions/StartLatencyMs"));
+TRACE_DECLARE_FLOAT_COUNTER(SessionUpdateLatency, TEXT("MultiplayerSessions/UpdateLatencyMs"));
+
+
+namespace{
+    // Names of the kinds of operations, used for the Insights regions
+    const TCHAR *const OperationRegionNames[NumSessionOperationTypes] = {
+        TEXT("Session Create"),
+        TEXT("Session Find"),
+        TEXT("Session Join"),
+        TEXT("Session Destroy"),
+        TEXT("Session Start"),
+        TEXT("Session Update")
+    };
+
+    // Name of the Insights region of an operation. Regions are ended by name, so operations that overlap (one per session) need names of their own
+    FString MakeRegionName(ESessionOperationType Type, FName SessionName){
+        const TCHAR *OperationName = OperationRegionNames[static_cast<int32>(Type)];
+        return SessionName.IsNone() ? FString(OperationName) : FString::Printf(TEXT("%s (%s)"), OperationName, *SessionName.ToString());
+    }
+
+    // Publish the latency of a completed operation, every sink wants a name that is known at compile time
+    void PublishLatency(ESessionOperationType Type, float LatencyMs){
+        switch (Type){
+            case ESessionOperationType::Create:
+                SET_FLOAT_STAT(STAT_SessionCreateLatency, LatencyMs);
+                CSV_CUSTOM_STAT(MultiplayerSessions, CreateLatencyMs, LatencyMs, ECsvCustomStatOp::Set);
+                TRACE_COUNTER_SET(SessionCreateLatency, LatencyMs);
+                break;
+            case ESessionOperationType::Find:
+                SET_FLOAT_STAT(STAT_SessionFindLatency, LatencyMs);
+                CSV_CUSTOM_STAT(MultiplayerSessions, FindLatencyMs, LatencyMs, ECsvCustomStatOp::Set);
+                TRACE_COUNTER_SET(SessionFindLatency, LatencyMs);
+                break;
+            case ESessionOperationType::Join:
+                SET_FLOAT_STAT(STAT_SessionJoinLatency, LatencyMs);
+                CSV_CUSTOM_STAT(MultiplayerSessions, JoinLatencyMs, LatencyMs, ECsvCustomStatOp::Set);
+                TRACE_COUNTER_SET(SessionJoinLatency, LatencyMs);
+                break;
+            case ESessionOperationType::Destroy:
+                SET_FLOAT_STAT(STAT_SessionDestroyLatency, LatencyMs);
+                CSV_CUSTOM_STAT(MultiplayerSessions, DestroyLatencyMs, LatencyMs, ECsvCustomStatOp::Set);
+                TRACE_COUNTER_SET(SessionDestroyLatency, LatencyMs);
+                break;
+            case ESessionOperationType::Start:
+                SET_FLOAT_STAT(STAT_SessionStartLatency, LatencyMs);
+                CSV_CUSTOM_STAT(MultiplayerSessions, StartLatencyMs, LatencyMs, ECsvCustomStatOp::Set);
+                TRACE_COUNTER_SET(SessionStartLatency, LatencyMs);
+                break;
+            case ESessionOperationType::Update:
+                SET_FLOAT_STAT(STAT_SessionUpdateLatency, LatencyMs);
+                CSV_CUSTOM_STAT(MultiplayerSessions, UpdateLatencyMs, LatencyMs, ECsvCustomStatOp::Set);
+                TRACE_COUNTER_SET(SessionUpdateLatency, LatencyMs);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+
+/*
+Latency histogram
+*/
+const float FSessionLatencyHistogram::BucketBoundsMs[NumBuckets - 1] = {
+    1.f, 2.f, 5.f, 10.f, 20.f, 50.f, 100.f, 200.f, 500.f, 1000.f, 2000.f, 5000.f, 10000.f
+};
+
+
+void FSessionLatencyHistogram::AddSample(float LatencyMs){
+    int32 Bucket = 0;
+    while (Bucket < NumBuckets - 1 && LatencyMs > BucketBoundsMs[Bucket]){
+        ++Bucket;
+    }
+    ++BucketCounts[Bucket];
+    MinMs = NumSamples == 0 ? LatencyMs : FMath::Min(MinMs, LatencyMs);
+    MaxMs = NumSamples == 0 ? LatencyMs : FMath::Max(MaxMs, LatencyMs);
+    SumMs += LatencyMs;
+    ++NumSamples;
+}
+
+
+float FSessionLatencyHistogram::GetAverageMs() const{
+    return NumSamples > 0 ? static_cast<float>(SumMs / NumSamples) : 0.f;
+}
+
+
+float FSessionLatencyHistogram::GetPercentileMs(float Percentile) const{
+    if (NumSamples == 0){
+        return 0.f;
+    }
+    // Find the bucket that holds the requested rank and interpolate within it
+    const double Rank = FMath::Clamp(Percentile, 0.f, 100.f) * 0.01 * NumSamples;
+    uint32 NumBelow = 0;
+    for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket){
+        if (BucketCounts[Bucket] == 0 || NumBelow + BucketCounts[Bucket] < Rank){
+            NumBelow += BucketCounts[Bucket];
+            continue;
+        }
+        // The observed extremes are tighter than the outer bucket bounds
+        const float Lower = FMath::Max(Bucket > 0 ? BucketBoundsMs[Bucket - 1] : 0.f, MinMs);
+        const float Upper = FMath::Min(Bucket < NumBuckets - 1 ? BucketBoundsMs[Bucket] : MaxMs, MaxMs);
+        const double Alpha = (Rank - NumBelow) / BucketCounts[Bucket];
+        return FMath::Lerp(Lower, FMath::Max(Upper, Lower), static_cast<float>(Alpha));
+    }
+    return MaxMs;
+}
+
+
+/*
+Stats collector
+*/
+double FSessionStatsCollector::BeginOperation(ESessionOperationType Type, FName SessionName){
+    TRACE_BEGIN_REGION(*MakeRegionName(Type, SessionName));
+    return FPlatformTime::Seconds();
+}
+
+
+void FSessionStatsCollector::EndOperation(ESessionOperationType Type, double BeginTime, bool bWasSuccessful, int32 NumResults, int64 PayloadBytes, FName SessionName){
+    const int32 Index = static_cast<int32>(Type);
+    // Operations that never reached the backend have no latency
+    if (BeginTime < 0.0){
+        return;
+    }
+    const float LatencyMs = static_cast<float>((FPlatformTime::Seconds() - BeginTime) * 1000.0);
+    TRACE_END_REGION(*MakeRegionName(Type, SessionName));
+
+    /*
+    Record the outcome
+    */
+    FSessionOperationStats &Stats = Operations[Index];
+    Stats.Latency.AddSample(LatencyMs);
+    Stats.LastLatencyMs = LatencyMs;
+    if (bWasSuccessful){
+        ++Stats.NumSucceeded;
+        INC_DWORD_STAT(STAT_SessionSucceeded);
+    }
+    else{
+        ++Stats.NumFailed;
+        INC_DWORD_STAT(STAT_SessionFailed);
+    }
+    if (Type == ESessionOperationType::Find){
+        Stats.NumResults += NumResults;
+        Stats.LastNumResults = NumResults;
+        Stats.PayloadBytes += PayloadBytes;
+        SET_DWORD_STAT(STAT_SessionSearchResults, NumResults);
+        SET_MEMORY_STAT(STAT_SessionSearchPayload, PayloadBytes);
+        CSV_CUSTOM_STAT(MultiplayerSessions, SearchResults, NumResults, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(MultiplayerSessions, SearchPayloadBytes, static_cast<int32>(PayloadBytes), ECsvCustomStatOp::Set);
+    }
+    PublishLatency(Type, LatencyMs);
+    CSV_EVENT(MultiplayerSessions, TEXT("%s %s"), OperationRegionNames[Index], bWasSuccessful ? TEXT("Succeeded") : TEXT("Failed"));
+}
+
+
+void FSessionStatsCollector::CancelOperation(ESessionOperationType Type, double BeginTime, FName SessionName){
+    const int32 Index = static_cast<int32>(Type);
+    if (BeginTime < 0.0){
+        return;
+    }
+    TRACE_END_REGION(*MakeRegionName(Type, SessionName));
+    ++Operations[Index].NumCancelled;
+    INC_DWORD_STAT(STAT_SessionCancelled);
+    CSV_EVENT(MultiplayerSessions, TEXT("%s Cancelled"), OperationRegionNames[Index]);
+}
+
+
+void FSessionStatsCollector::RecordSearchAcquire(bool bWasReused){
+    if (bWasReused){
+        ++Pool.NumSearchReuses;
+        INC_DWORD_STAT(STAT_SessionPooledReuses);
+    }
+    else{
+        ++Pool.NumSearchAllocations;
+        INC_DWORD_STAT(STAT_SessionSearchAllocations);
+        CSV_CUSTOM_STAT(MultiplayerSessions, SearchAllocations, 1, ECsvCustomStatOp::Accumulate);
+    }
+}
+
+
+void FSessionStatsCollector::RecordSettingsAcquire(bool bWasReused){
+    if (bWasReused){
+        ++Pool.NumSettingsReuses;
+        INC_DWORD_STAT(STAT_SessionPooledReuses);
+    }
+    else{
+        ++Pool.NumSettingsAllocations;
+        INC_DWORD_STAT(STAT_SessionSettingsAllocations);
+        CSV_CUSTOM_STAT(MultiplayerSessions, SettingsAllocations, 1, ECsvCustomStatOp::Accumulate);
+    }
+}
+
+
+void FSessionStatsCollector::RecordRetainedResultStorage(int64 Bytes){
+    Pool.RetainedResultBytes = Bytes;
+    SET_MEMORY_STAT(STAT_SessionRetainedResultStorage, Bytes);
+}
+
+
+FSessionStatsSnapshot FSessionStatsCollector::GetSnapshot() const{
+    FSessionStatsSnapshot Snapshot;
+    for (int32 Index = 0; Index < NumSessionOperationTypes; ++Index){
+        Snapshot.Operations[Index] = Operations[Index];
+    }
+    Snapshot.Pool = Pool;
+    Snapshot.Timestamp = FPlatformTime::Seconds();
+    return Snapshot;
+}
+
+
+void FSessionStatsCollector::Reset(){
+    for (int32 Index = 0; Index < NumSessionOperationTypes; ++Index){
+        Operations[Index] = FSessionOperationStats();
+    }
+    // The retained storage is still there, only the counters start over
+    const int64 RetainedResultBytes = Pool.RetainedResultBytes;
+    Pool = FSessionPoolStats();
+    Pool.RetainedResultBytes = RetainedResultBytes;
+}
+
+
+int64 FSessionStatsCollector::EstimatePayloadBytes(const FOnlineSessionSearchResult &SearchResult){
+    int64 Bytes = sizeof(FOnlineSessionSearchResult);
+    Bytes += SearchResult.Session.OwningUserName.Len() * sizeof(TCHAR);
+    for (const TPair<FName, FOnlineSessionSetting> &Setting : SearchResult.Session.SessionSettings.Settings){
+        Bytes += sizeof(FName) + sizeof(FOnlineSessionSetting);
+        // Strings are the only settings with a payload of their own
+        if (Setting.Value.Data.GetType() == EOnlineKeyValuePairDataType::String){
+            Bytes += Setting.Value.Data.ToString().Len() * sizeof(TCHAR);
+        }
+    }
+    return Bytes;
+}
@@ -0,0 +1,382 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Guid.h"
+#include "UObject/StrongObjectPtr.h"
+#include "LoopbackSessionInterface.h"
+#include "MultiplayerSessionsSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+namespace
+{
+    // Numbers of sessions every perf test runs with
+    const int32 SessionCounts[] = {100, 10000, 100000};
+    // Number of sessions each host advertises, like a dedicated server running several matches
+    const int32 SessionsPerHost = 100;
+    // The registry of the loopback backend is shared by the whole process, so no result may be cut off before the filter
+    const int32 MaxSearchResults = TNumericLimits<int32>::Max();
+    // Longest time (in seconds) to wait for the backend and the worker threads
+    const double PumpTimeoutSeconds = 120.0;
+    // Timing budgets only hold for optimized builds
+    constexpr bool bCheckTimingBudgets = !UE_BUILD_DEBUG;
+
+    // Function to list one test per number of sessions
+    void GetSessionCountTests(TArray<FString> &OutBeautifiedNames, TArray<FString> &OutTestCommands){
+        for (int32 NumSessions : SessionCounts){
+            OutBeautifiedNames.Add(FString::Printf(TEXT("%d Sessions"), NumSessions));
+            OutTestCommands.Add(FString::FromInt(NumSessions));
+        }
+    }
+
+    /*
+    Hosts advertising the sessions and a subsystem searching and joining them, all through loopback interfaces of this process
+    */
+    class FSessionPerfFixture{
+    public:
+        FSessionPerfFixture(int32 InNumSessions, float LatencyMs) :
+            NumSessions(InNumSessions),
+            MatchType(FGuid::NewGuid().ToString()){
+            FLoopbackSessionConfig Config;
+            Config.LatencyMs = LatencyMs;
+            Config.LatencyJitterMs = 0.f;
+
+            /*
+            Advertise the sessions
+            */
+            for (int32 FirstIndex = 0; FirstIndex < NumSessions; FirstIndex += SessionsPerHost){
+                TSharedRef<FLoopbackSessionInterface, ESPMode::ThreadSafe> Host = MakeShared<FLoopbackSessionInterface, ESPMode::ThreadSafe>(Config);
+                Host->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateLambda([this](FName SessionName, bool bWasSuccessful){
+                    NumAdvertised += bWasSuccessful ? 1 : 0;
+                    ++NumCreated;
+                }));
+                for (int32 Index = FirstIndex; Index < FMath::Min(FirstIndex + SessionsPerHost, NumSessions); ++Index){
+                    FOnlineSessionSettings Settings;
+                    Settings.NumPublicConnections = 4;
+                    Settings.bShouldAdvertise = true;
+                    Settings.bUsesPresence = true;
+                    // A match type of its own keeps out the sessions of anything else running in the process
+                    Settings.Set(FName("MatchType"), MatchType, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+                    Settings.Set(FName("Skill"), Index % 100, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+                    Host->CreateSession(0, FName(TEXT("PerfSession"), Index + 1), Settings);
+                }
+                Hosts.Add(Host);
+            }
+
+            /*
+            Drive the subsystem through its own loopback interface
+            */
+            Client = MakeShared<FLoopbackSessionInterface, ESPMode::ThreadSafe>(Config);
+            Subsystem.Reset(NewObject<UMultiplayerSessionsSubsystem>());
+            Subsystem->SetSessionInterface(Client, LOOPBACK_SUBSYSTEM);
+            // Cached results stay fresh for the whole test
+            Subsystem->SetSearchCacheTTL(3600.f, 0.f);
+        }
+
+        ~FSessionPerfFixture(){
+            // Drop the operations in flight before the backends go away
+            Subsystem->SetSessionInterface(nullptr, NAME_None);
+        }
+
+        // Function to complete the requests of the backends and the results processed on worker threads until the condition holds, returns false on timeout
+        bool Pump(TFunctionRef<bool()> IsDone) const{
+            const double Deadline = FPlatformTime::Seconds() + PumpTimeoutSeconds;
+            while (!IsDone()){
+                if (FPlatformTime::Seconds() >= Deadline){
+                    return false;
+                }
+                for (const TSharedRef<FLoopbackSessionInterface, ESPMode::ThreadSafe> &Host : Hosts){
+                    Host->FlushRequests();
+                }
+                Client->FlushRequests();
+                FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+                if (!IsDone()){
+                    FPlatformProcess::SleepNoStats(0.0005f);
+                }
+            }
+            return true;
+        }
+
+        // Function to wait until the backend has advertised every session, returns whether all of them were advertised
+        bool Advertise() const{
+            return Pump([this](){ return NumCreated == NumSessions; }) && NumAdvertised == NumSessions;
+        }
+
+        // Function to make the filter of the join button of the menu
+        FSessionSearchFilter MakeFilter() const{
+            FSessionSearchFilter Filter;
+            Filter.MatchType = MatchType;
+            Filter.MinOpenSlots = 1;
+            return Filter;
+        }
+
+        // Function to search through the subsystem, returns whether the results were broadcast
+        bool Search(const FSessionSearchFilter &Filter, FSessionSearchSnapshot &OutResults, bool &bOutWasSuccessful) const{
+            bool bIsComplete = false;
+            const FDelegateHandle Handle = Subsystem->MultiplayerOnFindSessionsComplete.AddLambda([&](const FSessionSearchSnapshot &Results, bool bWasSuccessful){
+                OutResults = Results;
+                bOutWasSuccessful = bWasSuccessful;
+                bIsComplete = true;
+            });
+            Subsystem->FindSessions(MaxSearchResults, Filter);
+            const bool bHasCompleted = Pump([&bIsComplete](){ return bIsComplete; });
+            Subsystem->MultiplayerOnFindSessionsComplete.Remove(Handle);
+            return bHasCompleted;
+        }
+
+        // Function to quick join through the subsystem like the join button of the menu, returns whether the joint was broadcast
+        bool QuickJoin(EOnJoinSessionCompleteResult::Type &OutResult) const{
+            bool bIsComplete = false;
+            const FDelegateHandle Handle = Subsystem->MultiplayerOnJoinSessionsComplete.AddLambda([&](EOnJoinSessionCompleteResult::Type Result){
+                OutResult = Result;
+                bIsComplete = true;
+            });
+            Subsystem->QuickJoin(MakeFilter(), static_cast<float>(PumpTimeoutSeconds), MaxSearchResults);
+            const bool bHasCompleted = Pump([&bIsComplete](){ return bIsComplete; });
+            Subsystem->MultiplayerOnJoinSessionsComplete.Remove(Handle);
+            return bHasCompleted;
+        }
+
+        // Number of advertised sessions
+        const int32 NumSessions;
+        // Match type of the advertised sessions
+        const FString MatchType;
+        // Interfaces hosting the sessions
+        TArray<TSharedRef<FLoopbackSessionInterface, ESPMode::ThreadSafe>> Hosts;
+        // Interface the subsystem drives
+        TSharedPtr<FLoopbackSessionInterface, ESPMode::ThreadSafe> Client;
+        // Subsystem under test
+        TStrongObjectPtr<UMultiplayerSessionsSubsystem> Subsystem;
+
+    private:
+        // Number of sessions whose creation has completed
+        int32 NumCreated{0};
+        // Number of sessions that are advertised
+        int32 NumAdvertised{0};
+    };
+}
+
+
+/*
+A search returns every session once, filters on the client at a bounded cost, reuses its pooled search object and hands the same snapshot to every subscriber
+*/
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FMultiplayerSessionsSearchPerfTest, "MultiplayerSessions.Perf.Search", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FMultiplayerSessionsSearchPerfTest::GetTests(TArray<FString> &OutBeautifiedNames, TArray<FString> &OutTestCommands) const{
+    GetSessionCountTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FMultiplayerSessionsSearchPerfTest::RunTest(const FString &Parameters){
+    const int32 NumSessions = FCString::Atoi(*Parameters);
+    FSessionPerfFixture Fixture(NumSessions, 0.f);
+    if (!TestTrue(TEXT("Every session is advertised"), Fixture.Advertise())){
+        return false;
+    }
+
+    /*
+    Results
+    */
+    FSessionSearchSnapshot Results;
+    bool bWasSuccessful = false;
+    double StartTime = FPlatformTime::Seconds();
+    if (!TestTrue(TEXT("The search completes"), Fixture.Search(Fixture.MakeFilter(), Results, bWasSuccessful))){
+        return false;
+    }
+    const double SearchSeconds = FPlatformTime::Seconds() - StartTime;
+    TestTrue(TEXT("The search succeeds"), bWasSuccessful);
+    TestEqual(TEXT("The search returns every session"), Results.Num(), NumSessions);
+    TSet<FString> SessionIds;
+    SessionIds.Reserve(Results.Num());
+    for (const FOnlineSessionSearchResult &Result : Results){
+        SessionIds.Add(Result.GetSessionIdStr());
+    }
+    TestEqual(TEXT("Every session is returned once"), SessionIds.Num(), NumSessions);
+    FSessionStatsSnapshot Stats = Fixture.Subsystem->GetStatsSnapshot();
+    TestEqual(TEXT("One search reaches the backend"), static_cast<int32>(Stats.Get(ESessionOperationType::Find).NumSucceeded), 1);
+    TestEqual(TEXT("The statistics count every result"), Stats.Get(ESessionOperationType::Find).LastNumResults, NumSessions);
+    if (bCheckTimingBudgets){
+        TestTrue(TEXT("The search stays within its budget"), SearchSeconds < 1.0 + NumSessions * 50e-6);
+    }
+    AddInfo(FString::Printf(TEXT("Search of %d sessions: %.2f ms"), NumSessions, SearchSeconds * 1000.0));
+
+    /*
+    Allocations per search
+    */
+    TestEqual(TEXT("The first search allocates its search object"), static_cast<int32>(Stats.Pool.NumSearchAllocations), 1);
+    const int64 RetainedBytes = Stats.Pool.RetainedResultBytes;
+    TestTrue(TEXT("The storage of the raw results is kept for the next search"), RetainedBytes >= static_cast<int64>(NumSessions) * static_cast<int64>(sizeof(FOnlineSessionSearchResult)));
+    // The same search again, past the cache
+    Fixture.Subsystem->InvalidateSearchCache();
+    if (!TestTrue(TEXT("The repeated search completes"), Fixture.Search(Fixture.MakeFilter(), Results, bWasSuccessful))){
+        return false;
+    }
+    TestEqual(TEXT("The repeated search returns every session"), Results.Num(), NumSessions);
+    Stats = Fixture.Subsystem->GetStatsSnapshot();
+    TestEqual(TEXT("The repeated search reaches the backend"), static_cast<int32>(Stats.Get(ESessionOperationType::Find).NumSucceeded), 2);
+    TestEqual(TEXT("The repeated search allocates no search object"), static_cast<int32>(Stats.Pool.NumSearchAllocations), 1);
+    TestEqual(TEXT("The repeated search reuses the pooled search object"), static_cast<int32>(Stats.Pool.NumSearchReuses), 1);
+    TestEqual(TEXT("The retained result storage doesn't grow"), Stats.Pool.RetainedResultBytes, RetainedBytes);
+
+    /*
+    Filter cost
+    */
+    FSessionSearchFilter SkillFilter = Fixture.MakeFilter();
+    SkillFilter.Where(FName("Skill"), 50, EOnlineComparisonOp::GreaterThanEquals);
+    // On its own, over the results of the search
+    StartTime = FPlatformTime::Seconds();
+    int32 NumMatches = 0;
+    for (const FOnlineSessionSearchResult &Result : Results){
+        NumMatches += SkillFilter.Matches(Result, false) ? 1 : 0;
+    }
+    const double FilterSeconds = FPlatformTime::Seconds() - StartTime;
+    TestEqual(TEXT("Half of the sessions satisfy the skill criterion"), NumMatches, NumSessions / 2);
+    if (bCheckTimingBudgets){
+        TestTrue(TEXT("The filter stays within its budget"), FilterSeconds < 0.01 + NumSessions * 5e-6);
+    }
+    AddInfo(FString::Printf(TEXT("Filter of %d results: %.2f ms"), NumSessions, FilterSeconds * 1000.0));
+    // Through the search, which filters on the client since the loopback backend ignores the query settings
+    if (!TestTrue(TEXT("The filtered search completes"), Fixture.Search(SkillFilter, Results, bWasSuccessful))){
+        return false;
+    }
+    TestEqual(TEXT("The filtered search returns the sessions satisfying the criterion"), Results.Num(), NumSessions / 2);
+    int32 NumBadSkills = 0;
+    for (const FOnlineSessionSearchResult &Result : Results){
+        int32 Skill = -1;
+        NumBadSkills += !Result.Session.SessionSettings.Get(FName("Skill"), Skill) || Skill < 50;
+    }
+    TestEqual(TEXT("Every filtered result satisfies the criterion"), NumBadSkills, 0);
+    // A criterion no session satisfies
+    FSessionSearchFilter FullFilter = Fixture.MakeFilter();
+    FullFilter.MinOpenSlots = 5;
+    if (!TestTrue(TEXT("The search without matches completes"), Fixture.Search(FullFilter, Results, bWasSuccessful))){
+        return false;
+    }
+    TestEqual(TEXT("No session has more open slots than it has slots"), Results.Num(), 0);
+    TestTrue(TEXT("A search without matches still succeeds"), bWasSuccessful);
+    // Answered from the cache, the same search reports the same
+    if (!TestTrue(TEXT("The cached search without matches completes"), Fixture.Search(FullFilter, Results, bWasSuccessful))){
+        return false;
+    }
+    TestEqual(TEXT("The cached search without matches returns nothing"), Results.Num(), 0);
+    TestTrue(TEXT("The cached search without matches still succeeds"), bWasSuccessful);
+
+    /*
+    Delegate dispatch overhead
+    */
+    // Cached searches broadcast right away, every subscriber gets the same snapshot without the results being copied
+    const int32 NumListeners = 100;
+    const int32 NumBroadcasts = 10;
+    FSessionSearchSnapshot CachedResults;
+    if (!TestTrue(TEXT("The cached search completes"), Fixture.Search(Fixture.MakeFilter(), CachedResults, bWasSuccessful))){
+        return false;
+    }
+    const FOnlineSessionSearchResult *const SharedResults = CachedResults.GetResults().GetData();
+    const int32 NumFindsBefore = static_cast<int32>(Fixture.Subsystem->GetStatsSnapshot().Get(ESessionOperationType::Find).NumSucceeded);
+    int32 NumCalls = 0;
+    int32 NumCopies = 0;
+    TArray<FDelegateHandle> Handles;
+    for (int32 Listener = 0; Listener < NumListeners; ++Listener){
+        Handles.Add(Fixture.Subsystem->MultiplayerOnFindSessionsComplete.AddLambda([&NumCalls, &NumCopies, SharedResults, NumSessions](const FSessionSearchSnapshot &Snapshot, bool){
+            ++NumCalls;
+            NumCopies += Snapshot.Num() != NumSessions || Snapshot.GetResults().GetData() != SharedResults;
+        }));
+    }
+    StartTime = FPlatformTime::Seconds();
+    for (int32 Broadcast = 0; Broadcast < NumBroadcasts; ++Broadcast){
+        Fixture.Subsystem->FindSessions(MaxSearchResults, Fixture.MakeFilter());
+    }
+    const double DispatchSeconds = FPlatformTime::Seconds() - StartTime;
+    for (const FDelegateHandle &Handle : Handles){
+        Fixture.Subsystem->MultiplayerOnFindSessionsComplete.Remove(Handle);
+    }
+    TestEqual(TEXT("Every listener is called for every cached search"), NumCalls, NumListeners * NumBroadcasts);
+    TestEqual(TEXT("Every listener gets the cached results without a copy"), NumCopies, 0);
+    TestEqual(TEXT("Cached searches don't reach the backend"), static_cast<int32>(Fixture.Subsystem->GetStatsSnapshot().Get(ESessionOperationType::Find).NumSucceeded), NumFindsBefore);
+    // The cost doesn't depend on the number of results
+    if (bCheckTimingBudgets){
+        TestTrue(TEXT("The dispatch stays within its budget"), DispatchSeconds < 0.05);
+    }
+    AddInfo(FString::Printf(TEXT("Dispatch of %d cached searches to %d listeners: %.3f ms"), NumBroadcasts, NumListeners, DispatchSeconds * 1000.0));
+    return true;
+}
+
+
+/*
+A quick join searches and joins one round trip of the backend each, and joins from the cache without searching again
+*/
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FMultiplayerSessionsSearchToJoinPerfTest, "MultiplayerSessions.Perf.SearchToJoin", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FMultiplayerSessionsSearchToJoinPerfTest::GetTests(TArray<FString> &OutBeautifiedNames, TArray<FString> &OutTestCommands) const{
+    GetSessionCountTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FMultiplayerSessionsSearchToJoinPerfTest::RunTest(const FString &Parameters){
+    const int32 NumSessions = FCString::Atoi(*Parameters);
+    // Every request takes this long on the backend
+    const float LatencyMs = 10.f;
+    FSessionPerfFixture Fixture(NumSessions, LatencyMs);
+    if (!TestTrue(TEXT("Every session is advertised"), Fixture.Advertise())){
+        return false;
+    }
+
+    /*
+    Search to join
+    */
+    EOnJoinSessionCompleteResult::Type Result = EOnJoinSessionCompleteResult::UnknownError;
+    double StartTime = FPlatformTime::Seconds();
+    if (!TestTrue(TEXT("The quick join completes"), Fixture.QuickJoin(Result))){
+        return false;
+    }
+    const double SearchToJoinSeconds = FPlatformTime::Seconds() - StartTime;
+    TestTrue(TEXT("The quick join succeeds"), Result == EOnJoinSessionCompleteResult::Success);
+    const FNamedOnlineSession *JoinedSession = Fixture.Client->GetNamedSession(NAME_GameSession);
+    if (TestNotNull(TEXT("The client is in the game session"), JoinedSession)){
+        TestFalse(TEXT("The client doesn't host the joined session"), JoinedSession->bHosting);
+        FString JoinedMatchType;
+        JoinedSession->SessionSettings.Get(FName("MatchType"), JoinedMatchType);
+        TestEqual(TEXT("The joined session is one of the advertised sessions"), JoinedMatchType, Fixture.MatchType);
+    }
+    FSessionStatsSnapshot Stats = Fixture.Subsystem->GetStatsSnapshot();
+    TestEqual(TEXT("One search reaches the backend"), static_cast<int32>(Stats.Get(ESessionOperationType::Find).NumSucceeded), 1);
+    TestEqual(TEXT("The search sees every session"), Stats.Get(ESessionOperationType::Find).LastNumResults, NumSessions);
+    TestEqual(TEXT("One joint reaches the backend"), static_cast<int32>(Stats.Get(ESessionOperationType::Join).NumSucceeded), 1);
+    TestTrue(TEXT("The search and the joint each take a round trip"), SearchToJoinSeconds >= 2.0 * LatencyMs / 1000.0 * 0.9);
+    if (bCheckTimingBudgets){
+        TestTrue(TEXT("The search to join stays within its budget"), SearchToJoinSeconds < 1.0 + NumSessions * 50e-6);
+    }
+    AddInfo(FString::Printf(TEXT("Search to join over %d sessions: %.2f ms"), NumSessions, SearchToJoinSeconds * 1000.0));
+
+    /*
+    Join from the cache
+    */
+    // A client is in one game session at a time
+    Fixture.Subsystem->DestroySession(NAME_GameSession);
+    const bool bHasLeft = Fixture.Pump([&Fixture](){
+        return Fixture.Client->GetNamedSession(NAME_GameSession) == nullptr && Fixture.Subsystem->GetOperationState(NAME_GameSession) == ESessionOperationState::Idle;
+    });
+    if (!TestTrue(TEXT("The client leaves the game session"), bHasLeft)){
+        return false;
+    }
+    StartTime = FPlatformTime::Seconds();
+    if (!TestTrue(TEXT("The cached quick join completes"), Fixture.QuickJoin(Result))){
+        return false;
+    }
+    const double CachedJoinSeconds = FPlatformTime::Seconds() - StartTime;
+    TestTrue(TEXT("The cached quick join succeeds"), Result == EOnJoinSessionCompleteResult::Success);
+    TestNotNull(TEXT("The client is in the game session again"), Fixture.Client->GetNamedSession(NAME_GameSession));
+    Stats = Fixture.Subsystem->GetStatsSnapshot();
+    TestEqual(TEXT("The cached quick join doesn't search"), static_cast<int32>(Stats.Get(ESessionOperationType::Find).NumSucceeded), 1);
+    TestEqual(TEXT("The cached quick join reaches the backend once"), static_cast<int32>(Stats.Get(ESessionOperationType::Join).NumSucceeded), 2);
+    TestTrue(TEXT("The cached joint takes a round trip"), CachedJoinSeconds >= LatencyMs / 1000.0 * 0.9);
+    if (bCheckTimingBudgets){
+        TestTrue(TEXT("The cached join stays within its budget"), CachedJoinSeconds < 1.0 + NumSessions * 5e-6);
+    }
+    AddInfo(FString::Printf(TEXT("Join from the cache over %d sessions: %.2f ms"), NumSessions, CachedJoinSeconds * 1000.0));
+    return true;
+}
+
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,284 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "SessionMatchmaker.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+namespace
+{
+    // Function to make a ticket
+    FMatchmakingTicket MakeTicket(const FString &Region, const FString &MatchType, int32 Skill){
+        FMatchmakingTicket Ticket;
+        Ticket.Region = Region;
+        Ticket.MatchType = MatchType;
+        Ticket.Skill = Skill;
+        return Ticket;
+    }
+}
+
+
+/*
+A player is matched within the bucket of its region, match type and skill band, fullest session first
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionMatchmakerBucketTest, "MultiplayerSessions.Matchmaker.Buckets", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionMatchmakerBucketTest::RunTest(const FString &Parameters){
+    FSessionMatchmaker Matchmaker;
+    Matchmaker.AddOrUpdateSession(TEXT("Other match type"), TEXT("EU"), TEXT("TeamDeathmatch"), 150, 1);
+    Matchmaker.AddOrUpdateSession(TEXT("Other region"), TEXT("NA"), TEXT("FreeForAll"), 150, 1);
+    Matchmaker.AddOrUpdateSession(TEXT("Other band"), TEXT("EU"), TEXT("FreeForAll"), 250, 1);
+    Matchmaker.AddOrUpdateSession(TEXT("Emptier"), TEXT("EU"), TEXT("FreeForAll"), 110, 6);
+    Matchmaker.AddOrUpdateSession(TEXT("Fuller"), TEXT("EU"), TEXT("FreeForAll"), 190, 2);
+    TestEqual(TEXT("Every session is indexed"), Matchmaker.NumSessions(), 5);
+
+    FString SessionId;
+    TestTrue(TEXT("A session is in the bucket of the player"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 150), 0.f, SessionId));
+    TestEqual(TEXT("The fullest session of the bucket is picked"), SessionId, FString(TEXT("Fuller")));
+    TestTrue(TEXT("A player of another band finds the session of its own band"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 299), 0.f, SessionId));
+    TestEqual(TEXT("The session of the own band is picked"), SessionId, FString(TEXT("Other band")));
+    TestFalse(TEXT("No session is in the bucket of an unknown match type"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("CaptureTheFlag"), 150), 3600.f, SessionId));
+    TestTrue(TEXT("Region and match type are compared ignoring case"), Matchmaker.FindSession(MakeTicket(TEXT("eu"), TEXT("freeforall"), 150), 0.f, SessionId));
+    TestEqual(TEXT("A player spelling the names differently lands in the same bucket"), SessionId, FString(TEXT("Fuller")));
+
+    // An update moves the session to its new bucket
+    Matchmaker.AddOrUpdateSession(TEXT("Fuller"), TEXT("EU"), TEXT("FreeForAll"), 550, 2);
+    TestTrue(TEXT("The remaining session of the bucket is found"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 150), 0.f, SessionId));
+    TestEqual(TEXT("The moved session isn't picked from its old bucket"), SessionId, FString(TEXT("Emptier")));
+
+    // A removed session is gone from every bucket
+    Matchmaker.RemoveSession(TEXT("Emptier"));
+    TestFalse(TEXT("No session is left in the bucket"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 150), 0.f, SessionId));
+    TestEqual(TEXT("The removed session isn't indexed"), Matchmaker.NumSessions(), 4);
+    return true;
+}
+
+
+/*
+A player only leaves its region once it has waited for the any region delay, a player without a region looks everywhere right away
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionMatchmakerRegionTest, "MultiplayerSessions.Matchmaker.Region", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionMatchmakerRegionTest::RunTest(const FString &Parameters){
+    FMatchmakingSettings Settings;
+    Settings.AnyRegionDelay = 30.f;
+    FSessionMatchmaker Matchmaker(Settings);
+    Matchmaker.AddOrUpdateSession(TEXT("NA session"), TEXT("NA"), TEXT("FreeForAll"), 150, 4);
+
+    FString SessionId;
+    TestFalse(TEXT("A session of another region isn't picked right away"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 150), 29.f, SessionId));
+    TestTrue(TEXT("A session of another region is picked after the delay"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 150), 30.f, SessionId));
+    TestEqual(TEXT("The session of the other region is picked"), SessionId, FString(TEXT("NA session")));
+    TestTrue(TEXT("A player without a region looks at every region right away"), Matchmaker.FindSession(MakeTicket(FString(), TEXT("FreeForAll"), 150), 0.f, SessionId));
+
+    // The own region still comes first once every region is considered
+    Matchmaker.AddOrUpdateSession(TEXT("EU session"), TEXT("EU"), TEXT("FreeForAll"), 150, 8);
+    TestTrue(TEXT("A session is found after the delay"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 150), 60.f, SessionId));
+    TestEqual(TEXT("The session of the own region is picked over a fuller one elsewhere"), SessionId, FString(TEXT("EU session")));
+
+    // A negative delay keeps the player in its region for good
+    Settings.AnyRegionDelay = -1.f;
+    FSessionMatchmaker RegionalMatchmaker(Settings);
+    RegionalMatchmaker.AddOrUpdateSession(TEXT("NA session"), TEXT("NA"), TEXT("FreeForAll"), 150, 4);
+    TestFalse(TEXT("A session of another region is never picked"), RegionalMatchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 150), 3600.f, SessionId));
+    return true;
+}
+
+
+/*
+The search widens by one skill band on either side per interval, up to the maximum widening, closer bands first
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionMatchmakerSkillWideningTest, "MultiplayerSessions.Matchmaker.SkillWidening", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionMatchmakerSkillWideningTest::RunTest(const FString &Parameters){
+    FMatchmakingSettings Settings;
+    Settings.SkillBandWidth = 100;
+    Settings.SkillWideningInterval = 10.f;
+    Settings.MaxSkillWidening = 5;
+    Settings.AnyRegionDelay = -1.f;
+    FSessionMatchmaker Matchmaker(Settings);
+    Matchmaker.AddOrUpdateSession(TEXT("Three bands below"), TEXT("EU"), TEXT("FreeForAll"), 450, 1);
+    const FMatchmakingTicket Ticket = MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 750);
+
+    FString SessionId;
+    TestFalse(TEXT("No session in reach right away"), Matchmaker.FindSession(Ticket, 0.f, SessionId));
+    TestFalse(TEXT("No session in reach after widening by two bands"), Matchmaker.FindSession(Ticket, 29.9f, SessionId));
+    TestTrue(TEXT("A session in reach after widening by three bands"), Matchmaker.FindSession(Ticket, 30.f, SessionId));
+    TestEqual(TEXT("The session three bands below is picked"), SessionId, FString(TEXT("Three bands below")));
+
+    // The closer band wins, whichever side it is on
+    Matchmaker.AddOrUpdateSession(TEXT("One band above"), TEXT("EU"), TEXT("FreeForAll"), 850, 8);
+    TestTrue(TEXT("A session in reach after widening by one band"), Matchmaker.FindSession(Ticket, 30.f, SessionId));
+    TestEqual(TEXT("The session of the closer band is picked over a fuller one further away"), SessionId, FString(TEXT("One band above")));
+
+    // The widening stops at the maximum
+    const FMatchmakingTicket FarTicket = MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 1450);
+    TestFalse(TEXT("A session six bands away stays out of reach"), Matchmaker.FindSession(FarTicket, 3600.f, SessionId));
+    TestTrue(TEXT("A session five bands away comes into reach"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 1350), 3600.f, SessionId));
+
+    // Negative skills get bands of their own rather than sharing band 0
+    Matchmaker.AddOrUpdateSession(TEXT("Negative"), TEXT("EU"), TEXT("FreeForAll"), -50, 1);
+    TestTrue(TEXT("A session of band -1 is found"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), -1), 0.f, SessionId));
+    TestFalse(TEXT("A session of band -1 isn't in band 0"), Matchmaker.FindSession(MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 50), 0.f, SessionId));
+    return true;
+}
+
+
+/*
+Every assignment takes a slot of its session, a session without open slots isn't assigned to until it's refreshed
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionMatchmakerSlotTest, "MultiplayerSessions.Matchmaker.Slots", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionMatchmakerSlotTest::RunTest(const FString &Parameters){
+    FSessionMatchmaker Matchmaker;
+    Matchmaker.AddOrUpdateSession(TEXT("Three slots"), TEXT("EU"), TEXT("FreeForAll"), 150, 3);
+    Matchmaker.AddOrUpdateSession(TEXT("Two slots"), TEXT("EU"), TEXT("FreeForAll"), 150, 2);
+    const FMatchmakingTicket Ticket = MakeTicket(TEXT("EU"), TEXT("FreeForAll"), 150);
+    TArray<int64> TicketIds;
+    for (int32 Index = 0; Index < 6; ++Index){
+        TicketIds.Add(Matchmaker.EnqueuePlayer(Ticket, 0.0));
+    }
+    TestEqual(TEXT("Every player waits in the bucket"), Matchmaker.GetNumWaitingPlayers(Ticket), 6);
+
+    TArray<FMatchmakingAssignment> Assignments;
+    Matchmaker.Tick(0.0, Assignments);
+    if (!TestEqual(TEXT("As many players are assigned as there are slots"), Assignments.Num(), 5)){
+        return false;
+    }
+    // The fullest session is filled first, and keeps being picked while it has slots left
+    const TCHAR *const ExpectedSessionIds[] = {TEXT("Two slots"), TEXT("Two slots"), TEXT("Three slots"), TEXT("Three slots"), TEXT("Three slots")};
+    for (int32 Index = 0; Index < Assignments.Num(); ++Index){
+        TestEqual(TEXT("The players who waited the longest are assigned first"), Assignments[Index].TicketId, TicketIds[Index]);
+        TestEqual(TEXT("The fullest session with a slot left is assigned"), Assignments[Index].SessionId, FString(ExpectedSessionIds[Index]));
+    }
+    TestEqual(TEXT("The player without a slot keeps waiting"), Matchmaker.NumWaitingPlayers(), 1);
+    TestEqual(TEXT("The player without a slot is counted in its bucket"), Matchmaker.GetNumWaitingPlayers(Ticket), 1);
+    TestEqual(TEXT("Full sessions stay known"), Matchmaker.NumSessions(), 2);
+    FString SessionId;
+    TestFalse(TEXT("Full sessions aren't picked"), Matchmaker.FindSession(Ticket, 3600.f, SessionId));
+
+    // A refresh from the backend hands the slots back
+    Matchmaker.AddOrUpdateSession(TEXT("Two slots"), TEXT("EU"), TEXT("FreeForAll"), 150, 1);
+    Assignments.Reset();
+    Matchmaker.Tick(1.0, Assignments);
+    if (TestEqual(TEXT("The waiting player is assigned once a slot opens"), Assignments.Num(), 1)){
+        TestEqual(TEXT("The waiting player gets the refreshed session"), Assignments[0].SessionId, FString(TEXT("Two slots")));
+        TestEqual(TEXT("The last ticket is assigned"), Assignments[0].TicketId, TicketIds.Last());
+    }
+    TestEqual(TEXT("Nobody waits anymore"), Matchmaker.NumWaitingPlayers(), 0);
+    TestEqual(TEXT("The bucket has no waiting players"), Matchmaker.GetNumWaitingPlayers(Ticket), 0);
+
+    // A session that turned a player away isn't assigned to anymore
+    Matchmaker.AddOrUpdateSession(TEXT("Three slots"), TEXT("EU"), TEXT("FreeForAll"), 150, 3);
+    Matchmaker.MarkSessionFull(TEXT("Three slots"));
+    TestFalse(TEXT("A session marked as full isn't picked"), Matchmaker.FindSession(Ticket, 3600.f, SessionId));
+    TestEqual(TEXT("A session marked as full stays known"), Matchmaker.NumSessions(), 2);
+
+    // A cancelled player isn't assigned
+    Matchmaker.AddOrUpdateSession(TEXT("Three slots"), TEXT("EU"), TEXT("FreeForAll"), 150, 3);
+    Matchmaker.CancelPlayer(Matchmaker.EnqueuePlayer(Ticket, 2.0));
+    Assignments.Reset();
+    Matchmaker.Tick(2.0, Assignments);
+    TestEqual(TEXT("A cancelled player isn't assigned"), Assignments.Num(), 0);
+    TestEqual(TEXT("A cancelled player isn't counted"), Matchmaker.GetNumWaitingPlayers(Ticket), 0);
+    return true;
+}
+
+
+/*
+Synthetic load: every assignment has to respect the match type, the skill widening and the open slots of its session
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionMatchmakerLoadTest, "MultiplayerSessions.Matchmaker.Load", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionMatchmakerLoadTest::RunTest(const FString &Parameters){
+    const int32 NumSessions = 10000;
+    const int32 NumPlayers = 100000;
+    FRandomStream Random(0);
+    const TCHAR *const Regions[] = {TEXT("EU"), TEXT("NA"), TEXT("ASIA"), TEXT("SA")};
+    const TCHAR *const MatchTypes[] = {TEXT("FreeForAll"), TEXT("TeamDeathmatch")};
+    const FMatchmakingSettings Settings;
+
+    /*
+    Index the sessions
+    */
+    struct FSyntheticSession{
+        FString Region;
+        FString MatchType;
+        int32 Skill{0};
+        int32 OpenSlots{0};
+    };
+    FSessionMatchmaker Matchmaker(Settings);
+    TMap<FString, FSyntheticSession> SyntheticSessions;
+    SyntheticSessions.Reserve(NumSessions);
+    int32 NumOpenSlots = 0;
+    for (int32 Index = 0; Index < NumSessions; ++Index){
+        FSyntheticSession Session{Regions[Random.RandRange(0, UE_ARRAY_COUNT(Regions) - 1)], MatchTypes[Random.RandRange(0, UE_ARRAY_COUNT(MatchTypes) - 1)], Random.RandRange(0, 3000), Random.RandRange(1, 16)};
+        const FString SessionId = FString::Printf(TEXT("Session%d"), Index);
+        Matchmaker.AddOrUpdateSession(SessionId, Session.Region, Session.MatchType, Session.Skill, Session.OpenSlots);
+        NumOpenSlots += Session.OpenSlots;
+        SyntheticSessions.Add(SessionId, MoveTemp(Session));
+    }
+    TestEqual(TEXT("Every session is indexed"), Matchmaker.NumSessions(), NumSessions);
+
+    /*
+    Assign the players
+    */
+    TMap<int64, FMatchmakingTicket> Tickets;
+    Tickets.Reserve(NumPlayers);
+    for (int32 Index = 0; Index < NumPlayers; ++Index){
+        const FMatchmakingTicket Ticket = MakeTicket(Regions[Random.RandRange(0, UE_ARRAY_COUNT(Regions) - 1)], MatchTypes[Random.RandRange(0, UE_ARRAY_COUNT(MatchTypes) - 1)], Random.RandRange(0, 3000));
+        Tickets.Add(Matchmaker.EnqueuePlayer(Ticket, 0.0), Ticket);
+    }
+    // Right away only the own region and skill band are in reach, later on the search has widened all the way
+    TArray<FMatchmakingAssignment> Assignments;
+    Matchmaker.Tick(0.0, Assignments);
+    const int32 NumImmediate = Assignments.Num();
+    Matchmaker.Tick(3600.0, Assignments);
+
+    /*
+    Check every assignment
+    */
+    TestEqual(TEXT("Every player is either assigned or still waiting"), Assignments.Num() + Matchmaker.NumWaitingPlayers(), NumPlayers);
+    TestTrue(TEXT("No more players are assigned than there are slots"), Assignments.Num() <= NumOpenSlots);
+    TestTrue(TEXT("Players are assigned right away"), NumImmediate > 0);
+    TestTrue(TEXT("The widening assigns more players"), Assignments.Num() > NumImmediate);
+    TMap<FString, int32> NumAssigned;
+    TSet<int64> AssignedTickets;
+    int32 NumBadMatchTypes = 0;
+    int32 NumBadSkills = 0;
+    int32 NumBadRegions = 0;
+    for (int32 Index = 0; Index < Assignments.Num(); ++Index){
+        const FMatchmakingAssignment &Assignment = Assignments[Index];
+        const FMatchmakingTicket *Ticket = Tickets.Find(Assignment.TicketId);
+        const FSyntheticSession *Session = SyntheticSessions.Find(Assignment.SessionId);
+        if (!TestNotNull(TEXT("The ticket was handed out"), Ticket) || !TestNotNull(TEXT("The session was indexed"), Session)){
+            return false;
+        }
+        bool bIsAlreadyAssigned = false;
+        AssignedTickets.Add(Assignment.TicketId, &bIsAlreadyAssigned);
+        TestFalse(TEXT("A player is assigned once"), bIsAlreadyAssigned);
+        ++NumAssigned.FindOrAdd(Assignment.SessionId);
+        NumBadMatchTypes += Session->MatchType != Ticket->MatchType;
+        const int32 BandDistance = FMath::Abs(FMath::FloorToInt(static_cast<float>(Session->Skill) / Settings.SkillBandWidth) - FMath::FloorToInt(static_cast<float>(Ticket->Skill) / Settings.SkillBandWidth));
+        NumBadSkills += BandDistance > Settings.MaxSkillWidening;
+        // The first tick assigns within the own region and skill band only
+        if (Index < NumImmediate){
+            NumBadRegions += Session->Region != Ticket->Region;
+            NumBadSkills += BandDistance != 0;
+        }
+    }
+    TestEqual(TEXT("Every assignment has the match type of the player"), NumBadMatchTypes, 0);
+    TestEqual(TEXT("Every assignment is within the skill widening"), NumBadSkills, 0);
+    TestEqual(TEXT("The first assignments are within the region of the player"), NumBadRegions, 0);
+    int32 NumOverbooked = 0;
+    for (const TPair<FString, int32> &Assigned : NumAssigned){
+        NumOverbooked += Assigned.Value > SyntheticSessions[Assigned.Key].OpenSlots;
+    }
+    TestEqual(TEXT("No session gets more players than it has open slots"), NumOverbooked, 0);
+    return true;
+}
+
+
+#endif // WITH_DEV_AUTOMATION_TESTS
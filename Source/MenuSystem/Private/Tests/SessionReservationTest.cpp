@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "Async/ParallelFor.h"
+#include "Common/UdpSocketBuilder.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "IPAddress.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "SessionReservationBeacon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+namespace
+{
+    // Function to get the loopback address of a port
+    TSharedRef<FInternetAddr> MakeLocalAddress(int32 Port){
+        bool bIsValid = false;
+        TSharedRef<FInternetAddr> Address = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+        Address->SetIp(TEXT("127.0.0.1"), bIsValid);
+        Address->SetPort(Port);
+        return Address;
+    }
+
+    // Function to make a request for a new reservation
+    FSessionReservationRequest MakeRequest(int32 Port, uint64 SessionKey){
+        FSessionReservationRequest Request;
+        Request.Address = MakeLocalAddress(Port);
+        Request.SessionKey = SessionKey;
+        Request.ReservationId = FSessionReservationClient::MakeReservationId();
+        return Request;
+    }
+}
+
+
+/*
+A host grants slots until every slot is taken or held, and grants again once a slot is given back or the player arrives
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionReservationSlotTest, "MultiplayerSessions.Reservation.Slots", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionReservationSlotTest::RunTest(const FString &Parameters){
+    FSessionReservationResponder Responder;
+    if (!TestTrue(TEXT("The responder starts on a free port"), Responder.Start(0))){
+        return false;
+    }
+    const uint64 SessionKey = FSessionReservationClient::MakeSessionKey(TEXT("ReservationSlotTest"));
+    Responder.SetSessionCapacity(SessionKey, 2, 0);
+    const int32 Port = Responder.GetPort();
+
+    const FSessionReservationRequest First = MakeRequest(Port, SessionKey);
+    const FSessionReservationRequest Second = MakeRequest(Port, SessionKey);
+    const FSessionReservationRequest Third = MakeRequest(Port, SessionKey);
+    FSessionReservationReply Reply = FSessionReservationClient::SendRequest(First, ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("The first client is granted a slot"), Reply.Result == ESessionReservationResult::Granted);
+    TestEqual(TEXT("One slot is left after the first reservation"), Reply.OpenSlots, 1);
+    TestEqual(TEXT("The answer carries the capacity"), Reply.MaxSlots, 2);
+    Reply = FSessionReservationClient::SendRequest(Second, ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("The second client is granted the last slot"), Reply.Result == ESessionReservationResult::Granted);
+    TestEqual(TEXT("No slot is left after the second reservation"), Reply.OpenSlots, 0);
+
+    // At capacity
+    Reply = FSessionReservationClient::SendRequest(Third, ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("The third client is turned away at capacity"), Reply.Result == ESessionReservationResult::Full);
+    TestEqual(TEXT("The host has no open slot"), Responder.GetOpenSlots(SessionKey), 0);
+    // A retransmitted request finds its reservation rather than taking another slot
+    Reply = FSessionReservationClient::SendRequest(Second, ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("A retransmitted request is granted again"), Reply.Result == ESessionReservationResult::Granted);
+    TestEqual(TEXT("A retransmitted request doesn't take another slot"), Reply.OpenSlots, 0);
+
+    // After a cancellation
+    Reply = FSessionReservationClient::SendRequest(First, ESessionReservationOp::Cancel, 3, 1.f);
+    TestTrue(TEXT("The cancellation is acknowledged"), Reply.Result == ESessionReservationResult::Granted);
+    TestEqual(TEXT("The cancelled slot is open again"), Reply.OpenSlots, 1);
+    Reply = FSessionReservationClient::SendRequest(Third, ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("The third client is granted the cancelled slot"), Reply.Result == ESessionReservationResult::Granted);
+    TestEqual(TEXT("No slot is left after the cancelled slot is granted"), Reply.OpenSlots, 0);
+
+    // An arriving player takes up a held slot instead of a further one
+    Responder.SetSessionCapacity(SessionKey, 2, 1);
+    TestEqual(TEXT("An arriving player takes up a held slot"), Responder.GetOpenSlots(SessionKey), 0);
+    Reply = FSessionReservationClient::SendRequest(First, ESessionReservationOp::Query, 3, 1.f);
+    TestTrue(TEXT("A query is answered"), Reply.Result == ESessionReservationResult::Granted);
+    TestEqual(TEXT("A query reports the open slots"), Reply.OpenSlots, 0);
+    Responder.SetSessionCapacity(SessionKey, 2, 0);
+    TestEqual(TEXT("A leaving player opens a slot"), Responder.GetOpenSlots(SessionKey), 1);
+
+    // A session the host doesn't serve
+    Responder.RemoveSession(SessionKey);
+    Reply = FSessionReservationClient::SendRequest(MakeRequest(Port, SessionKey), ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("A removed session is unknown"), Reply.Result == ESessionReservationResult::UnknownSession);
+    TestEqual(TEXT("A removed session has no open slots"), Responder.GetOpenSlots(SessionKey), -1);
+    Responder.Shutdown();
+    return true;
+}
+
+
+/*
+A slot that isn't taken up by an arriving player is handed out again once it has been held for the hold time
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionReservationExpiryTest, "MultiplayerSessions.Reservation.Expiry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionReservationExpiryTest::RunTest(const FString &Parameters){
+    FSessionReservationResponder Responder;
+    if (!TestTrue(TEXT("The responder starts on a free port"), Responder.Start(0))){
+        return false;
+    }
+    const uint64 SessionKey = FSessionReservationClient::MakeSessionKey(TEXT("ReservationExpiryTest"));
+    Responder.SetSessionCapacity(SessionKey, 1, 0);
+    Responder.SetHoldSeconds(1.f);
+    FSessionReservationReply Reply = FSessionReservationClient::SendRequest(MakeRequest(Responder.GetPort(), SessionKey), ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("The slot is granted"), Reply.Result == ESessionReservationResult::Granted);
+    TestEqual(TEXT("The answer carries the hold time"), Reply.HoldSeconds, 1.f);
+    Reply = FSessionReservationClient::SendRequest(MakeRequest(Responder.GetPort(), SessionKey), ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("The held slot isn't granted to another client"), Reply.Result == ESessionReservationResult::Full);
+
+    FPlatformProcess::Sleep(1.2f);
+    TestEqual(TEXT("The held slot is open after the hold time"), Responder.GetOpenSlots(SessionKey), 1);
+    Reply = FSessionReservationClient::SendRequest(MakeRequest(Responder.GetPort(), SessionKey), ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("The expired slot is granted to another client"), Reply.Result == ESessionReservationResult::Granted);
+    Responder.Shutdown();
+    return true;
+}
+
+
+/*
+A host that doesn't answer gets the request once per attempt, and the client gives up after the timeout
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionReservationTimeoutTest, "MultiplayerSessions.Reservation.Timeout", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionReservationTimeoutTest::RunTest(const FString &Parameters){
+    // A socket that receives the requests but never answers them
+    ISocketSubsystem *SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+    FSocket *SilentSocket = FUdpSocketBuilder(TEXT("SilentReservationHost"))
+        .AsNonBlocking()
+        .BoundToAddress(FIPv4Address(127, 0, 0, 1))
+        .BoundToPort(0)
+        .Build();
+    if (!TestNotNull(TEXT("The silent host binds a socket"), SilentSocket)){
+        return false;
+    }
+    const FSessionReservationRequest Request = MakeRequest(SilentSocket->GetPortNo(), FSessionReservationClient::MakeSessionKey(TEXT("ReservationTimeoutTest")));
+
+    const int32 NumAttempts = 3;
+    const float TimeoutSeconds = 0.3f;
+    const double StartTime = FPlatformTime::Seconds();
+    const FSessionReservationReply Reply = FSessionReservationClient::SendRequest(Request, ESessionReservationOp::Reserve, NumAttempts, TimeoutSeconds);
+    const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+    TestTrue(TEXT("A host that doesn't answer is unreachable"), Reply.Result == ESessionReservationResult::Unreachable);
+    TestEqual(TEXT("An unreachable host reports no open slots"), Reply.OpenSlots, -1);
+    TestTrue(TEXT("The client waits for the whole timeout"), ElapsedSeconds >= TimeoutSeconds * 0.9);
+    TestTrue(TEXT("The client gives up soon after the timeout"), ElapsedSeconds < TimeoutSeconds + 0.5);
+
+    // Every attempt sent the request once
+    int32 NumReceived = 0;
+    uint8 Buffer[256];
+    int32 BytesRead = 0;
+    TSharedRef<FInternetAddr> Sender = SocketSubsystem->CreateInternetAddr();
+    while (SilentSocket->RecvFrom(Buffer, sizeof(Buffer), BytesRead, *Sender)){
+        ++NumReceived;
+    }
+    TestEqual(TEXT("The request is sent once per attempt"), NumReceived, NumAttempts);
+    SilentSocket->Close();
+    SocketSubsystem->DestroySocket(SilentSocket);
+
+    // Requests that can't be sent are unreachable right away
+    FSessionReservationRequest AddresslessRequest = Request;
+    AddresslessRequest.Address.Reset();
+    TestTrue(TEXT("A request without an address is unreachable"), FSessionReservationClient::SendRequest(AddresslessRequest, ESessionReservationOp::Reserve, NumAttempts, TimeoutSeconds).Result == ESessionReservationResult::Unreachable);
+    TestTrue(TEXT("A request without attempts is unreachable"), FSessionReservationClient::SendRequest(Request, ESessionReservationOp::Reserve, 0, TimeoutSeconds).Result == ESessionReservationResult::Unreachable);
+    return true;
+}
+
+
+/*
+The clients behind one address hold no more slots than the limit, even while the session has open slots
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionReservationAddressLimitTest, "MultiplayerSessions.Reservation.AddressLimit", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionReservationAddressLimitTest::RunTest(const FString &Parameters){
+    FSessionReservationResponder Responder;
+    if (!TestTrue(TEXT("The responder starts on a free port"), Responder.Start(0))){
+        return false;
+    }
+    const uint64 SessionKey = FSessionReservationClient::MakeSessionKey(TEXT("ReservationAddressLimitTest"));
+    Responder.SetSessionCapacity(SessionKey, 8, 0);
+    Responder.SetMaxReservationsPerAddress(2);
+    const int32 Port = Responder.GetPort();
+
+    const FSessionReservationRequest First = MakeRequest(Port, SessionKey);
+    const FSessionReservationRequest Second = MakeRequest(Port, SessionKey);
+    const FSessionReservationRequest Third = MakeRequest(Port, SessionKey);
+    TestTrue(TEXT("The first slot is granted"), FSessionReservationClient::SendRequest(First, ESessionReservationOp::Reserve, 3, 1.f).Result == ESessionReservationResult::Granted);
+    TestTrue(TEXT("The second slot is granted"), FSessionReservationClient::SendRequest(Second, ESessionReservationOp::Reserve, 3, 1.f).Result == ESessionReservationResult::Granted);
+    FSessionReservationReply Reply = FSessionReservationClient::SendRequest(Third, ESessionReservationOp::Reserve, 3, 1.f);
+    TestTrue(TEXT("A third slot for the same address is turned away"), Reply.Result == ESessionReservationResult::Full);
+    TestEqual(TEXT("The session still has open slots"), Reply.OpenSlots, 6);
+    TestTrue(TEXT("A retransmitted request is still granted"), FSessionReservationClient::SendRequest(Second, ESessionReservationOp::Reserve, 3, 1.f).Result == ESessionReservationResult::Granted);
+
+    // A slot given back can be held again
+    FSessionReservationClient::SendRequest(First, ESessionReservationOp::Cancel, 3, 1.f);
+    TestTrue(TEXT("The address is granted a slot after giving one back"), FSessionReservationClient::SendRequest(Third, ESessionReservationOp::Reserve, 3, 1.f).Result == ESessionReservationResult::Granted);
+    Responder.Shutdown();
+    return true;
+}
+
+
+/*
+Clients reserving at the same time never get more slots than the session has
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSessionReservationConcurrencyTest, "MultiplayerSessions.Reservation.Concurrency", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSessionReservationConcurrencyTest::RunTest(const FString &Parameters){
+    const int32 NumSlots = 8;
+    const int32 NumClients = 32;
+    FSessionReservationResponder Responder;
+    if (!TestTrue(TEXT("The responder starts on a free port"), Responder.Start(0))){
+        return false;
+    }
+    const uint64 SessionKey = FSessionReservationClient::MakeSessionKey(TEXT("ReservationConcurrencyTest"));
+    Responder.SetSessionCapacity(SessionKey, NumSlots, 0);
+    // Every client sends from localhost
+    Responder.SetMaxReservationsPerAddress(0);
+    const int32 Port = Responder.GetPort();
+
+    FThreadSafeCounter NumGranted;
+    FThreadSafeCounter NumFull;
+    FThreadSafeCounter NumUnreachable;
+    ParallelFor(NumClients, [&](int32 Index){
+        const FSessionReservationReply Reply = FSessionReservationClient::SendRequest(MakeRequest(Port, SessionKey), ESessionReservationOp::Reserve, 3, 1.f);
+        switch (Reply.Result){
+            case ESessionReservationResult::Granted:
+                NumGranted.Increment();
+                break;
+            case ESessionReservationResult::Full:
+                NumFull.Increment();
+                break;
+            default:
+                NumUnreachable.Increment();
+                break;
+        }
+    });
+    TestEqual(TEXT("Every slot is granted exactly once"), NumGranted.GetValue(), NumSlots);
+    TestEqual(TEXT("Every other client is turned away"), NumFull.GetValue(), NumClients - NumSlots);
+    TestEqual(TEXT("Every client gets an answer"), NumUnreachable.GetValue(), 0);
+    TestEqual(TEXT("No slot is left"), Responder.GetOpenSlots(SessionKey), 0);
+    Responder.Shutdown();
+    return true;
+}
+
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
+#include "Containers/Ticker.h"
+
+
+// Name the loopback backend reports as its online subsystem
+#define LOOPBACK_SUBSYSTEM FName(TEXT("Loopback"))
+
+
+/*
+Behaviour of the loopback session backend, read from the [MultiplayerSessions.Loopback] section of the game ini and overridable on the command line (e.g. -LoopbackLatencyMs=200)
+*/
+struct MENUSYSTEM_API FLoopbackSessionConfig{
+	// Latency of every request until it completes, in milliseconds
+	float LatencyMs = 50.f;
+	// Random latency added on top (uniformly between zero and this), in milliseconds
+	float LatencyJitterMs = 20.f;
+	// Probability of a request landing in the latency tail
+	float TailProbability = 0.f;
+	// Latency added to the requests landing in the tail, in milliseconds
+	float TailLatencyMs = 1000.f;
+	// Probability of a packet getting lost, lost requests are retransmitted while lost search results never arrive
+	float LossRatio = 0.f;
+	// Time until a lost request is retransmitted, in milliseconds
+	float RetransmitDelayMs = 500.f;
+	// Probability of a request failing
+	float ErrorRate = 0.f;
+	// Number of search results delivered at once, zero delivers them all together
+	int32 ResultBatchSize = 0;
+	// Time between two batches of search results, in milliseconds
+	float ResultBatchIntervalMs = 20.f;
+	// Probability of a search completing before all of its results have been delivered
+	float PartialResultRate = 0.f;
+	// Address the hosts are reached at
+	FString HostAddress = TEXT("127.0.0.1");
+	// Port the hosts are reached at
+	int32 GamePort = 7777;
+
+	// Function to read the configuration from the game ini and the command line
+	static FLoopbackSessionConfig Load();
+};
+
+
+/*
+In-process session backend, the sessions live in a registry shared by every loopback interface of the process (e.g. all PIE instances), so that create/find/join/destroy work without any online service
+*/
+class MENUSYSTEM_API FLoopbackSessionInterface : public IOnlineSession{
+public:
+	FLoopbackSessionInterface(const FLoopbackSessionConfig &InConfig = FLoopbackSessionConfig());
+	virtual ~FLoopbackSessionInterface();
+
+	// Replace the behaviour of the backend, requests in flight keep their timing
+	void SetConfig(const FLoopbackSessionConfig &InConfig);
+	// Behaviour of the backend
+	const FLoopbackSessionConfig &GetConfig() const{
+		return Config;
+	}
+	// Function to complete the requests whose latency has passed right away rather than on the next tick of the core ticker, e.g. to drive the backend from an automation test
+	void FlushRequests(){
+		TickRequests(0.f);
+	}
+
+	//~ Begin IOnlineSession Interface
+	virtual FUniqueNetIdPtr CreateSessionIdFromString(const FString &SessionIdStr) override;
+	virtual FNamedOnlineSession *GetNamedSession(FName SessionName) override;
+	virtual void RemoveNamedSession(FName SessionName) override;
+	virtual bool HasPresenceSession() override;
+	virtual EOnlineSessionState::Type GetSessionState(FName SessionName) const override;
+	virtual bool CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings &NewSessionSettings) override;
+	virtual bool CreateSession(const FUniqueNetId &HostingPlayerId, FName SessionName, const FOnlineSessionSettings &NewSessionSettings) override;
+	virtual bool StartSession(FName SessionName) override;
+	virtual bool UpdateSession(FName SessionName, FOnlineSessionSettings &UpdatedSessionSettings, bool bShouldRefreshOnlineData = true) override;
+	virtual bool EndSession(FName SessionName) override;
+	virtual bool DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate &CompletionDelegate = FOnDestroySessionCompleteDelegate()) override;
+	virtual bool IsPlayerInSession(FName SessionName, const FUniqueNetId &UniqueId) override;
+	virtual bool StartMatchmaking(const TArray<FUniqueNetIdRef> &LocalPlayers, FName SessionName, const FOnlineSessionSettings &NewSessionSettings, TSharedRef<FOnlineSessionSearch> &SearchSettings) override;
+	virtual bool CancelMatchmaking(int32 SearchingPlayerNum, FName SessionName) override;
+	virtual bool CancelMatchmaking(const FUniqueNetId &SearchingPlayerId, FName SessionName) override;
+	virtual bool FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch> &SearchSettings) override;
+	virtual bool FindSessions(const FUniqueNetId &SearchingPlayerId, const TSharedRef<FOnlineSessionSearch> &SearchSettings) override;
+	virtual bool FindSessionById(const FUniqueNetId &SearchingUserId, const FUniqueNetId &SessionId, const FUniqueNetId &FriendId, const FOnSingleSessionResultCompleteDelegate &CompletionDelegate) override;
+	virtual bool CancelFindSessions() override;
+	virtual bool PingSearchResults(const FOnlineSessionSearchResult &SearchResult) override;
+	virtual bool JoinSession(int32 PlayerNum, FName SessionName, const FOnlineSessionSearchResult &DesiredSession) override;
+	virtual bool JoinSession(const FUniqueNetId &PlayerId, FName SessionName, const FOnlineSessionSearchResult &DesiredSession) override;
+	virtual bool FindFriendSession(int32 LocalUserNum, const FUniqueNetId &Friend) override;
+	virtual bool FindFriendSession(const FUniqueNetId &LocalUserId, const FUniqueNetId &Friend) override;
+	virtual bool FindFriendSession(const FUniqueNetId &LocalUserId, const TArray<FUniqueNetIdRef> &FriendList) override;
+	virtual bool SendSessionInviteToFriend(int32 LocalUserNum, FName SessionName, const FUniqueNetId &Friend) override;
+	virtual bool SendSessionInviteToFriend(const FUniqueNetId &LocalUserId, FName SessionName, const FUniqueNetId &Friend) override;
+	virtual bool SendSessionInviteToFriends(int32 LocalUserNum, FName SessionName, const TArray<FUniqueNetIdRef> &Friends) override;
+	virtual bool SendSessionInviteToFriends(const FUniqueNetId &LocalUserId, FName SessionName, const TArray<FUniqueNetIdRef> &Friends) override;
+	virtual bool GetResolvedConnectString(FName SessionName, FString &ConnectInfo, FName PortType = NAME_GamePort) override;
+	virtual bool GetResolvedConnectString(const FOnlineSessionSearchResult &SearchResult, FName PortType, FString &ConnectInfo) override;
+	virtual FOnlineSessionSettings *GetSessionSettings(FName SessionName) override;
+	virtual FString GetVoiceChatRoomName(int32 LocalUserNum, const FName &SessionName) override;
+	virtual bool RegisterPlayer(FName SessionName, const FUniqueNetId &PlayerId, bool bWasInvited) override;
+	virtual bool RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef> &Players, bool bWasInvited = false) override;
+	virtual bool UnregisterPlayer(FName SessionName, const FUniqueNetId &PlayerId) override;
+	virtual bool UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef> &Players) override;
+	virtual void RegisterLocalPlayer(const FUniqueNetId &PlayerId, FName SessionName, const FOnRegisterLocalPlayerCompleteDelegate &Delegate) override;
+	virtual void UnregisterLocalPlayer(const FUniqueNetId &PlayerId, FName SessionName, const FOnUnregisterLocalPlayerCompleteDelegate &Delegate) override;
+	virtual void RemovePlayerFromSession(int32 LocalUserNum, FName SessionName, const FUniqueNetId &TargetPlayerId) override;
+	virtual int32 GetNumSessions() override;
+	virtual void DumpSessionState() override;
+	//~ End IOnlineSession Interface
+
+protected:
+	//~ Begin IOnlineSession Interface
+	virtual FNamedOnlineSession *AddNamedSession(FName SessionName, const FOnlineSessionSettings &SessionSettings) override;
+	virtual FNamedOnlineSession *AddNamedSession(FName SessionName, const FOnlineSession &Session) override;
+	//~ End IOnlineSession Interface
+
+private:
+	/*
+	Simulated network
+	*/
+	// A request waiting for its simulated latency to pass
+	struct FPendingRequest{
+		// Time (in seconds) at which the request completes
+		double DueTime;
+		// Function completing the request
+		TFunction<void()> Complete;
+	};
+	// Function to complete a request once the simulated latency has passed
+	void ScheduleRequest(double DelaySeconds, TFunction<void()> Complete);
+	// Function to sample the latency of a request, including retransmissions of lost packets, in seconds
+	double SampleLatency() const;
+	// Function to roll whether a request fails
+	bool RollError() const;
+	// Function to complete the requests whose latency has passed
+	bool TickRequests(float DeltaTime);
+
+	/*
+	Session search
+	*/
+	// Function to deliver a batch of search results and complete the search after the last one
+	void DeliverSearchResults(int32 SearchSerial, TArray<FOnlineSessionSearchResult> Results, int32 FirstResult, bool bWasSuccessful);
+
+	// Behaviour of the backend
+	FLoopbackSessionConfig Config;
+	// Sessions this interface has created or joined
+	TArray<FNamedOnlineSession> Sessions;
+	// Requests waiting for their latency to pass, in the order they were made
+	TArray<FPendingRequest> PendingRequests;
+	// Ticker completing the requests
+	FTSTicker::FDelegateHandle TickerHandle;
+	// Search that is running, if any
+	TSharedPtr<FOnlineSessionSearch> CurrentSessionSearch;
+	// Serial of the running search, so that the batches of a cancelled search are dropped
+	int32 CurrentSearchSerial{0};
+};
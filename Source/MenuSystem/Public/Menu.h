@@ -25,6 +25,16 @@ private:
 	FString MatchType{TEXT("FreeForAll")};
 	// Lobby path
 	FString PathToLobby{TEXT("")}; // Initialize it with empty string so that we can give this a valid value later
+	// Package name of the lobby map
+	FString LobbyPackageName{TEXT("")};
+	// Seconds to search for a session to join before giving up
+	float JoinSearchTimeout{10.f};
+	// Maximum number of search results when looking for a session to join
+	int32 MaxJoinSearchResults{10000};
+	// Whether the host travels to the lobby seamlessly, keeping the player controller and the net driver instead of reloading everything
+	bool bUseSeamlessTravel{false};
+	// Whether the menu has already been removed and its callbacks unbound
+	bool bIsTornDown{false};
 
 	// Link to the HostButton that exists on widget blueprint
 	UPROPERTY(meta = (BindWidget)) // While using BindWidget meta specifier, note that the variable has to have the same name as the button on widget blueprint
@@ -42,6 +52,12 @@ private:
 	UFUNCTION() // Because we're binding this to an OnClickedEvent or delegate that exists in the new button in class
 	void JoinButtonClicked();
 
+	// Function to build the filter of the sessions we're willing to join
+	FSessionSearchFilter MakeJoinFilter() const;
+
+	// Function to travel to the lobby seamlessly as a listen server, returns false without touching the menu if the travel couldn't be started
+	bool ServerTravelSeamless(UWorld *World);
+
 protected:
 	// Override the inherited 'Initialize' virtual function on UUserWidget class to bind callback functions, this is because that `Initialize` is kind of like the constructor which will create the widget
 	virtual bool Initialize() override;
@@ -54,8 +70,6 @@ protected:
 	UFUNCTION() // Because we're binding this to a dynamic multicast delegate
 	void OnCreateSession(bool bWasSuccessful);
 	// Callback function which will be called when delegate is broadcast
-	void OnFindSessions(const TArray<FOnlineSessionSearchResult> &SessionResults, bool bWasSuccessful);
-	// Callback function which will be called when delegate is broadcast
 	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
 	// Callback function which will be called when delegate is broadcast
 	UFUNCTION()
@@ -67,10 +81,10 @@ protected:
 public:
 	// Blueprint callable function to setup menu
 	UFUNCTION(BlueprintCallable)
-	void MenuSetup(int32 NumberOfPublicConnections = 4, FString TypeOfMatch = FString(TEXT("FreeForAll")), FString LobbyPath = FString(TEXT("/Game/ThirdPerson/Maps/Lobby"))); // By giving default values, inputs won't be requirements
+	void MenuSetup(int32 NumberOfPublicConnections = 4, FString TypeOfMatch = FString(TEXT("FreeForAll")), FString LobbyPath = FString(TEXT("/Game/ThirdPerson/Maps/Lobby")), bool bPrefetchSessions = false, bool bSeamlessTravel = false); // By giving default values, inputs won't be requirements, prefetching keeps the sessions to join warm while the menu is open, seamless travel goes through the transition map of the project (see README)
 
 private:
-	// Function to remove the widget from the viewport and reset the input mode
+	// Function to remove the widget from the viewport, reset the input mode and unbind the callbacks, safe to call more than once
 	void MenuTearDown();
 
 protected:
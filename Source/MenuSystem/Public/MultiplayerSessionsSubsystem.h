@@ -5,6 +5,20 @@
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "Containers/Ticker.h"
+#include "HAL/ThreadSafeBool.h"
+
+#include "SessionSearchFilter.h"
+#include "SessionSearchCache.h"
+#include "SessionRanking.h"
+#include "SessionLatencyProbe.h"
+#include "SessionReservations.h"
+#include "SessionOperation.h"
+#include "SessionStats.h"
+#include "SessionObjectPool.h"
+#include "SessionKnownHostLookup.h"
+#include "SessionSearchSnapshot.h"
+#include "SessionMatchmaker.h"
 
 // Header files with '.generated' should be put in the end
 #include "MultiplayerSessionsSubsystem.generated.h"
@@ -23,9 +37,20 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam( // No worry if having red squiggles
 // Declare a multicast delegate that is capable of binding a function that takes two parameters
 DECLARE_MULTICAST_DELEGATE_TwoParams(
 	FMultiplayerOnFindSessionsComplete, // Decide on a name for the delegate
-	const TArray<FOnlineSessionSearchResult>& SessionResults, // Indicate the first input parameter of the function that can be bound to the delegate
+	const FSessionSearchSnapshot& SessionResults, // Indicate the first input parameter of the function that can be bound to the delegate, an immutable snapshot that can be held without copying the results
 	bool bWasSuccessful // Indicate the second input parameter of the function that can be bound to the delegate
 );
+// Declare a multicast delegate that is capable of binding a function that takes three parameters
+DECLARE_MULTICAST_DELEGATE_ThreeParams(
+	FMultiplayerOnFindSessionsPage, // Decide on a name for the delegate
+	TArrayView<const FOnlineSessionSearchResult> PageResults, // Indicate the first input parameter, a view into the search results so that pages are never copied
+	int32 PageIndex, // Indicate the second input parameter, zero-based index of the page
+	bool bIsLastPage // Indicate the third input parameter, true once the search has finished
+);
+// Declare a multicast delegate that is capable of binding a function that takes no parameters
+DECLARE_MULTICAST_DELEGATE(
+	FMultiplayerOnFindSessionsSuperseded // Decide on a name for the delegate
+);
 // Declare a multicast delegate that is capable of binding a function that takes one parameter
 DECLARE_MULTICAST_DELEGATE_OneParam(
 	FMultiplayerOnJoinSessionsComplete, // Decide on a name for the delegate
@@ -43,6 +68,126 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam( // No worry if having red squiggles
 	bool, // Indicate the input parameter type of the function that can be bound to the delegate
 	bWasSuccessful // Provide a name for the input parameter
 );
+// Declare a multicast delegate that is capable of binding a function that takes three parameters
+DECLARE_MULTICAST_DELEGATE_ThreeParams(
+	FMultiplayerOnSessionOperationComplete, // Decide on a name for the delegate
+	FName SessionName, // Indicate the first input parameter, name of the session the operation worked on
+	ESessionOperationType OperationType, // Indicate the second input parameter, kind of the operation
+	bool bWasSuccessful // Indicate the third input parameter, whether the operation succeeded
+);
+
+
+/*
+Results of a completed session search while they are filtered, deduplicated and ranked on a worker thread. The game thread doesn't touch it until the worker hands it back
+*/
+struct FSessionSearchProcessing{
+	// Raw results the backend delivered, emptied by the worker so that their storage can go back to the search object
+	TArray<FOnlineSessionSearchResult> SearchResults;
+	// Index of the first raw result that hasn't been run through the filter yet, the earlier ones were collected while polling
+	int32 FirstUnfilteredResult{0};
+	// Filter of the search
+	FSessionSearchFilter Filter;
+	// Whether the backend applies the criteria on advertised settings itself
+	bool bBackendFiltersSettings{false};
+	// Copies of the ranking weights and preferences at the time the search completed
+	FSessionRankingWeights RankingWeights;
+	FSessionRankingPreferences RankingPreferences;
+	// Revision of the ranking weights and preferences that were copied
+	uint32 RankingRevision{0};
+	// Whether the backend reported success
+	bool bWasSuccessful{false};
+	// Ids of the known hosts, the ones that show up in the results are reported back
+	TSet<FString> KnownHostIds;
+	// Set by the game thread once the search has been aborted or superseded, the worker stops at the next check
+	FThreadSafeBool bIsCancelled;
+
+	// Filtered and deduplicated results, starting with the ones collected while polling
+	TArray<FOnlineSessionSearchResult> Results;
+	// Ids of the sessions in Results, starting with the ones collected while polling
+	TSet<FString> SeenSessionIds;
+	// Indices into Results, best ranked first
+	TArray<int32> RankedOrder;
+	// Estimated size (in bytes) of what the backend delivered
+	int64 PayloadBytes{0};
+	// Indices into Results of the known hosts that showed up
+	TArray<int32> SeenKnownHosts;
+};
+
+
+/*
+A session operation waiting in the operation queue
+*/
+struct FSessionOperation{
+	// Kind of the operation
+	ESessionOperationType Type{ESessionOperationType::Find};
+	// Name of the session the operation works on
+	FName SessionName{NAME_GameSession};
+	// Time (in seconds) the operation was handed to the backend, negative until then
+	double BeginTime{-1.0};
+
+	/*
+	Create
+	*/
+	// Number of public connections of the session to create
+	int32 NumPublicConnections{0};
+	// Match type of the session to create
+	FString MatchType;
+	// Whether the session that existed under the same name has already been destroyed for this creation
+	bool bHasDestroyedExistingSession{false};
+	// Port the match instance of the session listens on, 0 to let clients use the port of the backend
+	int32 MatchPort{0};
+
+	/*
+	Find
+	*/
+	// Query of the search
+	FSessionSearchQuery Query;
+	// Whether the search only refreshes the cache
+	bool bIsBackground{false};
+	// Number of results per page, 0 means the search isn't paged
+	int32 PageSize{0};
+	// Whether the search is a quick join
+	bool bIsQuickJoin{false};
+	// Time (in seconds) at which the quick join gives up
+	double QuickJoinDeadline{0.0};
+
+	/*
+	Join
+	*/
+	// Search result of the session to join
+	FOnlineSessionSearchResult SessionResult;
+	// Whether the joint is one of the candidates of a failover, so that a full or unreachable session makes way for the next one
+	bool bIsFailoverJoin{false};
+};
+
+
+/*
+State of a named session the subsystem works on, every named session runs its operations independently of the others
+*/
+struct FNamedSessionState{
+	// Name of the session
+	FName SessionName;
+	// Settings the session was last created with
+	TSharedPtr<FOnlineSessionSettings> Settings;
+	// Which kind of operation on the session is waiting for the backend
+	ESessionOperationState OperationState{ESessionOperationState::Idle};
+	// Operation on the session that is waiting for the backend
+	FSessionOperation ActiveOperation;
+	// Multicast delegate to bind callback functions of the operations on this session
+	FMultiplayerOnSessionOperationComplete OnOperationComplete;
+
+	/*
+	Advertisement updates
+	*/
+	// Setting changes that haven't been sent to the backend yet, the latest value of a key wins
+	TMap<FName, FOnlineSessionSetting> DirtySettings;
+	// Number of public connections that hasn't been sent to the backend yet, negative if unchanged
+	int32 DirtyNumPublicConnections{-1};
+	// Whether the advertisement of the session has to be sent to the backend, e.g. since settings changed or players joined or left
+	bool bIsUpdatePending{false};
+	// Time (in seconds) before which the advertisement isn't sent to the backend again
+	double NextUpdateTime{0.0};
+};
 
 
 UCLASS()
@@ -52,17 +197,227 @@ class MENUSYSTEM_API UMultiplayerSessionsSubsystem : public UGameInstanceSubsyst
 public:
 	UMultiplayerSessionsSubsystem();
 
+	// Override the inherited 'Initialize' virtual function on USubsystem class to get the session interface and bind the session delegates
+	virtual void Initialize(FSubsystemCollectionBase &Collection) override;
+	// Override the inherited 'Deinitialize' virtual function on USubsystem class to unbind the session delegates and stop the tickers and threads owned by the subsystem
+	virtual void Deinitialize() override;
+
+	// Function to replace the session interface of the online subsystem, e.g. with an in-process mock, dropping the operations in flight
+	void SetSessionInterface(
+		IOnlineSessionPtr NewSessionInterface, // Specify the session interface to drive
+		FName NewSubsystemName // Specify the name of the online subsystem it belongs to, "Null" makes the sessions LAN sessions
+	);
+
 private:
 	// Smart pointer to hold the online session interface
 	IOnlineSessionPtr SessionInterface;
+	// Name of the online subsystem behind the session interface (e.g. "Steam" or "Null")
+	FName SubsystemName;
+	// Whether the session delegates are bound to SessionInterface
+	bool bAreSessionDelegatesBound{false};
+	// Whether the sessions are hosted by a dedicated server, which has no local player and advertises with the identity of the server
+	bool bIsDedicatedServer{false};
 
-	// TSharedPtr to store the session settings that we last created
-	TSharedPtr<FOnlineSessionSettings> LastSessionSettings;
+	// Named sessions the subsystem works on, held by pointer so that their state stays put while others are added
+	TMap<FName, TUniquePtr<FNamedSessionState>> NamedSessions;
 	// TSharedPtr to store the session search that we last used
 	TSharedPtr<FOnlineSessionSearch> LastSessionSearch;
 
 	/*
-	Session delegates to bind callback functions
+	Session search cache
+	*/
+	// Cached search results keyed by the query parameters
+	FSessionSearchCache SearchCache;
+	// Query of the search that is currently running on the backend
+	FSessionSearchQuery PendingSearchQuery;
+	// Whether the running search only refreshes the cache, in which case its results won't be broadcast
+	bool bIsBackgroundSearch{false};
+	// Results of the running search that satisfy its filter
+	TSharedPtr<TArray<FOnlineSessionSearchResult>> PendingSearchResults;
+	// Index of the first result of the running search that hasn't been run through the filter yet
+	int32 SearchFilterCursor{0};
+	// Ids of the sessions in PendingSearchResults, so that a session reported more than once is collected once
+	TSet<FString> PendingSearchSessionIds;
+	// Whether the backend applies the criteria on advertised settings itself
+	bool bBackendFiltersSettings{false};
+	// Results of the last finished (or cached) search that satisfy its filter
+	TSharedPtr<const TArray<FOnlineSessionSearchResult>> LastSearchResults;
+
+	/*
+	Paged session search
+	*/
+	// Number of results per page, 0 means the running search isn't paged
+	int32 SearchPageSize{0};
+	// Index of the first search result that hasn't been broadcast in a page yet
+	int32 SearchPageCursor{0};
+	// Index of the next page to be broadcast
+	int32 SearchPageIndex{0};
+	// Seconds between two polls of the running search for newly arrived results
+	float SearchPollInterval{0.05f};
+	// Handle of the ticker polling the running search
+	FTSTicker::FDelegateHandle SearchPollTickerHandle;
+
+	/*
+	Session ranking
+	*/
+	// Table that the search results get converted to for ranking, kept around so that its allocations are reused
+	FSessionRankingTable RankingTable;
+	// Weights of the ranking score
+	FSessionRankingWeights RankingWeights;
+	// What the local player prefers when ranking
+	FSessionRankingPreferences RankingPreferences;
+	// Revision of the ranking weights and preferences, bumped whenever either of them is set
+	uint32 RankingRevision{0};
+	// Results which the ranking was computed for on the worker thread, along with the ranking and its revision
+	TSharedPtr<const TArray<FOnlineSessionSearchResult>> RankedSearchResults;
+	TArray<int32> RankedSearchOrder;
+	uint32 RankedSearchRevision{0};
+
+	/*
+	Latency probing
+	*/
+	// Whether to probe the best ranked candidates before joining
+	bool bProbeBeforeJoin{false};
+	// Number of best ranked candidates to probe
+	int32 NumProbeCandidates{4};
+	// Number of probes sent to each candidate
+	int32 NumProbesPerCandidate{5};
+	// Seconds to wait for the probes to come back
+	float ProbeTimeout{0.5f};
+	// Milliseconds of latency that one millisecond of jitter is worth when re-ranking the candidates
+	float ProbeJitterWeight{2.f};
+	// Incremented by each probing stage, so that a stage which got superseded doesn't join
+	int32 ProbeStageSerial{0};
+
+	/*
+	Slot reservation
+	*/
+	// Probe responder of this host and the slots held on the hosts of the sessions being joined. Shared so that the answers of the hosts can tell whether it's still around
+	TSharedRef<FSessionReservations> Reservations{MakeShared<FSessionReservations>()};
+
+	/*
+	Quick join
+	*/
+	// Whether the running search joins the first session satisfying its filter instead of broadcasting its results
+	bool bIsQuickJoinActive{false};
+	// Time (in seconds) at which the quick join gives up
+	double QuickJoinDeadline{0.0};
+
+	/*
+	Known hosts
+	*/
+	// Sessions joined in earlier runs, which a quick join looks up by id alongside its search. Shared so that the lookups can tell whether it's still around
+	TSharedRef<FSessionKnownHostLookup> KnownHostLookup{MakeShared<FSessionKnownHostLookup>()};
+
+	/*
+	Rejoin
+	*/
+	// Search result of the session that was joined last, unset if there is nothing to rejoin
+	TOptional<FOnlineSessionSearchResult> LastJoinedResult;
+	// Address the session that was joined last resolved to
+	FString LastJoinedConnectString;
+	// Name the session that was joined last was joined under
+	FName LastJoinedSessionName{NAME_GameSession};
+	// Whether the queued joint is a rejoin, which travels to the session once it has been joined
+	bool bIsRejoinActive{false};
+	// Incremented by each rejoin and by the lookup completing it, so that a superseded lookup doesn't rejoin
+	int32 RejoinSerial{0};
+
+	/*
+	Map preload
+	*/
+	// Package that has been loaded ahead of traveling to it, referenced so that it isn't garbage collected until the travel has loaded its map
+	UPROPERTY()
+	UPackage *PreloadedPackage{nullptr};
+	// Name of the package being preloaded
+	FName PreloadingPackageName;
+	// Handle of the callback releasing the preloaded package once a map has been loaded
+	FDelegateHandle PostLoadMapDelegateHandle;
+
+	/*
+	Search prefetch
+	*/
+	// Whether searches are prefetched in the background
+	bool bIsPrefetchEnabled{false};
+	// Query of the prefetched searches
+	FSessionSearchQuery PrefetchQuery;
+	// Time (in seconds) between two prefetched searches
+	float PrefetchInterval{20.f};
+	// Longest time (in seconds) between two prefetched searches while they keep coming back empty
+	float PrefetchMaxInterval{160.f};
+	// Time (in seconds) until the next prefetched search, grows while the searches keep coming back empty
+	float CurrentPrefetchInterval{20.f};
+	// Time (in seconds) at which the next prefetched search is due
+	double NextPrefetchTime{0.0};
+	// Time (in seconds) between two checks whether a prefetched search is due
+	float PrefetchTickInterval{1.f};
+	// Handle of the prefetch ticker
+	FTSTicker::FDelegateHandle PrefetchTickerHandle;
+
+	/*
+	Session advertisement updates
+	*/
+	// Shortest time (in seconds) between two updates of a session's advertisement, the changes made in between go out together
+	float SessionUpdateInterval{5.f};
+	// Time (in seconds) between two checks whether an update is due
+	float SessionUpdateTickInterval{0.5f};
+	// Handle of the update ticker, only registered while updates are pending
+	FTSTicker::FDelegateHandle SessionUpdateTickerHandle;
+
+	/*
+	Matchmaking
+	*/
+	// Matchmaker the search results are indexed by, null to join the best ranked search result instead
+	TSharedPtr<FSessionMatchmaker> Matchmaker;
+	// Ticket of the local player waiting in the matchmaker, 0 if the player isn't waiting
+	int64 MatchmakingTicketId{0};
+	// Time (in seconds) after which the local player stops waiting
+	double MatchmakingDeadline{0.0};
+	// Whether the search prefetch was started to feed the matchmaker, so that it stops along with the matchmaking
+	bool bIsPrefetchingForMatchmaking{false};
+	// Time (in seconds) between two matchmaker ticks
+	float MatchmakingTickInterval{0.5f};
+	// Handle of the matchmaking ticker
+	FTSTicker::FDelegateHandle MatchmakingTickerHandle;
+
+	/*
+	Join failover
+	*/
+	// Ranked candidates of the last joint, tried one after another while they turn out to be full or unreachable
+	TArray<FOnlineSessionSearchResult> JoinCandidates;
+	// Index of the candidate being joined
+	int32 JoinCandidateCursor{0};
+	// Maximum number of candidates tried per joint
+	int32 MaxJoinAttempts{3};
+	// Time (in seconds) a joint may spend on failing over
+	float JoinFailoverTimeout{10.f};
+	// Time (in seconds) after which no further candidate is tried
+	double JoinFailoverDeadline{0.0};
+
+	/*
+	Operation queue
+	*/
+	// Operations waiting for their turn, an operation runs as soon as its session (or the search) is free and no earlier operation on it is waiting
+	TArray<FSessionOperation> PendingOperations;
+	// Whether a search is waiting for the backend, the backend runs one search at a time
+	bool bIsSearchInProgress{false};
+	// Results of the completed search being processed on a worker thread, the search counts as in progress until they are handed back
+	TSharedPtr<FSessionSearchProcessing, ESPMode::ThreadSafe> ActiveSearchProcessing;
+	// Time (in seconds) the running search was handed to the backend
+	double SearchBeginTime{-1.0};
+	// Whether the queue is being processed, so that operations enqueued by callbacks during processing don't process it recursively
+	bool bIsProcessingOperations{false};
+
+	/*
+	Instrumentation
+	*/
+	// Latency and outcome of the operations handed to the backend
+	FSessionStatsCollector Stats;
+	// Search and settings objects reused across searches and creations
+	FSessionObjectPool ObjectPool;
+
+	/*
+	Session delegates to bind callback functions, they stay bound from Initialize to Deinitialize and the completions are matched against the active operation
 	*/
 	// Delegate to bind callback function of session creation
 	FOnCreateSessionCompleteDelegate CreateSessionCompleteDelegate;
@@ -84,6 +439,10 @@ private:
 	FOnStartSessionCompleteDelegate StartSessionCompleteDelegate;
 	// DelegateHandle for StartSessionCompleteDelegate
 	FDelegateHandle StartSessionCompleteDelegateHandle;
+	// Delegate to bind callback function of session update
+	FOnUpdateSessionCompleteDelegate UpdateSessionCompleteDelegate;
+	// DelegateHandle for UpdateSessionCompleteDelegate
+	FDelegateHandle UpdateSessionCompleteDelegateHandle;
 
 public:
 	/*
@@ -93,20 +452,18 @@ public:
 	FMultiplayerOnCreateSessionComplete MultiplayerOnCreateSessionComplete;
 	// Multicast delegate to bind callback functions of session search result
 	FMultiplayerOnFindSessionsComplete MultiplayerOnFindSessionsComplete;
+	// Multicast delegate to bind callback functions of paged session search results
+	FMultiplayerOnFindSessionsPage MultiplayerOnFindSessionsPage;
+	// Multicast delegate to bind callback functions of session searches that were dropped before they completed, e.g. by QuickJoin, MultiplayerOnFindSessionsComplete isn't broadcast for them
+	FMultiplayerOnFindSessionsSuperseded MultiplayerOnFindSessionsSuperseded;
 	// Multicast delegate to bind callback functions of session joint result
 	FMultiplayerOnJoinSessionsComplete MultiplayerOnJoinSessionsComplete;
 	// Dynamic multicast delegate to bind callback ufunctions of session destruction result
 	FMultiplayerOnDestroySessionComplete MultiplayerOnDestroySessionComplete;
 	// Dynamic multicast delegate to bind callback ufunctions of session start result
 	FMultiplayerOnStartSessionComplete MultiplayerOnStartSessionComplete;
-
-private:
-	/*
-	Store these for the last session we failed to created
-	*/
-	bool bCreateSessionOnDestroy{false};
-	int32 LastNumPublicConnections;
-	FString LastMatchType;
+	// Multicast delegate to bind callback functions of the operations on any named session, the delegates above only report NAME_GameSession
+	FMultiplayerOnSessionOperationComplete MultiplayerOnSessionOperationComplete;
 
 public:
 	/*
@@ -115,20 +472,373 @@ public:
 	// Function to create game session
 	void CreateSession(
 		int32 NumPublicConnections, // Specify the number of players that can join the game
-		FString MatchType // Specify the match type
+		FString MatchType, // Specify the match type
+		FName SessionName = NAME_GameSession, // Specify the name of the session, e.g. NAME_PartySession next to the game session
+		int32 MatchPort = 0 // Specify the port of the match instance, so that several matches of one dedicated server process can be told apart
 	);
 	// Function to find game sessions
 	void FindSessions(
-		int32 MaxSearchResults // Specify the number of search results
+		int32 MaxSearchResults, // Specify the number of search results
+		const FSessionSearchFilter &Filter = FSessionSearchFilter() // Specify the criteria that the sessions have to satisfy
+	);
+	// Function to find game sessions and broadcast the results in pages as soon as enough of them have arrived, MultiplayerOnFindSessionsComplete still gets broadcast with all results at the end
+	void FindSessionsPaged(
+		int32 MaxSearchResults, // Specify the number of search results
+		int32 PageSize, // Specify the number of search results per page
+		const FSessionSearchFilter &Filter = FSessionSearchFilter() // Specify the criteria that the sessions have to satisfy
+	);
+	// Function to read a page of the last search results that satisfied the filter, returns the cursor of the next page or INDEX_NONE if there are no more results
+	int32 GetSearchResultsPage(
+		int32 Cursor, // Specify the index of the first result of the page
+		int32 PageSize, // Specify the number of search results per page
+		TArray<FOnlineSessionSearchResult> &OutPageResults // Filled in with the results of the page
+	) const;
+	// Function to get the last search results that satisfied the filter as a snapshot, which can be held and sliced into pages without copying
+	FSessionSearchSnapshot GetLastSearchResults() const;
+	// Function to join the first session that satisfies the filter as soon as it shows up, the running search gets cancelled (MultiplayerOnFindSessionsSuperseded) and MultiplayerOnJoinSessionsComplete is broadcast without broadcasting MultiplayerOnFindSessionsComplete
+	void QuickJoin(
+		const FSessionSearchFilter &Filter, // Specify the criteria that the session has to satisfy
+		float DeadlineSeconds, // Specify how long (in seconds) to search before giving up
+		int32 MaxSearchResults = 10000 // Specify the number of search results
 	);
 	// Function to join game session
 	void JoinSession(
-		const FOnlineSessionSearchResult &SessionResult
+		const FOnlineSessionSearchResult &SessionResult,
+		FName SessionName = NAME_GameSession // Specify the name to join the session under
 	);
 	// Function to destroy game session
-	void DestroySession();
+	void DestroySession(
+		FName SessionName = NAME_GameSession // Specify the name of the session
+	);
 	// Function to start game session
-	void StartSession();
+	void StartSession(
+		FName SessionName = NAME_GameSession // Specify the name of the session
+	);
+	// Function to get which kind of operation on a session is waiting for the backend
+	ESessionOperationState GetOperationState(FName SessionName = NAME_GameSession) const;
+	// Function to check whether a search is running on the backend
+	bool IsSearchInProgress() const{ return bIsSearchInProgress; }
+	// Function to get the settings a session was last created with, null if it hasn't been created by this subsystem
+	TSharedPtr<const FOnlineSessionSettings> GetSessionSettings(FName SessionName = NAME_GameSession) const;
+	// Function to get the multicast delegate reporting the operations on one session, bind right away since the reference isn't meant to be kept
+	FMultiplayerOnSessionOperationComplete &OnSessionOperationComplete(FName SessionName);
+	// Function to switch the dedicated server mode, which is on by default when running as a dedicated server
+	void SetDedicatedServer(bool bIsDedicated){ bIsDedicatedServer = bIsDedicated; }
+	// Function to check whether the sessions are hosted by a dedicated server
+	bool IsDedicatedServer() const{ return bIsDedicatedServer; }
+	// Function to get the address to travel to for a joined session, returns false if it can't be resolved
+	bool GetResolvedConnectString(
+		FString &OutAddress, // The address of the host
+		FName SessionName = NAME_GameSession // Specify the name of the joined session
+	) const;
+
+	/*
+	Session advertisement updates
+	*/
+	// Function to change a setting a hosted session advertises, e.g. the phase of the match, the change goes out with the next update
+	template<typename ValueType>
+	void SetSessionSetting(
+		FName Key, // Specify the key of the setting
+		const ValueType &Value, // Specify the new value, any type FVariantData can hold
+		FName SessionName = NAME_GameSession // Specify the name of the hosted session
+	){
+		FVariantData Data;
+		Data.SetValue(Value);
+		SetSessionSettingData(Key, Data, SessionName);
+	}
+	// Function to change the number of public connections of a hosted session, the change goes out with the next update
+	void SetSessionPublicConnections(
+		int32 NumPublicConnections, // Specify the number of players that can join the game
+		FName SessionName = NAME_GameSession // Specify the name of the hosted session
+	);
+	// Function to report that players joined or left a hosted session, so that the next update advertises the current number of open slots
+	void MarkSessionPlayersChanged(
+		FName SessionName = NAME_GameSession // Specify the name of the hosted session
+	);
+	// Function to set the shortest time between two updates of a session's advertisement
+	void SetSessionUpdateInterval(
+		float IntervalSeconds // Specify the time (in seconds), every change made within it is coalesced into one update
+	);
+
+	/*
+	Session ranking
+	*/
+	// Function to rank search results, fills in the indices of the K best results, best first
+	void RankSearchResults(
+		TArrayView<const FOnlineSessionSearchResult> Results, // Specify the search results to rank
+		int32 TopK, // Specify how many of the best results are wanted
+		TArray<int32> &OutResultIndices // Filled in with indices into Results
+	);
+	// Function to get the best of the search results, returns nullptr if there are none
+	const FOnlineSessionSearchResult *GetBestSearchResult(TArrayView<const FOnlineSessionSearchResult> Results);
+	// Function to set the weights of the ranking score
+	void SetRankingWeights(const FSessionRankingWeights &Weights){ RankingWeights = Weights; ++RankingRevision; }
+	// Function to set what the local player prefers when ranking
+	void SetRankingPreferences(const FSessionRankingPreferences &Preferences){ RankingPreferences = Preferences; ++RankingRevision; }
+
+	/*
+	Latency probing
+	*/
+	// Function to join the best of the search results, if latency probing is enabled the best ranked candidates get probed and re-ranked by their measured latency first
+	void JoinBestSearchResult(TArrayView<const FOnlineSessionSearchResult> Results);
+	// Function to start the probe responder on this host, port 0 picks a free port. Sessions created afterwards advertise the port so that clients can probe them
+	bool StartProbeResponder(int32 Port = 0);
+	// Function to stop the probe responder
+	void StopProbeResponder();
+	// Function to configure probing the best ranked candidates before joining
+	void SetLatencyProbing(
+		bool bEnabled, // Specify whether to probe before joining
+		int32 NumCandidates = 4, // Specify the number of best ranked candidates to probe
+		int32 NumProbes = 5, // Specify the number of probes sent to each candidate
+		float TimeoutSeconds = 0.5f // Specify how long to wait for the probes to come back
+	);
+	// Function to configure reserving a slot on the host before joining, so that a full host turns the player away before the joint and the travel
+	void SetSlotReservation(
+		bool bEnabled, // Specify whether to reserve before joining
+		int32 NumAttempts = 3, // Specify how many times the request is sent if no answer comes back
+		float TimeoutSeconds = 0.5f // Specify how long to wait for the host to answer
+	);
+	// Function to set how long the probe responder of this host holds a granted slot for a player who hasn't arrived yet.
+	// Anyone who can reach the responder and knows the session id can hold slots, so keep the hold short
+	void SetReservationHoldTime(float Seconds);
+	// Function to set how many slots of a hosted session the clients behind one IP address may hold at a time, 0 for no limit
+	void SetReservationLimitPerAddress(int32 MaxReservations);
+	// Function to get the number of slots of a hosted session that are neither taken nor reserved, negative if the session doesn't take reservations
+	int32 GetOpenReservableSlots(FName SessionName = NAME_GameSession);
+
+	// Function to configure failing over to the next best candidate when the joined session is full or unreachable
+	void SetJoinFailover(
+		int32 MaxAttempts, // Specify the maximum number of candidates to try, 1 disables the failover
+		float TimeoutSeconds // Specify how long to keep trying further candidates
+	);
+
+	/*
+	Matchmaking
+	*/
+	// Function to index the search results by a matchmaker, which then picks the sessions the local player joins through JoinViaMatchmaker. The subsystem ticks it, null to go back to the ranking
+	void SetMatchmaker(TSharedPtr<FSessionMatchmaker> NewMatchmaker);
+	// Function to get the matchmaker, e.g. to index sessions that are known from elsewhere
+	TSharedPtr<FSessionMatchmaker> GetMatchmaker() const{ return Matchmaker; }
+	// Function to wait in the matchmaker for a session and join it, the result is broadcast through MultiplayerOnJoinSessionsComplete
+	void JoinViaMatchmaker(
+		const FMatchmakingTicket &Ticket, // Specify the region, match type and skill of the local player
+		int32 MaxSearchResults, // Specify the maximum number of search results indexed per refresh
+		float TimeoutSeconds = 60.f // Specify how long to wait for a session
+	);
+	// Function to stop waiting in the matchmaker without broadcasting
+	void CancelMatchmaking();
+
+	/*
+	Known hosts
+	*/
+	// Function to get the sessions joined in earlier runs of a match type (any if empty), most recent first, e.g. to show them while the first search is running
+	void GetKnownHosts(const FString &MatchType, TArray<FKnownHost> &OutHosts) const;
+	// Function to forget the sessions joined in earlier runs
+	void ClearKnownHosts();
+	// Function to set how many of the most recently joined hosts a quick join looks up by id alongside its search, 0 to only search
+	void SetKnownHostLookups(int32 NumLookups){ KnownHostLookup->SetNumLookups(NumLookups); }
+
+	/*
+	Rejoin
+	*/
+	// Function to get back into the session that was joined last, e.g. after a disconnect. The session is looked up by id (where the backend supports it) rather than searched for, joined again and traveled to once the joint has confirmed it.
+	// The result is broadcast through MultiplayerOnJoinSessionsComplete, returns false if there is nothing to rejoin
+	bool Rejoin();
+	// Function to check whether there is a session to rejoin
+	bool CanRejoin() const{ return LastJoinedResult.IsSet(); }
+	// Function to forget the session that was joined last, e.g. when the player leaves it on purpose
+	void ForgetLastJoinedSession();
+
+	/*
+	Map preload
+	*/
+	// Function to load the package of a map asynchronously ahead of traveling to it, e.g. while the session is being created
+	void PreloadPackage(
+		const FString &PackagePath // Specify the long package name of the map, travel options (e.g. '?listen') are ignored
+	);
+	// Function to drop the reference to the preloaded package, e.g. when the travel isn't going to happen
+	void ReleasePreloadedPackage();
+
+	/*
+	Search prefetch
+	*/
+	// Function to keep the results of a search warm in the cache by refreshing them in the background, paused while a session exists
+	void StartSearchPrefetch(
+		int32 MaxSearchResults, // Specify the maximum number of search results
+		const FSessionSearchFilter &Filter, // Specify the filter of the search, same as the one the results will be used with
+		float IntervalSeconds = 20.f, // Specify the time between two searches
+		float MaxIntervalSeconds = 160.f // Specify the longest time between two searches while they keep coming back empty
+	);
+	// Function to stop prefetching searches
+	void StopSearchPrefetch();
+
+	/*
+	Session search cache configuration
+	*/
+	// Function to set how long (in seconds) cached search results are fresh and how long they may be served stale while being refreshed
+	void SetSearchCacheTTL(float FreshSeconds, float StaleSeconds);
+	// Function to drop all cached search results
+	void InvalidateSearchCache();
+
+	/*
+	Instrumentation
+	*/
+	// Function to copy the latency histograms and counters of the session operations
+	FSessionStatsSnapshot GetStatsSnapshot() const;
+	// Function to clear the latency histograms and counters of the session operations
+	void ResetStats();
+
+private:
+	/*
+	Known hosts
+	*/
+	// Function to look up the most recently joined hosts that satisfy the filter, the first one found is joined unless the quick join is over by then
+	void LookupKnownHosts(const FSessionSearchFilter &Filter);
+	// Function to join the known host that a lookup has found instead of the result of the search, returns false if the quick join is over
+	bool JoinKnownHost(const FOnlineSessionSearchResult &SearchResult);
+	// Function to check whether a quick join is searching or waiting to search
+	bool IsQuickJoinPending() const;
+
+	/*
+	Rejoin
+	*/
+	// Callback function which will be called when the lookup of the session to rejoin completes
+	void OnRejoinSessionFound(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult &SearchResult, int32 Serial);
+	// Function to travel back to the confirmed session, or join it first if the local session is gone
+	void ResumeRejoin(const FOnlineSessionSearchResult &SessionResult);
+	// Function to travel the first local player to a joined session, returns false if there is no address or player controller
+	bool TravelToJoinedSession(FName SessionName);
+
+	/*
+	Map preload
+	*/
+	// Callback function which will be called when a map has been loaded
+	void OnPostLoadMap(UWorld *LoadedWorld);
+
+	/*
+	Search prefetch
+	*/
+	// Function to start a prefetched search when it's due
+	bool TickSearchPrefetch(float DeltaTime);
+	// Function to schedule the next prefetched search after one has completed
+	void OnPrefetchSearchComplete(int32 NumResults, bool bWasSuccessful);
+
+	// Ticker function to let the matchmaker assign the waiting players and join the session assigned to the local player, returns whether to keep ticking
+	bool TickMatchmaking(float DeltaTime);
+
+	/*
+	Join failover
+	*/
+	// Function to join the first of the ranked candidates, failing over to the next ones
+	void JoinWithFailover(TArray<FOnlineSessionSearchResult> Candidates);
+	// Function to join the next candidate, returns false if the candidates, the attempts or the time are used up
+	bool JoinNextCandidate();
+	// Function to join the next candidate after a failed joint if the failure allows it, or broadcast the result of the joint otherwise
+	void FailOverOrBroadcastJoin(FName SessionName, bool bIsFailoverJoin, bool bCanFailOver, EOnJoinSessionCompleteResult::Type Result);
+	// Function to queue the joint of a session
+	void EnqueueJoinSession(const FOnlineSessionSearchResult &SessionResult, bool bIsFailoverJoin, FName SessionName = NAME_GameSession);
+
+	/*
+	Operation queue
+	*/
+	// Function to bind the session delegates to the session interface
+	void BindSessionDelegates();
+	// Function to unbind the session delegates from the session interface
+	void UnbindSessionDelegates();
+	// Function to add an operation to the queue, coalescing it with the operations that are already queued, and process the queue
+	void EnqueueOperation(FSessionOperation Operation);
+	// Function to run queued operations until one of them waits for the backend
+	void ProcessOperationQueue();
+	// Function to send an operation to the backend, returns whether it's now waiting for the backend
+	bool ExecuteOperation(const FSessionOperation &Operation);
+	// Function to get the unique net id of the first local player, null on a dedicated server or before the login
+	FUniqueNetIdPtr GetLocalPlayerNetId() const;
+	// Function to get the state of a named session, adding it if it isn't tracked yet
+	FNamedSessionState &GetOrAddNamedSession(FName SessionName);
+	// Function to find the state of a named session, null if it isn't tracked
+	FNamedSessionState *FindNamedSession(FName SessionName);
+	// Function to mark an operation on a session as waiting for the backend
+	void BeginSessionOperation(FNamedSessionState &SessionState, const FSessionOperation &Operation, ESessionOperationState OperationState);
+	// Function to mark the operation on a session as complete, the queue gets processed by the caller once it's done broadcasting
+	void CompleteSessionOperation(FNamedSessionState &SessionState, bool bWasSuccessful);
+	// Function to complete the operation on a session as failed after the backend refused it, returns false if the completion delegate has completed it already (the caller then has nothing left to broadcast)
+	bool CompleteRefusedOperation(FNamedSessionState &SessionState, ESessionOperationState OperationState);
+	// Function to find the session whose operation of the given kind is waiting for the backend, null if the completion isn't ours
+	FNamedSessionState *FindWaitingSession(FName SessionName, ESessionOperationState OperationState);
+	// Function to broadcast the completion of a create, destroy, start or update operation to the subscribers of the session and of all sessions
+	void BroadcastSessionOperation(FName SessionName, ESessionOperationType OperationType, bool bWasSuccessful);
+	// Function to broadcast the completion of a joint to the subscribers of the session and of all sessions
+	void BroadcastJoinSession(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
+	// Function to send a session creation to the backend
+	bool ExecuteCreateSession(const FSessionOperation &Operation);
+	// Function to send a session joint to the backend
+	bool ExecuteJoinSession(const FSessionOperation &Operation);
+	// Function to send the joint that is waiting on a session to the backend, after the slot reservation if there was one
+	bool SendJoinSession(FNamedSessionState &SessionState);
+	// Function to reserve a slot on the host of the session being joined, returns false if the host doesn't take reservations
+	bool BeginJoinReservation(FNamedSessionState &SessionState);
+	// Function to be called once the host answered the reservation (or didn't)
+	void OnJoinReservationComplete(FName SessionName, const FSessionReservationReply &Reply);
+	// Function to drop a joint that a full host turned away before it reached the backend, only that session is marked as full
+	void OnJoinReservationDenied(FNamedSessionState &SessionState);
+	// Function to hand the current capacity of a hosted session to the probe responder, so that it takes reservations for the session
+	void UpdateReservableSession(FName SessionName);
+	// Function to send a session destruction to the backend
+	bool ExecuteDestroySession(const FSessionOperation &Operation);
+	// Function to send a session start to the backend
+	bool ExecuteStartSession(const FSessionOperation &Operation);
+	// Function to drop the creation that was pipelined behind the destruction of a session, in case the destruction failed
+	void DropPipelinedCreation(FName SessionName);
+	// Function to send the advertisement of a session with its pending changes to the backend
+	bool ExecuteUpdateSession(const FSessionOperation &Operation);
+
+	// Function to record a setting change of a hosted session
+	void SetSessionSettingData(FName Key, const FVariantData &Data, FName SessionName);
+	// Function to mark the advertisement of a session as pending and make sure the update ticker runs
+	void MarkSessionUpdatePending(FNamedSessionState &SessionState);
+	// Function to apply the pending changes of a session to its settings
+	void ApplyDirtySettings(FNamedSessionState &SessionState);
+	// Function to forget the pending changes of a session
+	void DiscardDirtySettings(FNamedSessionState &SessionState);
+	// Ticker function to queue the updates that are due, returns whether to keep ticking
+	bool TickSessionUpdates(float DeltaTime);
+	// Function to stop the update ticker
+	void StopSessionUpdates();
+
+	// Function to join the candidate with the lowest measured latency
+	void JoinProbedCandidates(const TArray<FOnlineSessionSearchResult> &Candidates, const TArray<FSessionProbeResult> &ProbeResults);
+	// Function to build the query for a session search
+	FSessionSearchQuery MakeSearchQuery(int32 MaxSearchResults, const FSessionSearchFilter &Filter) const;
+	// Function to answer a session search from the cache or send it to the backend
+	void RequestSessionSearch(const FSessionSearchQuery &Query, int32 PageSize);
+	// Function to refresh stale cached results with a background search, unless a search is running already
+	void EnqueueCacheRefresh(const FSessionSearchQuery &Query);
+	// Function to send the session search to the backend, returns whether it's now waiting for the backend
+	bool StartSessionSearch(const FSessionSearchQuery &Query, bool bIsBackground);
+	// Function to hand the results of the search that just completed to a worker thread
+	void ProcessSessionSearch(bool bWasSuccessful);
+	// Function to filter, deduplicate and rank the results of a completed search, runs on a worker thread
+	static void ProcessSearchResults(FSessionSearchProcessing &Processing);
+	// Function to record that a session has been seen by the running search, returns false if it has been seen already. Some backends report the same session more than once, e.g. when it's reachable through several relays
+	static bool MarkSessionSeen(TSet<FString> &SeenSessionIds, const FString &SessionId);
+	// Function to cache and broadcast the processed results of the search that just completed
+	void FinishSessionSearch(FSessionSearchProcessing &Processing);
+	// Function to broadcast full pages of the results starting at PageCursor, and the remaining results as the last page if the search is finished
+	void BroadcastSearchPages(const TArray<FOnlineSessionSearchResult> &Results, int32 PageSize, int32 &PageCursor, int32 &PageIndex, bool bIsSearchFinished);
+	// Function to run the newly arrived results of the running search through its filter
+	void CollectSearchResults();
+	// Function to cancel the running search without broadcasting its results
+	void AbortSessionSearch();
+	// Function to make the worker thread drop the results it is processing
+	void CancelSearchProcessing();
+	// Function to join the first collected result or give up once the deadline has passed, returns whether the quick join is over
+	bool UpdateQuickJoin();
+	// Ticker function to broadcast newly arrived results of the running search, returns whether to keep ticking
+	bool PollSessionSearch(float DeltaTime);
+	// Function to start polling the running search if it's paged
+	void StartSearchPolling();
+	// Function to stop polling the running search
+	void StopSearchPolling();
 
 protected:
 	/*
@@ -144,4 +854,6 @@ protected:
 	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful);
 	// Callback function which will be called in response to successfully start the game session
 	void OnStartSessionComplete(FName SessionName, bool bWasSuccessful);
+	// Callback function which will be called in response to successfully update the game session
+	void OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful);
 };
@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "Blueprint/IUserObjectListEntry.h"
+
+#include "MultiplayerSessionsSubsystem.h"
+
+// Header files with '.generated' should be put in the end
+#include "SessionBrowser.generated.h"
+
+
+/*
+Columns the server browser can be sorted by
+*/
+UENUM(BlueprintType)
+enum class ESessionBrowserColumn : uint8{
+	ServerName,
+	MatchType,
+	Players,
+	Ping
+};
+
+
+/*
+Session shown in the server browser, items are reused across searches so that a refresh only touches the rows whose session changed
+*/
+UCLASS(BlueprintType)
+class MENUSYSTEM_API USessionBrowserItem : public UObject{
+	GENERATED_BODY()
+
+public:
+	// Id of the session, identifies the item across searches
+	UPROPERTY(BlueprintReadOnly)
+	FString SessionId;
+	// Name of the host
+	UPROPERTY(BlueprintReadOnly)
+	FString ServerName;
+	// Advertised match type
+	UPROPERTY(BlueprintReadOnly)
+	FString MatchType;
+	// Number of players in the session
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumPlayers{0};
+	// Number of public connections of the session
+	UPROPERTY(BlueprintReadOnly)
+	int32 MaxPlayers{0};
+	// Ping in milliseconds, negative if unknown
+	UPROPERTY(BlueprintReadOnly)
+	int32 PingMs{-1};
+
+	// Search result to join the session with
+	FOnlineSessionSearchResult SearchResult;
+	// Search in which the session was last seen, the items not seen by the latest search get removed
+	uint32 SearchGeneration{0};
+	// Multicast delegate broadcast when the shown values change, so that the row showing the item refreshes itself
+	FSimpleMulticastDelegate OnItemChanged;
+
+	// Function to take over the values of a search result, returns whether any shown value changed
+	bool UpdateFrom(const FOnlineSessionSearchResult &Result);
+};
+
+
+/*
+Row of the server browser, the list view creates only as many rows as are visible and hands them different items while scrolling
+*/
+UCLASS()
+class MENUSYSTEM_API USessionBrowserRow : public UUserWidget, public IUserObjectListEntry{
+	GENERATED_BODY()
+
+protected:
+	// Link to the text blocks that exist on widget blueprint, each of them is optional
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UTextBlock *ServerNameText;
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock *MatchTypeText;
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock *PlayersText;
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock *PingText;
+
+	// Item the row shows
+	UPROPERTY()
+	USessionBrowserItem *Item;
+	// Handle of the callback refreshing the row when its item changes
+	FDelegateHandle ItemChangedHandle;
+
+	/*
+	IUserObjectListEntry implementation
+	*/
+	virtual void NativeOnListItemObjectSet(UObject *ListItemObject) override;
+	virtual void NativeOnEntryReleased() override;
+
+	// Function to show the values of the item
+	void RefreshRow();
+	// Function to stop listening to the item
+	void ReleaseItem();
+};
+
+
+UCLASS()
+class MENUSYSTEM_API USessionBrowser : public UUserWidget{
+	GENERATED_BODY()
+
+private:
+	// The subsystem designed to handle all online session functionality
+	UMultiplayerSessionsSubsystem *MultiplayerSessionsSubsystem;
+
+	// Maximum number of search results
+	int32 MaxSearchResults{10000};
+	// Match type to show, empty to show every match type
+	FString MatchType{TEXT("")};
+	// Whether the browser has already been removed and its callbacks unbound
+	bool bIsTornDown{false};
+
+	/*
+	Items
+	*/
+	// Items in the order they are shown
+	UPROPERTY()
+	TArray<USessionBrowserItem*> Items;
+	// Items by session id, for the diff against a new search
+	TMap<FString, USessionBrowserItem*> ItemsById;
+	// Items of sessions that went away, reused for the sessions that show up
+	UPROPERTY()
+	TArray<USessionBrowserItem*> ItemPool;
+	// Generation of the latest search
+	uint32 SearchGeneration{0};
+
+	/*
+	Incremental update
+	*/
+	// Results of the latest search that haven't been applied to the items yet
+	FSessionSearchSnapshot PendingResults;
+	// Index of the next pending result to apply
+	int32 PendingResultCursor{INDEX_NONE};
+	// Whether the applied results added or removed items, or changed a value the list is sorted by
+	bool bIsOrderDirty{false};
+	// Time (in seconds) per frame spent on applying results, the rest carries over to the next frame
+	double UpdateBudgetSeconds{0.002};
+
+	/*
+	Sorting
+	*/
+	// Column the list is sorted by
+	ESessionBrowserColumn SortColumn{ESessionBrowserColumn::Ping};
+	// Whether the list is sorted in ascending order
+	bool bIsSortAscending{true};
+
+	// Link to the list view that exists on widget blueprint, its entry widget class has to be a USessionBrowserRow
+	UPROPERTY(meta = (BindWidget))
+	class UListView *SessionList;
+	// Link to the buttons that exist on widget blueprint, each of them is optional
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UButton *RefreshButton;
+	UPROPERTY(meta = (BindWidgetOptional))
+	UButton *JoinButton;
+	UPROPERTY(meta = (BindWidgetOptional))
+	UButton *ServerNameHeaderButton;
+	UPROPERTY(meta = (BindWidgetOptional))
+	UButton *MatchTypeHeaderButton;
+	UPROPERTY(meta = (BindWidgetOptional))
+	UButton *PlayersHeaderButton;
+	UPROPERTY(meta = (BindWidgetOptional))
+	UButton *PingHeaderButton;
+
+	// Callback functions which will be called when the buttons are clicked
+	UFUNCTION()
+	void RefreshButtonClicked();
+	UFUNCTION()
+	void JoinButtonClicked();
+	UFUNCTION()
+	void ServerNameHeaderClicked();
+	UFUNCTION()
+	void MatchTypeHeaderClicked();
+	UFUNCTION()
+	void PlayersHeaderClicked();
+	UFUNCTION()
+	void PingHeaderClicked();
+	// Callback function which will be called when a row is double-clicked
+	void OnItemDoubleClicked(UObject *ListItemObject);
+
+	// Function to apply pending results until the time budget of this frame is used up, returns whether all of them have been applied
+	bool ApplyPendingResults(double Deadline);
+	// Function to remove the items whose session wasn't seen by the latest search
+	void RemoveStaleItems();
+	// Function to sort the items by the current column and hand them to the list view
+	void SortItems();
+	// Function to join the session of an item
+	void JoinItem(USessionBrowserItem *Item);
+
+protected:
+	// Override the inherited 'Initialize' virtual function on UUserWidget class to bind callback functions
+	virtual bool Initialize() override;
+	// Override the inherited 'NativeTick' virtual function on UUserWidget class to apply the pending results within the frame budget
+	virtual void NativeTick(const FGeometry &MyGeometry, float InDeltaTime) override;
+	// Override the inherited 'NativeDestruct' virtual function on UUserWidget class to call BrowserTearDown function
+	virtual void NativeDestruct() override;
+
+	/*
+	Callbacks for the custom delegates on the MultiplayerSessionsSubsystem
+	*/
+	// Callback function which will be called when delegate is broadcast
+	void OnFindSessions(const FSessionSearchSnapshot &SessionResults, bool bWasSuccessful);
+	// Callback function which will be called when delegate is broadcast
+	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
+
+public:
+	// Blueprint callable function to setup the browser, shows the cached results right away and refreshes them
+	UFUNCTION(BlueprintCallable)
+	void BrowserSetup(int32 NumberOfSearchResults = 10000, FString TypeOfMatch = FString(TEXT("")));
+	// Blueprint callable function to sort the list, sorting by the current column again flips the order
+	UFUNCTION(BlueprintCallable)
+	void SortBy(ESessionBrowserColumn Column);
+	// Blueprint callable function to search for sessions again
+	UFUNCTION(BlueprintCallable)
+	void Refresh();
+
+private:
+	// Function to remove the widget from the viewport, reset the input mode and unbind the callbacks, safe to call more than once
+	void BrowserTearDown();
+};
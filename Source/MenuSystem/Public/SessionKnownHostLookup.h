@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "SessionKnownHosts.h"
+#include "SessionSearchFilter.h"
+
+
+/*
+Keeps the sessions joined in earlier runs on disk and looks them up by id while a quick join is searching, so that a returning player can join one of them before the search has come back
+*/
+class MENUSYSTEM_API FSessionKnownHostLookup : public TSharedFromThis<FSessionKnownHostLookup>{
+public:
+	// Function to read the known hosts from a file, which they're written back to whenever they change. Nothing is recorded without a file (e.g. on a dedicated server)
+	void Load(const FString &InFilePath);
+	// Function to write the known hosts back to their file, if they have one
+	void Save();
+
+	// Function to look up the most recently joined hosts that satisfy the filter, superseding the earlier lookups. The first host found is handed to OnFound on the game thread, which returns whether it was taken
+	void Start(
+		const IOnlineSessionPtr &SessionInterface, // Specify the session interface to look the hosts up with
+		const FUniqueNetId &SearchingPlayerId, // Specify the player looking the hosts up
+		const FSessionSearchFilter &Filter, // Specify the criteria that the hosts have to satisfy
+		TFunction<bool(const FOnlineSessionSearchResult&)> OnFound // Called with the first host found
+	);
+	// Function to stop the running lookups from reporting
+	void Cancel(){ ++LookupSerial; }
+	// Function to set how many of the most recently joined hosts are looked up, 0 to only search
+	void SetNumLookups(int32 InNumLookups){ NumLookups = FMath::Max(InNumLookups, 0); }
+
+	// Function to remember a session that has just been joined, joins are rare so the file is written right away rather than risking to lose the host to a crash
+	void RecordJoin(const FOnlineSessionSearchResult &SessionResult, const FString &ConnectString);
+	// Function to refresh a session that a search has reported
+	void RecordSeen(const FOnlineSessionSearchResult &SearchResult);
+	// Function to forget a session, e.g. because it doesn't exist anymore
+	void Forget(const FString &SessionId){ Hosts.Forget(SessionId); }
+	// Function to forget every session and stop the running lookups
+	void Reset();
+
+	// Function to get the known sessions
+	const FSessionKnownHosts &GetHosts() const { return Hosts; }
+
+	// Function to check whether the backend of the online subsystem can look sessions up by id, the Null and Steam subsystems fail every lookup right away
+	static bool DoesBackendFindSessionsById(FName SubsystemName);
+
+private:
+	// Callback function which will be called when the lookup of a known host completes
+	void OnHostFound(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult &SearchResult, int32 Serial, FSessionSearchFilter Filter, TFunction<bool(const FOnlineSessionSearchResult&)> OnFound);
+
+	// Sessions joined in earlier runs
+	FSessionKnownHosts Hosts;
+	// Path of the known hosts file, empty if the known hosts aren't persisted
+	FString FilePath;
+	// Number of the most recently joined hosts a quick join looks up by id
+	int32 NumLookups{3};
+	// Incremented by each lookup and by the host that gets taken, so that superseded lookups don't report
+	int32 LookupSerial{0};
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/*
+Session that has been joined before
+*/
+struct FKnownHost{
+	// Id of the session
+	FString SessionId;
+	// Address the session resolved to when it was joined
+	FString ConnectString;
+	// Round trip time (in milliseconds) last measured to the host, negative if unknown
+	float LastRttMs{-1.f};
+	// Advertised match type
+	FString MatchType;
+	// Unix time (in seconds) the session was last joined or seen by a search
+	int64 Timestamp{0};
+};
+
+
+/*
+Compact on-disk cache of the sessions that have been joined recently, so that a returning player can be offered them before a search has come back.
+The file is a versioned binary blob which is read with a single I/O call at startup and replaced atomically when saved
+*/
+class MENUSYSTEM_API FSessionKnownHosts{
+public:
+	// Function to read the cache file, returns false if it's missing, corrupt or of another version, in which case the cache starts out empty
+	bool Load(const FString &FilePath);
+	// Function to write the cache file if anything changed since it was loaded or saved
+	bool Save(const FString &FilePath);
+
+	// Function to remember a session that has just been joined
+	void RecordJoin(const FString &SessionId, const FString &ConnectString, const FString &MatchType, float RttMs);
+	// Function to refresh a session that a search has reported, returns false if it isn't known
+	bool RecordSeen(const FString &SessionId, float RttMs);
+	// Function to forget a session, e.g. because it doesn't exist anymore
+	void Forget(const FString &SessionId);
+	// Function to forget every session
+	void Reset();
+
+	// Function to get the known sessions of a match type (any match type if empty) that are younger than MaxAgeSeconds, most recent first
+	void GetHosts(const FString &MatchType, TArray<FKnownHost> &OutHosts) const;
+	// Function to get the ids of the known sessions
+	void GetSessionIds(TSet<FString> &OutSessionIds) const;
+	// Function to check whether a session is known
+	bool Contains(const FString &SessionId) const { return Hosts.Contains(SessionId); }
+	// Function to get the number of known sessions
+	int32 Num() const { return Hosts.Num(); }
+
+	// Default path of the cache file in the saved directory
+	static FString GetDefaultFilePath();
+
+	// Maximum number of sessions kept, the least recently used ones are dropped first
+	int32 MaxHosts{32};
+	// Time (in seconds) after which a session is no longer offered and gets dropped on save
+	int64 MaxAgeSeconds{7 * 24 * 60 * 60};
+
+private:
+	// Function to drop the sessions that are too old, and the least recently used ones beyond MaxHosts
+	void Prune();
+
+	// Known sessions by id
+	TMap<FString, FKnownHost> Hosts;
+	// Whether the sessions changed since they were loaded or saved
+	bool bIsDirty{false};
+};
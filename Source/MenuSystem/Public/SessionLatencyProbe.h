@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+
+
+class FSocket;
+class FRunnableThread;
+class FInternetAddr;
+
+
+/*
+Host to be probed
+*/
+struct FSessionProbeTarget{
+	// Address (IP and probe port) of the probe responder of the host, null if the host can't be probed
+	TSharedPtr<FInternetAddr> Address;
+};
+
+
+/*
+Outcome of probing a host
+*/
+struct FSessionProbeResult{
+	// Whether at least one probe came back
+	bool bWasReachable{false};
+	// Mean round-trip time in milliseconds
+	float RoundTripMs{0.f};
+	// Mean difference between consecutive round-trip times in milliseconds
+	float JitterMs{0.f};
+	// Share of probes that didn't come back, between 0 and 1
+	float LossRatio{1.f};
+};
+
+
+/*
+Small UDP echo server that a host embeds so that clients can measure their latency to it before joining
+*/
+class MENUSYSTEM_API FSessionProbeResponder : public FRunnable{
+public:
+	virtual ~FSessionProbeResponder();
+
+	// Function to bind the socket and start the responder thread, port 0 picks a free port, returns whether the responder is running
+	bool Start(int32 Port);
+	// Function to stop the responder thread and close the socket
+	void Shutdown();
+	// Function to get the port the responder is bound to, 0 if it isn't running
+	int32 GetPort() const { return BoundPort; }
+	// Function to check whether the responder is running
+	bool IsRunning() const { return Thread != nullptr; }
+
+	/*
+	FRunnable implementation
+	*/
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+protected:
+	// Function to answer a datagram from Sender, returns the number of bytes to send back (0 to drop it). Derived responders extend the protocol by overriding this
+	virtual int32 HandleDatagram(uint8 *Data, int32 NumBytes, int32 BufferSize, const FInternetAddr &Sender);
+
+private:
+	// Socket the responder listens on
+	FSocket *Socket{nullptr};
+	// Thread the responder runs on
+	FRunnableThread *Thread{nullptr};
+	// Port the socket is bound to
+	int32 BoundPort{0};
+	// Set to stop the responder thread
+	FThreadSafeBool bIsStopping{false};
+};
+
+
+/*
+Sends bursts of UDP echo probes to several hosts concurrently from a worker thread
+*/
+class MENUSYSTEM_API FSessionLatencyProber{
+public:
+	// Function to probe every target concurrently, the callback is called on the game thread with one result per target (in the order of the targets)
+	static void ProbeTargets(
+		const TArray<FSessionProbeTarget> &Targets, // Specify the hosts to probe
+		int32 NumProbes, // Specify how many probes to send to each host
+		float TimeoutSeconds, // Specify how long to wait for the probes to come back
+		TFunction<void(const TArray<FSessionProbeResult>&)> OnComplete // Called with the results
+	);
+
+	// Function to probe a single target on the calling thread, blocks for at most TimeoutSeconds
+	static FSessionProbeResult ProbeTarget(const FSessionProbeTarget &Target, int32 NumProbes, float TimeoutSeconds);
+
+	// Function to build the probe address from the connect string of a session ("ip:port") and the advertised probe port, returns null if the connect string isn't an IP address
+	static TSharedPtr<FInternetAddr> MakeProbeAddress(const FString &ConnectString, int32 ProbePort);
+
+private:
+	// Function to probe every target at once on the calling thread, sending to all of them from one socket and matching the echoes by target and probe number. Blocks for at most TimeoutSeconds
+	static TArray<FSessionProbeResult> ProbeTargetsOnThisThread(const TArray<FSessionProbeTarget> &Targets, int32 NumProbes, float TimeoutSeconds);
+};
@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+
+
+/*
+How the matchmaker groups sessions and players and how far it looks beyond the bucket of a waiting player
+*/
+struct FMatchmakingSettings{
+	// Width of a skill band, players and sessions whose skill falls into the same band share a bucket
+	int32 SkillBandWidth{100};
+	// Time (in seconds) a player waits before the search widens by one more skill band on either side
+	float SkillWideningInterval{10.f};
+	// Maximum number of skill bands the search widens by on either side
+	int32 MaxSkillWidening{5};
+	// Time (in seconds) a player waits before sessions of every region are considered, negative to never leave the region
+	float AnyRegionDelay{30.f};
+};
+
+
+/*
+Player waiting for a session
+*/
+struct FMatchmakingTicket{
+	// Region the player wants to play in, empty for any region
+	FString Region;
+	// Match type the player wants to play
+	FString MatchType;
+	// Skill rating of the player
+	int32 Skill{0};
+};
+
+
+/*
+Session the matchmaker has picked for a waiting player, a slot of it is reserved for the player
+*/
+struct FMatchmakingAssignment{
+	// Id of the ticket handed out when the player was enqueued
+	int64 TicketId{0};
+	// Id of the session the player has been assigned to
+	FString SessionId;
+};
+
+
+/*
+Bucket of the matchmaking index, the strings are compared ignoring case (as is their hash), so that a hash collision never merges two buckets
+*/
+struct FMatchmakingBucketKey{
+	// Region, empty for the bucket holding every region
+	FString Region;
+	// Match type
+	FString MatchType;
+	// Skill band, i.e. the skill divided by the band width
+	int32 SkillBand{0};
+
+	bool operator==(const FMatchmakingBucketKey &Other) const{
+		return SkillBand == Other.SkillBand && Region.Equals(Other.Region, ESearchCase::IgnoreCase) && MatchType.Equals(Other.MatchType, ESearchCase::IgnoreCase);
+	}
+
+	friend uint32 GetTypeHash(const FMatchmakingBucketKey &Key){
+		return HashCombine(HashCombine(::GetTypeHash(Key.Region), ::GetTypeHash(Key.MatchType)), ::GetTypeHash(Key.SkillBand));
+	}
+};
+
+
+/*
+Matchmaker keeping an index of open sessions and waiting players, bucketed by region, match type and skill band.
+It only depends on Core and the session types, so it runs inside a game client as well as inside a headless server
+*/
+class MENUSYSTEM_API FSessionMatchmaker{
+public:
+	explicit FSessionMatchmaker(const FMatchmakingSettings &InSettings = FMatchmakingSettings());
+
+	/*
+	Open sessions
+	*/
+	// Function to add a session to the index or refresh what is known about it, a session without open slots stays known but isn't assigned to
+	void AddOrUpdateSession(
+		const FString &SessionId, // Specify the id of the session
+		const FString &Region, // Specify the region the session is hosted in
+		const FString &MatchType, // Specify the match type of the session
+		int32 Skill, // Specify the skill rating of the session
+		int32 OpenSlots // Specify the number of open public connections
+	);
+	// Function to add a search result to the index, reading the "Region", "MatchType" and "Skill" session settings
+	void AddOrUpdateSession(const FOnlineSessionSearchResult &SearchResult);
+	// Function to remove a session from the index
+	void RemoveSession(const FString &SessionId);
+	// Function to stop assigning players to a session that turned a player away, it stays known until a search reports it anew
+	void MarkSessionFull(const FString &SessionId);
+	// Function to get the search result a session was added with, null if it was added without one or isn't indexed
+	const FOnlineSessionSearchResult *GetSearchResult(const FString &SessionId) const;
+
+	/*
+	Waiting players
+	*/
+	// Function to enqueue a player, returns the id of its ticket
+	int64 EnqueuePlayer(const FMatchmakingTicket &Ticket, double Now);
+	// Function to take a player out of the queue
+	void CancelPlayer(int64 TicketId);
+	// Function to assign the waiting players to sessions, oldest first, and reserve their slots
+	void Tick(double Now, TArray<FMatchmakingAssignment> &OutAssignments);
+	// Function to find the session for a player without enqueueing it, returns false if no session is in reach yet
+	bool FindSession(
+		const FMatchmakingTicket &Ticket, // Specify the player
+		float WaitSeconds, // Specify how long the player has been waiting, which widens the search
+		FString &OutSessionId // The id of the session
+	) const;
+	// Function to get the number of players waiting in the bucket of a ticket, e.g. to decide whether to open another match instance
+	int32 GetNumWaitingPlayers(const FMatchmakingTicket &Ticket) const;
+
+	// Function to get the number of indexed sessions
+	int32 NumSessions() const { return Sessions.Num(); }
+	// Function to get the number of waiting players
+	int32 NumWaitingPlayers() const { return WaitingPlayers.Num(); }
+	// Function to forget every session and player
+	void Reset();
+
+private:
+	/*
+	Index entries
+	*/
+	// Session as it is indexed
+	struct FIndexedSession{
+		// Bucket of the session's region
+		FMatchmakingBucketKey Key;
+		// Number of open public connections, reservations included
+		int32 OpenSlots{0};
+		// Search result the session was added with, if any
+		TOptional<FOnlineSessionSearchResult> SearchResult;
+	};
+	// Entry of a bucket, the entries are kept sorted so that the fullest session comes first
+	struct FBucketEntry{
+		int32 OpenSlots{0};
+		FString SessionId;
+
+		bool operator<(const FBucketEntry &Other) const{
+			return OpenSlots != Other.OpenSlots ? OpenSlots < Other.OpenSlots : SessionId < Other.SessionId;
+		}
+	};
+	// Player waiting for a session
+	struct FWaitingPlayer{
+		int64 TicketId{0};
+		FMatchmakingTicket Ticket;
+		double EnqueueTime{0.0};
+	};
+
+	// Function to get the bucket key of a region, match type and skill
+	FMatchmakingBucketKey MakeKey(const FString &Region, const FString &MatchType, int32 Skill) const;
+	// Function to insert a session into its region's bucket and into the bucket holding every region
+	void InsertIntoBuckets(const FString &SessionId, const FIndexedSession &Session);
+	// Function to remove a session from both of its buckets
+	void RemoveFromBuckets(const FString &SessionId, const FIndexedSession &Session);
+	// Function to get the fullest session of a bucket, null if the bucket is empty
+	const FBucketEntry *FindInBucket(const FMatchmakingBucketKey &Key) const;
+	// Function to take a slot of a session for an assigned player
+	void ReserveSlot(const FString &SessionId);
+
+	// Settings the matchmaker works with
+	FMatchmakingSettings Settings;
+	// Indexed sessions by id
+	TMap<FString, FIndexedSession> Sessions;
+	// Sorted entries of the sessions per bucket, every session is in the bucket of its region and in the one of every region
+	TMap<FMatchmakingBucketKey, TArray<FBucketEntry>> SessionBuckets;
+	// Players waiting for a session, oldest first
+	TArray<FWaitingPlayer> WaitingPlayers;
+	// Number of waiting players per bucket
+	TMap<FMatchmakingBucketKey, int32> WaitingCounts;
+	// Id of the next ticket
+	int64 NextTicketId{1};
+};
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+
+
+/*
+Pool of the search and settings objects handed to the backend. Objects are reset and reused rather than allocated for every search or creation,
+and the result storage of a search keeps its capacity, so that a client browsing repeatedly doesn't churn the heap
+*/
+class MENUSYSTEM_API FSessionObjectPool{
+public:
+	// Function to get a search object in its default state, bOutWasReused tells whether it came from the pool or had to be allocated
+	TSharedRef<FOnlineSessionSearch> AcquireSearch(bool &bOutWasReused);
+	// Function to hand a search object back and reset the pointer, the object is reused once the backend doesn't reference it anymore
+	void ReleaseSearch(TSharedPtr<FOnlineSessionSearch> &Search);
+	// Function to get a settings object in its default state, bOutWasReused tells whether it came from the pool or had to be allocated
+	TSharedRef<FOnlineSessionSettings> AcquireSettings(bool &bOutWasReused);
+	// Function to hand a settings object back and reset the pointer
+	void ReleaseSettings(TSharedPtr<FOnlineSessionSettings> &Settings);
+
+	// Function to get the number of bytes of result storage the pooled searches keep
+	int64 GetRetainedResultBytes() const;
+	// Function to free every pooled object
+	void Reset();
+
+	// Maximum number of pooled objects of each kind, one more than the backend holds on to is enough to always find a free one
+	int32 MaxPooledSearches{2};
+	int32 MaxPooledSettings{4};
+
+private:
+	// Function to put a search object back into its default state, keeping the capacity of its result storage
+	static void ResetSearch(FOnlineSessionSearch &Search);
+	// Function to put a settings object back into its default state, keeping the capacity of its settings map
+	static void ResetSettings(FOnlineSessionSettings &Settings);
+
+	// Search objects which have been released, some of them may still be referenced by the backend
+	TArray<TSharedRef<FOnlineSessionSearch>> Searches;
+	// Settings objects which have been released
+	TArray<TSharedRef<FOnlineSessionSettings>> SettingsObjects;
+};
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/*
+Kind of a session operation that goes through the backend
+*/
+enum class ESessionOperationType : uint8{
+	Create,
+	Find,
+	Join,
+	Destroy,
+	Start,
+	Update
+};
+
+// Number of entries in ESessionOperationType, used to size per-kind tables
+constexpr int32 NumSessionOperationTypes = 6;
+
+/*
+State of the operation queue, i.e. which kind of operation is waiting for the backend
+*/
+enum class ESessionOperationState : uint8{
+	Idle,
+	Creating,
+	Finding,
+	Joining,
+	Destroying,
+	Starting,
+	Updating
+};
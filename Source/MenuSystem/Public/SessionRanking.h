@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+class FOnlineSessionSearchResult;
+
+
+/*
+Weights of the terms that make up the score of a session, higher scores are better
+*/
+struct FSessionRankingWeights{
+	// Score lost per millisecond of ping
+	float Ping{1.f};
+	// Score gained by a full (but still joinable) session compared to an empty one, so that players end up in populated sessions
+	float FillRatio{60.f};
+	// Score gained by a session hosted in the preferred region
+	float RegionMatch{100.f};
+	// Score lost by a session of another match type than the preferred one
+	float MatchTypeMismatch{100000.f};
+	// Score lost by a session of another build than the preferred one, such a session can't be joined anyway
+	float BuildMismatch{1000000.f};
+	// Score lost by a session without open public connections
+	float NoOpenSlots{1000000.f};
+	// Ping (in milliseconds) assumed for results that don't report one
+	float UnknownPing{250.f};
+};
+
+
+/*
+What the local player prefers, empty values (or 0) mean no preference
+*/
+struct FSessionRankingPreferences{
+	// Preferred match type
+	FString MatchType;
+	// Preferred region, as advertised by the host in the "Region" session setting
+	FString Region;
+	// Preferred build id
+	int32 BuildUniqueId{0};
+};
+
+
+/*
+Compact structure-of-arrays table of the fields of search results that are relevant for ranking, scored by a branchless kernel which the compiler can vectorize
+*/
+class MENUSYSTEM_API FSessionRankingTable{
+public:
+	// Function to extract the ranking fields of the search results, the table keeps the indices into Results
+	void Build(TArrayView<const FOnlineSessionSearchResult> Results);
+
+	// Function to score every row of the table
+	void Score(const FSessionRankingWeights &Weights, const FSessionRankingPreferences &Preferences);
+
+	// Function to get the indices (into the results the table was built from) of the K best scored rows, best first
+	void GetTopK(int32 K, TArray<int32> &OutResultIndices) const;
+
+	// Function to get the number of rows
+	int32 Num() const { return Pings.Num(); }
+
+	// Function to get the score of a row
+	float GetScore(int32 Row) const { return Scores[Row]; }
+
+	// Function to drop all rows but keep the allocations for the next build
+	void Reset();
+
+private:
+	/*
+	One array per field, all of them have the same number of rows
+	*/
+	// Ping in milliseconds, negative if unknown
+	TArray<float> Pings;
+	// Number of open public connections
+	TArray<float> OpenConnections;
+	// Number of public connections
+	TArray<float> TotalConnections;
+	// Build id of the session
+	TArray<int32> BuildIds;
+	// Hash of the advertised match type
+	TArray<uint32> MatchTypeHashes;
+	// Hash of the advertised region
+	TArray<uint32> RegionHashes;
+	// Score of the row, valid after calling Score
+	TArray<float> Scores;
+};
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "SessionLatencyProbe.h"
+
+
+class FInternetAddr;
+
+
+/*
+Request a client sends to the reservation responder of a host
+*/
+enum class ESessionReservationOp : uint8{
+	// Hold a slot of the session for the client
+	Reserve,
+	// Give back a slot that was held for the client
+	Cancel,
+	// Only ask for the capacity of the session
+	Query
+};
+
+
+/*
+How the host answered a reservation request
+*/
+enum class ESessionReservationResult : uint8{
+	// A slot is held for the client (or the reservation was cancelled, or the capacity was queried)
+	Granted,
+	// Every slot is taken or held for other clients
+	Full,
+	// The host doesn't serve the session, e.g. it predates the reservations or has been restarted
+	UnknownSession,
+	// No answer came back in time
+	Unreachable
+};
+
+
+/*
+Slot reservation on the host of a session
+*/
+struct FSessionReservationRequest{
+	// Address (IP and probe port) of the reservation responder of the host
+	TSharedPtr<FInternetAddr> Address;
+	// Key of the session on the host, see FSessionReservationClient::MakeSessionKey
+	uint64 SessionKey{0};
+	// Id the client picked for the reservation, retransmitted requests with the same id are answered the same way
+	uint64 ReservationId{0};
+};
+
+
+/*
+Answer of the host to a reservation request
+*/
+struct FSessionReservationReply{
+	ESessionReservationResult Result{ESessionReservationResult::Unreachable};
+	// Number of slots that are neither taken nor held, after the request was handled. Negative if unknown
+	int32 OpenSlots{-1};
+	// Number of slots of the session, negative if unknown
+	int32 MaxSlots{-1};
+	// Time (in seconds) the host holds a granted slot before giving it to someone else
+	float HoldSeconds{0.f};
+};
+
+
+/*
+Probe responder that additionally holds slots of the hosted sessions for clients that are about to join, so that a full host turns them away before they join and load the map.
+Reservations that aren't taken up by an arriving player expire after the hold time
+*/
+class MENUSYSTEM_API FSessionReservationResponder : public FSessionProbeResponder{
+public:
+	// Join the responder thread here, the base destructor would run after the mutex and the sessions are gone while the thread may still be handling a datagram
+	virtual ~FSessionReservationResponder(){ Shutdown(); }
+
+	// Function to register a session or update its capacity, players that arrive take up the oldest reservations first
+	void SetSessionCapacity(
+		uint64 SessionKey, // Specify the key of the session
+		int32 MaxSlots, // Specify the number of public connections
+		int32 NumOccupied // Specify the number of players in the session
+	);
+	// Function to stop serving a session, e.g. because it has been destroyed
+	void RemoveSession(uint64 SessionKey);
+	// Function to get the number of slots that are neither taken nor held, negative if the session isn't served
+	int32 GetOpenSlots(uint64 SessionKey);
+	// Function to set how long (in seconds) a granted slot is held, i.e. how long a client may take to join and travel.
+	// Requests aren't authenticated: anyone who can reach the port and knows the session id can hold slots, up to the limit per address, for the hold time. Keep it short, it bounds how long such slots stay blocked
+	void SetHoldSeconds(float Seconds);
+	// Function to set how many slots of a session the clients behind one IP address may hold at a time, 0 for no limit
+	void SetMaxReservationsPerAddress(int32 MaxReservations);
+
+protected:
+	// Override the inherited 'HandleDatagram' virtual function to answer reservation requests, probes are still echoed
+	virtual int32 HandleDatagram(uint8 *Data, int32 NumBytes, int32 BufferSize, const FInternetAddr &Sender) override;
+
+private:
+	// Slot held for a client
+	struct FHeldSlot{
+		// Time (in seconds) the slot expires at
+		double ExpiryTime{0.0};
+		// Hash of the IP address the reservation came from
+		uint64 AddressHash{0};
+	};
+
+	// Session served by the responder
+	struct FReservableSession{
+		int32 MaxSlots{0};
+		int32 NumOccupied{0};
+		// Held slots by reservation id
+		TMap<uint64, FHeldSlot> Reservations;
+	};
+
+	// Function to drop the reservations that have expired
+	static void ExpireReservations(FReservableSession &Session, double Now);
+	// Function to get the number of slots that are neither taken nor held
+	static int32 CountOpenSlots(const FReservableSession &Session);
+	// Function to get the number of slots held for the clients behind an IP address
+	static int32 CountAddressReservations(const FReservableSession &Session, uint64 AddressHash);
+
+	// Guards the sessions, which the responder thread and the game thread both access
+	FCriticalSection Mutex;
+	// Served sessions by key
+	TMap<uint64, FReservableSession> Sessions;
+	// Time (in seconds) a granted slot is held
+	float HoldSeconds{15.f};
+	// Number of slots of a session the clients behind one IP address may hold at a time, 0 for no limit
+	int32 MaxReservationsPerAddress{4};
+};
+
+
+/*
+Client side of the reservation handshake
+*/
+class MENUSYSTEM_API FSessionReservationClient{
+public:
+	// Function to send a request on a worker thread, the callback is called on the game thread with the answer
+	static void SendRequestAsync(
+		const FSessionReservationRequest &Request, // Specify the host, session and reservation
+		ESessionReservationOp Op, // Specify what to ask for
+		int32 NumAttempts, // Specify how many times the request is sent if no answer comes back
+		float TimeoutSeconds, // Specify how long to wait for an answer in total
+		TFunction<void(const FSessionReservationReply&)> OnComplete // Called with the answer
+	);
+	// Function to send a request on the calling thread, blocks for at most TimeoutSeconds
+	static FSessionReservationReply SendRequest(const FSessionReservationRequest &Request, ESessionReservationOp Op, int32 NumAttempts, float TimeoutSeconds);
+	// Function to give back a reservation without waiting for the answer
+	static void Cancel(const FSessionReservationRequest &Request);
+
+	// Function to get the key of a session from its id, host and client derive it the same way
+	static uint64 MakeSessionKey(const FString &SessionId);
+	// Function to pick a new reservation id
+	static uint64 MakeReservationId();
+};
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "SessionReservationBeacon.h"
+
+
+class FNamedOnlineSession;
+
+
+/*
+Both sides of the slot reservations: as a host, the responder that holds slots of the hosted sessions, as a client, the slots held on the hosts of the sessions being joined
+*/
+class MENUSYSTEM_API FSessionReservations : public TSharedFromThis<FSessionReservations>{
+public:
+	/*
+	Host
+	*/
+	// Function to start the responder that clients probe the latency of this host with and reserve slots on, port 0 picks a free port
+	bool StartResponder(int32 Port);
+	// Function to stop the responder, which stops taking reservations for every hosted session
+	void StopResponder();
+	// Function to check whether the responder is running
+	bool IsResponderRunning() const { return Responder.IsValid() && Responder->IsRunning(); }
+	// Function to get the port the responder is bound to, 0 if it isn't running
+	int32 GetResponderPort() const { return Responder.IsValid() ? Responder->GetPort() : 0; }
+	// Function to set how long the responder holds a granted slot for a player who hasn't arrived yet, reservations are unauthenticated so keep it short
+	void SetHoldSeconds(float Seconds);
+	// Function to set how many slots of a session the clients behind one IP address may hold at a time, 0 for no limit
+	void SetMaxReservationsPerAddress(int32 MaxReservations);
+	// Function to hand the current capacity of a hosted session to the responder, a session that doesn't advertise reservations (or is gone) stops taking them
+	void UpdateHostedSession(FName SessionName, const FNamedOnlineSession *Session);
+	// Function to stop taking reservations for a hosted session
+	void RemoveHostedSession(FName SessionName);
+	// Function to stop taking reservations for every hosted session, e.g. because they belong to a session interface that has been replaced
+	void RemoveHostedSessions();
+	// Function to get the number of slots of a hosted session that are neither taken nor reserved, negative if the session doesn't take reservations
+	int32 GetOpenSlots(FName SessionName);
+
+	/*
+	Client
+	*/
+	// Function to configure reserving a slot on the host before joining
+	void Configure(bool bInIsEnabled, int32 InNumAttempts, float InTimeoutSeconds);
+	// Function to reserve a slot on the host of the session being joined, superseding the earlier reservation for the session. Returns false if reserving is disabled or the host doesn't take reservations
+	bool Reserve(
+		const IOnlineSessionPtr &SessionInterface, // Specify the session interface to resolve the address of the host with
+		FName SessionName, // Specify the name the session is joined under
+		const FOnlineSessionSearchResult &SessionResult, // Specify the session being joined
+		TFunction<void(const FSessionReservationReply&)> OnComplete // Called on the game thread with the answer of the host, unless the reservation got superseded or cancelled
+	);
+	// Function to keep the slot held for a joint, the host takes it up once the player arrives
+	void Keep(FName SessionName);
+	// Function to give back the slot held for a joint, if any
+	void Cancel(FName SessionName);
+	// Function to give back every slot held for a joint
+	void CancelAll();
+
+private:
+	// Slot held for a joint
+	struct FJoinReservation{
+		// Address of the request is null if no slot is held
+		FSessionReservationRequest Request;
+		// Incremented by each reservation, so that an answer arriving after the joint moved on is ignored
+		int32 Serial{0};
+	};
+
+	// Callback function which will be called when the host answered a reservation (or didn't)
+	void OnReserveComplete(FName SessionName, int32 Serial, const FSessionReservationReply &Reply, const TFunction<void(const FSessionReservationReply&)> &OnComplete);
+
+	// UDP echo responder that clients probe the latency of this host with and reserve slots on, null unless StartResponder was called
+	TUniquePtr<FSessionReservationResponder> Responder;
+	// Seconds the responder holds a granted slot
+	float HoldSeconds{15.f};
+	// Slots of a session the clients behind one IP address may hold at a time
+	int32 MaxReservationsPerAddress{4};
+	// Keys of the hosted sessions the responder takes reservations for, by session name
+	TMap<FName, uint64> HostedSessionKeys;
+
+	// Whether to reserve a slot on the host before joining. Off until configured, since every joint then waits for the host to answer first
+	bool bIsEnabled{false};
+	// Number of times the reservation request is sent if no answer comes back
+	int32 NumAttempts{3};
+	// Seconds to wait for the host to answer the reservation in total, the joint goes ahead without a reservation afterwards
+	float TimeoutSeconds{0.5f};
+	// Slots held for the joints, by session name
+	TMap<FName, FJoinReservation> JoinReservations;
+};
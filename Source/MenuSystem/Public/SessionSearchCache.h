@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+#include "SessionSearchFilter.h"
+
+
+/*
+Key that identifies a session search by the parameters which are actually sent to the backend, two searches with equal keys are expected to return the same set of sessions
+*/
+struct FSessionSearchQuery{
+	// Whether the search is a LAN query
+	bool bIsLanQuery{false};
+	// Whether the search only looks for sessions using presence
+	bool bUsePresence{true};
+	// Criteria that the sessions have to satisfy
+	FSessionSearchFilter Filter;
+	// Max number of search results
+	int32 MaxSearchResults{0};
+
+	bool operator==(const FSessionSearchQuery &Other) const{
+		return bIsLanQuery == Other.bIsLanQuery && bUsePresence == Other.bUsePresence && MaxSearchResults == Other.MaxSearchResults && Filter == Other.Filter;
+	}
+
+	friend uint32 GetTypeHash(const FSessionSearchQuery &Query){
+		uint32 Hash = GetTypeHash(Query.Filter);
+		Hash = HashCombine(Hash, GetTypeHash(Query.MaxSearchResults));
+		Hash = HashCombine(Hash, GetTypeHash(Query.bIsLanQuery));
+		return HashCombine(Hash, GetTypeHash(Query.bUsePresence));
+	}
+};
+
+
+/*
+How recent cached search results are
+*/
+enum class ESessionSearchCacheFreshness : uint8{
+	// Nothing is cached for the query, or the cached results have expired
+	Missing,
+	// The results are returned as they are
+	Fresh,
+	// The results are still returned, but should be refreshed in the background
+	Stale
+};
+
+
+/*
+Results of finished session searches keyed by their query, served fresh for a while and then stale (stale-while-revalidate) until they expire
+*/
+class MENUSYSTEM_API FSessionSearchCache{
+public:
+	// Function to look up the results of a query, expired results are dropped. The results are only set if they are fresh or stale
+	ESessionSearchCacheFreshness Find(
+		const FSessionSearchQuery &Query, // Specify the query
+		double Now, // Specify the current time (in seconds)
+		TSharedPtr<const TArray<FOnlineSessionSearchResult>> &OutResults // Filled in with the results, which stay alive even if the cache is invalidated while they're in use
+	);
+	// Function to store the results of a finished search
+	void Add(const FSessionSearchQuery &Query, TSharedRef<const TArray<FOnlineSessionSearchResult>> Results, double Now);
+	// Function to drop a session from all cached results, e.g. because joining it has failed, the other sessions stay cached
+	void RemoveSession(const FString &SessionId);
+	// Function to drop all cached results
+	void Invalidate();
+
+	// Function to set how long (in seconds) results are fresh and how long they may be served stale after that
+	void SetTTL(float InFreshSeconds, float InStaleSeconds);
+
+private:
+	/*
+	Cached result of a finished session search
+	*/
+	struct FEntry{
+		// Search results shared with the broadcast, so that the entry can be dropped while subscribers are still iterating over them
+		TSharedRef<const TArray<FOnlineSessionSearchResult>> Results;
+		// Time (in seconds) when the results were received
+		double Timestamp{0.0};
+	};
+
+	// Cached results keyed by the query parameters
+	TMap<FSessionSearchQuery, FEntry> Entries;
+	// Seconds during which cached results are returned without asking the backend
+	float FreshSeconds{15.f};
+	// Extra seconds after FreshSeconds during which cached results are still returned, while a background search refreshes them
+	float StaleSeconds{45.f};
+};
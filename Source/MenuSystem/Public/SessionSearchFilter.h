@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineKeyValuePair.h"
+#include "OnlineSessionSettings.h"
+
+
+/*
+A single key/op/value criterion on the settings that sessions advertise
+*/
+struct FSessionSettingFilter{
+	// Key of the session setting
+	FName Key;
+	// Value to compare the session setting with
+	FVariantData Value;
+	// How to compare the session setting with the value
+	EOnlineComparisonOp::Type ComparisonOp{EOnlineComparisonOp::Equals};
+
+	bool operator==(const FSessionSettingFilter &Other) const{
+		return Key == Other.Key && ComparisonOp == Other.ComparisonOp && Value == Other.Value;
+	}
+};
+
+
+/*
+Structured criteria that the sessions of a search have to satisfy. Criteria are sent to the backend through the query settings where the backend honours them, the remaining ones are checked on the client
+*/
+struct MENUSYSTEM_API FSessionSearchFilter{
+	// Match type that the sessions have to advertise, empty string means any match type
+	FString MatchType;
+	// Minimum number of open public connections, 0 means any
+	int32 MinOpenSlots{0};
+	// Build id that the sessions have to be created with, 0 means any
+	int32 BuildUniqueId{0};
+	// Arbitrary criteria on the advertised session settings
+	TArray<FSessionSettingFilter> SettingFilters;
+
+	// Function to add a key/op/value criterion
+	template<typename ValueType>
+	FSessionSearchFilter &Where(FName Key, const ValueType &Value, EOnlineComparisonOp::Type ComparisonOp = EOnlineComparisonOp::Equals){
+		FSessionSettingFilter &SettingFilter = SettingFilters.AddDefaulted_GetRef();
+		SettingFilter.Key = Key;
+		SettingFilter.Value.SetValue(Value);
+		SettingFilter.ComparisonOp = ComparisonOp;
+		return *this;
+	}
+
+	// Function to translate the criteria into query settings of a session search
+	void ApplyToQuerySettings(FOnlineSearchSettings &QuerySettings) const;
+
+	// Function to check whether a search result satisfies the criteria, criteria on advertised settings are skipped if the backend already applied them
+	bool Matches(const FOnlineSessionSearchResult &SearchResult, bool bBackendFiltersSettings) const;
+
+	// Function to check whether the backend of the online subsystem honours criteria on advertised settings in the query settings
+	static bool DoesBackendFilterSettings(FName SubsystemName);
+
+	bool operator==(const FSessionSearchFilter &Other) const{
+		return MinOpenSlots == Other.MinOpenSlots && BuildUniqueId == Other.BuildUniqueId && MatchType == Other.MatchType && SettingFilters == Other.SettingFilters;
+	}
+
+	friend uint32 GetTypeHash(const FSessionSearchFilter &Filter){
+		uint32 Hash = GetTypeHash(Filter.MatchType);
+		Hash = HashCombine(Hash, GetTypeHash(Filter.MinOpenSlots));
+		Hash = HashCombine(Hash, GetTypeHash(Filter.BuildUniqueId));
+		for (const FSessionSettingFilter &SettingFilter : Filter.SettingFilters){
+			Hash = HashCombine(Hash, GetTypeHash(SettingFilter.Key));
+			Hash = HashCombine(Hash, GetTypeHash(SettingFilter.Value.ToString()));
+			Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(SettingFilter.ComparisonOp)));
+		}
+		return Hash;
+	}
+};
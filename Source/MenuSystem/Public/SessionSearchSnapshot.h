@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+
+
+/*
+Read-only view of one search result, exposing the fields the UI and the matchmaking read without copying the result, valid as long as the snapshot it came from is held
+*/
+struct MENUSYSTEM_API FSessionSearchResultView{
+	// Search result, owned by the snapshot
+	const FOnlineSessionSearchResult *Result{nullptr};
+
+	// Whether the view refers to a result
+	bool IsValid() const{ return Result != nullptr; }
+	// The whole search result, e.g. to join it
+	const FOnlineSessionSearchResult &Get() const{ return *Result; }
+	// Ping reported by the backend, MAX_QUERY_PING if unknown
+	int32 GetPingInMs() const{ return Result->PingInMs; }
+	// Name of the host
+	const FString &GetOwningUserName() const{ return Result->Session.OwningUserName; }
+	// Number of public connections that are still free
+	int32 GetNumOpenPublicConnections() const{ return Result->Session.NumOpenPublicConnections; }
+	// Number of public connections of the session
+	int32 GetNumPublicConnections() const{ return Result->Session.SessionSettings.NumPublicConnections; }
+	// Build id of the host
+	int32 GetBuildUniqueId() const{ return Result->Session.SessionSettings.BuildUniqueId; }
+	// Value of a session setting, null if the session doesn't have it
+	const FVariantData *FindSetting(FName Key) const;
+	// Match type of the session, empty if the session doesn't have one
+	FString GetMatchType() const;
+};
+
+
+/*
+Immutable, ref-counted set of search results, subscribers can hold, slice and index it without copying any result
+*/
+class MENUSYSTEM_API FSessionSearchSnapshot{
+public:
+	// Empty snapshot
+	FSessionSearchSnapshot();
+	// Snapshot sharing the given results, which must never be modified afterwards
+	explicit FSessionSearchSnapshot(TSharedRef<const TArray<FOnlineSessionSearchResult>> InResults);
+
+	// Number of results
+	int32 Num() const{ return Count; }
+	// Whether there are no results
+	bool IsEmpty() const{ return Count == 0; }
+	// Result at the given index
+	const FOnlineSessionSearchResult &operator[](int32 Index) const{
+		check(Index >= 0 && Index < Count);
+		return (*Results)[Offset + Index];
+	}
+	// View of the result at the given index
+	FSessionSearchResultView GetView(int32 Index) const{
+		return FSessionSearchResultView{&(*this)[Index]};
+	}
+	// All results as a contiguous view
+	TArrayView<const FOnlineSessionSearchResult> GetResults() const{
+		return TArrayView<const FOnlineSessionSearchResult>(Results->GetData() + Offset, Count);
+	}
+	// Snapshot of a range of the results, sharing the same storage
+	FSessionSearchSnapshot Slice(int32 First, int32 SliceCount) const;
+
+	// Support for ranged-for loops
+	const FOnlineSessionSearchResult *begin() const{ return Results->GetData() + Offset; }
+	const FOnlineSessionSearchResult *end() const{ return Results->GetData() + Offset + Count; }
+
+private:
+	// Shared storage of the results
+	TSharedRef<const TArray<FOnlineSessionSearchResult>> Results;
+	// Index of the first result of the snapshot in the storage
+	int32 Offset{0};
+	// Number of results of the snapshot
+	int32 Count{0};
+};
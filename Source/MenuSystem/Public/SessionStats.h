@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "SessionOperation.h"
+
+
+class FOnlineSessionSearchResult;
+
+
+// Stat group of the session operations, shown with 'stat MultiplayerSessions'
+DECLARE_STATS_GROUP(TEXT("MultiplayerSessions"), STATGROUP_MultiplayerSessions, STATCAT_Advanced);
+
+// Trace channel of the session operations, enabled with '-trace=MultiplayerSessions'
+UE_TRACE_CHANNEL_EXTERN(MultiplayerSessionsChannel, MENUSYSTEM_API);
+
+
+/*
+Wall-clock latency histogram with logarithmic buckets
+*/
+struct MENUSYSTEM_API FSessionLatencyHistogram{
+	// Number of buckets, the last one catches everything above the largest bound
+	static constexpr int32 NumBuckets = 14;
+
+	// Upper bound (in milliseconds) of every bucket but the last one
+	static const float BucketBoundsMs[NumBuckets - 1];
+
+	// Number of samples per bucket
+	uint32 BucketCounts[NumBuckets] = {};
+
+	// Number of samples
+	uint32 NumSamples = 0;
+
+	// Sum of the samples, in milliseconds
+	double SumMs = 0.0;
+
+	// Smallest sample, in milliseconds
+	float MinMs = 0.f;
+
+	// Largest sample, in milliseconds
+	float MaxMs = 0.f;
+
+	// Add a sample
+	void AddSample(float LatencyMs);
+
+	// Average of the samples, in milliseconds
+	float GetAverageMs() const;
+
+	// Estimate of the given percentile (0-100) from the buckets, in milliseconds
+	float GetPercentileMs(float Percentile) const;
+};
+
+
+/*
+Counters of one kind of session operation
+*/
+struct MENUSYSTEM_API FSessionOperationStats{
+	// Latency from handing the operation to the backend until its completion
+	FSessionLatencyHistogram Latency;
+
+	// Number of operations that completed successfully
+	uint32 NumSucceeded = 0;
+
+	// Number of operations that failed, either right away or in the completion callback
+	uint32 NumFailed = 0;
+
+	// Number of operations that were cancelled before completing
+	uint32 NumCancelled = 0;
+
+	// Number of results returned (searches only)
+	uint64 NumResults = 0;
+
+	// Number of results returned by the last operation (searches only)
+	int32 LastNumResults = 0;
+
+	// Estimated size of the returned results in bytes (searches only)
+	uint64 PayloadBytes = 0;
+
+	// Latency of the last operation, in milliseconds
+	float LastLatencyMs = 0.f;
+};
+
+
+/*
+Counters of the pooled search and settings objects
+*/
+struct MENUSYSTEM_API FSessionPoolStats{
+	// Number of search objects that had to be allocated because the pool had none free
+	uint32 NumSearchAllocations = 0;
+
+	// Number of search objects taken from the pool
+	uint32 NumSearchReuses = 0;
+
+	// Number of settings objects that had to be allocated because the pool had none free
+	uint32 NumSettingsAllocations = 0;
+
+	// Number of settings objects taken from the pool
+	uint32 NumSettingsReuses = 0;
+
+	// Bytes of result storage the pooled searches keep between searches
+	int64 RetainedResultBytes = 0;
+};
+
+
+/*
+Copy of the session statistics at one point in time
+*/
+struct MENUSYSTEM_API FSessionStatsSnapshot{
+	// Statistics per kind of operation, indexed by ESessionOperationType
+	FSessionOperationStats Operations[NumSessionOperationTypes];
+
+	// Statistics of the pooled objects
+	FSessionPoolStats Pool;
+
+	// Time the snapshot was taken, in seconds
+	double Timestamp = 0.0;
+
+	// Statistics of the given kind of operation
+	const FSessionOperationStats &Get(ESessionOperationType Type) const{
+		return Operations[static_cast<int32>(Type)];
+	}
+};
+
+
+/*
+Records the latency and the outcome of the session operations, and publishes them to the stat system, the CSV profiler and Unreal Insights
+*/
+class MENUSYSTEM_API FSessionStatsCollector{
+public:
+	// Mark that an operation has been handed to the backend, returns the time it began which identifies it when it ends. The session name keeps the Insights regions of operations on different sessions apart
+	double BeginOperation(ESessionOperationType Type, FName SessionName = NAME_None);
+
+	// Record the completion of an operation, several operations of the same kind may run at once on different sessions
+	void EndOperation(ESessionOperationType Type, double BeginTime, bool bWasSuccessful, int32 NumResults = 0, int64 PayloadBytes = 0, FName SessionName = NAME_None);
+
+	// Record that an operation won't complete
+	void CancelOperation(ESessionOperationType Type, double BeginTime, FName SessionName = NAME_None);
+
+	// Record that a search object has been taken from the pool or allocated
+	void RecordSearchAcquire(bool bWasReused);
+
+	// Record that a settings object has been taken from the pool or allocated
+	void RecordSettingsAcquire(bool bWasReused);
+
+	// Record how much result storage the pooled searches keep
+	void RecordRetainedResultStorage(int64 Bytes);
+
+	// Copy the current statistics
+	FSessionStatsSnapshot GetSnapshot() const;
+
+	// Clear the statistics
+	void Reset();
+
+	// Estimate the size of a search result in bytes
+	static int64 EstimatePayloadBytes(const FOnlineSessionSearchResult &SearchResult);
+
+private:
+	// Statistics of every kind of operation
+	FSessionOperationStats Operations[NumSessionOperationTypes];
+
+	// Statistics of the pooled objects
+	FSessionPoolStats Pool;
+};